@@ -0,0 +1,849 @@
+/**
+ * @file framework_bench.cpp
+ * @brief 框架开销的微基准
+ *
+ * 测量创建到 run() 开始的延迟、不同池线程数下的任务吞吐、暂停/恢复和停止的往返延迟、
+ * TimerWorker 的触发抖动、登记一万个工作者时 getActiveThreadCount() 的开销，
+ * 控制状态与计数共享缓存行（packed）和分开存放（split）时的争用差异，
+ * 经过 std::function 和按类型保存的循环回调的调用开销，以及池任务中临时向量的分配开销。
+ * 结果以 JSON（默认）或 CSV 输出到标准输出，便于在版本之间比较。
+ *
+ * 用法: framework_bench [--csv] [--quick] [--max-threads N]
+ */
+
+#include "../include/thread_framework/ThreadManager.h"
+#include "../include/thread_framework/BaseWorkers.h"
+#include "../include/thread_framework/StaticWorkers.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace thread_framework;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+/**
+ * @brief 一项基准结果：名称、参数和若干指标
+ */
+struct BenchResult {
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> params;
+    std::vector<std::pair<std::string, double>> metrics;
+};
+
+/**
+ * @brief 运行参数
+ */
+struct BenchConfig {
+    bool csv = false;
+    bool quick = false;
+    size_t maxThreads = 0;
+
+    size_t scaled(size_t full) const {
+        return quick ? std::max<size_t>(1, full / 10) : full;
+    }
+};
+
+double toMicros(Clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+/**
+ * @brief 把一组延迟样本（微秒）汇总为 mean/p50/p99/max
+ */
+void addLatencyMetrics(BenchResult& result, std::vector<double> samples, const std::string& prefix = "") {
+    if (samples.empty()) {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double s : samples) {
+        sum += s;
+    }
+    auto at = [&samples](double q) {
+        size_t index = static_cast<size_t>(q * static_cast<double>(samples.size() - 1));
+        return samples[index];
+    };
+    result.metrics.emplace_back(prefix + "samples", static_cast<double>(samples.size()));
+    result.metrics.emplace_back(prefix + "mean_us", sum / static_cast<double>(samples.size()));
+    result.metrics.emplace_back(prefix + "p50_us", at(0.50));
+    result.metrics.emplace_back(prefix + "p99_us", at(0.99));
+    result.metrics.emplace_back(prefix + "max_us", samples.back());
+}
+
+/**
+ * @brief 记录 run() 开始时间的工作者
+ */
+class StartProbe : public IThreadWorker {
+private:
+    Clock::time_point& started_;
+    bool poolable_;
+
+public:
+    StartProbe(Clock::time_point& started, bool poolable) : started_(started), poolable_(poolable) {}
+
+    void run() override {
+        started_ = Clock::now();
+    }
+
+    bool isPoolable() const override {
+        return poolable_;
+    }
+
+    std::string getType() const override {
+        return "StartProbe";
+    }
+};
+
+/**
+ * @brief 一直运行并计数的工作者，用于暂停/恢复和停止的往返测量
+ */
+class SpinProbe : public IThreadWorker {
+private:
+    std::atomic<uint64_t> iterations_{0};
+
+public:
+    void run() override {
+        setState(ThreadState::RUNNING);
+        while (shouldContinue()) {
+            iterations_.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::yield();
+        }
+        setState(ThreadState::FINISHED);
+    }
+
+    uint64_t getIterations() const {
+        return iterations_.load(std::memory_order_relaxed);
+    }
+
+    std::string getType() const override {
+        return "SpinProbe";
+    }
+};
+
+/**
+ * @brief 等待条件成立，超过时限返回 false
+ */
+template <typename Predicate>
+bool spinUntil(Predicate predicate, std::chrono::milliseconds limit = std::chrono::milliseconds(2000)) {
+    auto deadline = Clock::now() + limit;
+    while (!predicate()) {
+        if (Clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+/**
+ * @brief createThreadWithWorker() 调用到 run() 开始的延迟
+ */
+BenchResult benchSpawnLatency(const BenchConfig& config, ExecutionMode mode) {
+    bool pooled = mode == ExecutionMode::POOLED;
+    BenchResult result;
+    result.name = "spawn_latency";
+    result.params.emplace_back("mode", pooled ? "pooled" : "dedicated");
+
+    size_t iterations = config.scaled(2000);
+    std::vector<Clock::time_point> created(iterations);
+    std::vector<Clock::time_point> started(iterations);
+
+    ThreadManager manager(0, mode);
+    for (size_t i = 0; i < iterations; ++i) {
+        created[i] = Clock::now();
+        manager.createThreadWithWorker(std::make_unique<StartProbe>(started[i], pooled), "probe");
+        manager.waitForAll(); // 逐个测量，只包含启动开销而不包含排队
+    }
+
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    for (size_t i = 0; i < iterations; ++i) {
+        samples.push_back(toMicros(started[i] - created[i]));
+    }
+    addLatencyMetrics(result, std::move(samples));
+    return result;
+}
+
+/**
+ * @brief submit() 的任务吞吐
+ */
+BenchResult benchTaskThroughput(const BenchConfig& config, size_t threads) {
+    BenchResult result;
+    result.name = "task_throughput";
+    result.params.emplace_back("threads", std::to_string(threads));
+
+    size_t tasks = config.scaled(200000);
+    std::atomic<size_t> done{0};
+    ThreadManager manager(0, ExecutionMode::POOLED, PoolOptions(threads));
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < tasks; ++i) {
+        manager.submit([&done]() { done.fetch_add(1, std::memory_order_relaxed); });
+    }
+    auto submitted = Clock::now();
+    spinUntil([&]() { return done.load(std::memory_order_relaxed) == tasks; }, std::chrono::milliseconds(60000));
+    auto finished = Clock::now();
+
+    double seconds = std::chrono::duration<double>(finished - start).count();
+    result.metrics.emplace_back("tasks", static_cast<double>(tasks));
+    result.metrics.emplace_back("tasks_per_sec", static_cast<double>(tasks) / seconds);
+    result.metrics.emplace_back("submit_ns_per_task",
+                                std::chrono::duration<double, std::nano>(submitted - start).count() /
+                                    static_cast<double>(tasks));
+    return result;
+}
+
+/**
+ * @brief 暂停、恢复和停止的往返延迟
+ *
+ * 暂停延迟：pauseThread() 到工作者进入 PAUSED；恢复延迟：resumeThread() 到工作者继续计数；
+ * 停止延迟：stopThread() 返回所需的时间（包括 join）。
+ */
+std::vector<BenchResult> benchControlLatency(const BenchConfig& config) {
+    BenchResult pauseResult;
+    pauseResult.name = "pause_resume_latency";
+    BenchResult stopResult;
+    stopResult.name = "stop_latency";
+
+    size_t rounds = config.scaled(500);
+    std::vector<double> pauseSamples;
+    std::vector<double> resumeSamples;
+    std::vector<double> stopSamples;
+
+    ThreadManager manager;
+    for (size_t i = 0; i < rounds; ++i) {
+        auto probe = std::make_unique<SpinProbe>();
+        SpinProbe* worker = probe.get();
+        size_t id = manager.createThreadWithWorker(std::move(probe), "spin");
+        spinUntil([worker]() { return worker->getIterations() > 0; });
+
+        auto pauseStart = Clock::now();
+        manager.pauseThread(id);
+        if (spinUntil([worker]() { return worker->isPaused(); })) {
+            pauseSamples.push_back(toMicros(Clock::now() - pauseStart));
+        }
+
+        uint64_t before = worker->getIterations();
+        auto resumeStart = Clock::now();
+        manager.resumeThread(id);
+        if (spinUntil([worker, before]() { return worker->getIterations() > before; })) {
+            resumeSamples.push_back(toMicros(Clock::now() - resumeStart));
+        }
+
+        auto stopStart = Clock::now();
+        manager.stopThread(id);
+        stopSamples.push_back(toMicros(Clock::now() - stopStart));
+        manager.cleanupFinishedThreads();
+    }
+
+    addLatencyMetrics(pauseResult, std::move(pauseSamples), "pause_");
+    addLatencyMetrics(pauseResult, std::move(resumeSamples), "resume_");
+    addLatencyMetrics(stopResult, std::move(stopSamples));
+    return {pauseResult, stopResult};
+}
+
+/**
+ * @brief TimerWorker 的触发抖动：相邻两次触发的间隔与设定间隔之差
+ */
+BenchResult benchTimerJitter(const BenchConfig& config, TimerMode mode) {
+    BenchResult result;
+    result.name = "timer_jitter";
+    result.params.emplace_back("mode", mode == TimerMode::SHARED_SERVICE ? "shared_service" : "dedicated");
+
+    const auto interval = std::chrono::milliseconds(5);
+    int triggers = static_cast<int>(config.scaled(400));
+    std::vector<Clock::time_point> fired;
+    fired.reserve(static_cast<size_t>(triggers));
+
+    ThreadManager manager;
+    manager.createThreadWithWorker(
+        std::make_unique<TimerWorker>(interval, [&fired]() { fired.push_back(Clock::now()); }, triggers, mode),
+        "timer");
+    manager.waitForAll();
+
+    std::vector<double> samples;
+    for (size_t i = 1; i < fired.size(); ++i) {
+        double actual = toMicros(fired[i] - fired[i - 1]);
+        samples.push_back(std::abs(actual - toMicros(interval)));
+    }
+    result.params.emplace_back("interval_ms", std::to_string(interval.count()));
+    addLatencyMetrics(result, std::move(samples));
+    return result;
+}
+
+/**
+ * @brief 登记大量工作者时查询和停止的开销
+ *
+ * 工作者由共享定时服务驱动，不为每个工作者创建系统线程。
+ */
+std::vector<BenchResult> benchRegistryScale(const BenchConfig& config) {
+    BenchResult queryResult;
+    queryResult.name = "active_count_cost";
+    BenchResult shutdownResult;
+    shutdownResult.name = "shutdown_latency";
+
+    size_t workers = config.scaled(10000);
+    queryResult.params.emplace_back("workers", std::to_string(workers));
+    shutdownResult.params.emplace_back("workers", std::to_string(workers));
+
+    ThreadManager manager;
+    std::vector<std::unique_ptr<IThreadWorker>> batch;
+    batch.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        batch.push_back(std::make_unique<TimerWorker>(std::chrono::milliseconds(3600 * 1000), []() {}, -1,
+                                                      TimerMode::SHARED_SERVICE));
+    }
+    auto createStart = Clock::now();
+    manager.createThreadsWithWorkers(std::move(batch), "idle");
+    queryResult.metrics.emplace_back("create_batch_us", toMicros(Clock::now() - createStart));
+    spinUntil([&]() { return manager.getActiveThreadCount() == workers; });
+
+    size_t calls = 1000;
+    size_t observed = 0;
+    auto queryStart = Clock::now();
+    for (size_t i = 0; i < calls; ++i) {
+        observed += manager.getActiveThreadCount();
+    }
+    auto queryTime = Clock::now() - queryStart;
+    queryResult.metrics.emplace_back("active_workers", static_cast<double>(observed / calls));
+    queryResult.metrics.emplace_back("ns_per_call",
+                                     std::chrono::duration<double, std::nano>(queryTime).count() /
+                                         static_cast<double>(calls));
+
+    auto stopStart = Clock::now();
+    manager.stopAll();
+    manager.waitForAll();
+    shutdownResult.metrics.emplace_back("stop_all_us", toMicros(Clock::now() - stopStart));
+    return {queryResult, shutdownResult};
+}
+
+/**
+ * @brief 旧布局的控制状态：状态、标志和计数紧挨着，并且相邻工作者的状态连续存放
+ */
+struct PackedControl {
+    std::atomic<ThreadState> state{ThreadState::RUNNING};
+    std::atomic<bool> stop{false};
+    std::atomic<bool> pause{false};
+    std::atomic<uint64_t> iterations{0};
+};
+
+/**
+ * @brief 使用框架布局的计数工作者：计数独占缓存行，由工作者线程单独写入
+ */
+class SplitProbe : public IThreadWorker {
+private:
+    alignas(64) OwnedCounter<uint64_t> iterations_;
+
+public:
+    SplitProbe() {
+        setState(ThreadState::RUNNING);
+    }
+
+    void run() override {
+        while (!isStopRequested()) {
+            iterations_.add();
+        }
+    }
+
+    uint64_t getIterations() const {
+        return iterations_.load();
+    }
+
+    std::string getType() const override {
+        return "SplitProbe";
+    }
+};
+
+/**
+ * @brief 控制面的缓存行争用
+ *
+ * 每个工作者线程不停地递增自己的计数并检查停止标志，同时一个监控线程反复读取所有工作者的状态。
+ * packed 复现控制状态与计数共享缓存行、计数用 seq_cst 读改写的布局；split 使用 IThreadWorker
+ * 的实际布局和 OwnedCounter。两者之差就是伪共享和锁前缀指令的代价，只在多核上有意义。
+ */
+BenchResult benchControlPlaneContention(const BenchConfig& config, bool split) {
+    BenchResult result;
+    result.name = "control_plane_contention";
+    size_t workers = config.maxThreads;
+    result.params.emplace_back("layout", split ? "split" : "packed");
+    result.params.emplace_back("workers", std::to_string(workers));
+
+    std::vector<PackedControl> packed(split ? 0 : workers);
+    std::vector<std::unique_ptr<SplitProbe>> probes;
+    for (size_t i = 0; split && i < workers; ++i) {
+        probes.push_back(std::make_unique<SplitProbe>());
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < workers; ++i) {
+        if (split) {
+            threads.emplace_back([&probes, i]() { probes[i]->run(); });
+        } else {
+            threads.emplace_back([&packed, i]() {
+                PackedControl& control = packed[i];
+                while (!control.stop.load()) {
+                    control.iterations.fetch_add(1);
+                }
+            });
+        }
+    }
+
+    auto duration = std::chrono::milliseconds(config.quick ? 50 : 300);
+    uint64_t polls = 0;
+    size_t observed = 0;
+    auto start = Clock::now();
+    while (Clock::now() - start < duration) {
+        for (size_t i = 0; i < workers; ++i) {
+            if (split) {
+                observed += probes[i]->isRunning() || probes[i]->isPaused();
+            } else {
+                ThreadState state = packed[i].state.load();
+                observed += state == ThreadState::RUNNING || state == ThreadState::PAUSED;
+            }
+        }
+        polls++;
+    }
+    auto elapsed = Clock::now() - start;
+
+    uint64_t iterations = 0;
+    for (size_t i = 0; i < workers; ++i) {
+        if (split) {
+            iterations += probes[i]->getIterations();
+            probes[i]->requestStop();
+        } else {
+            iterations += packed[i].iterations.load();
+            packed[i].stop.store(true);
+        }
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    result.metrics.emplace_back("worker_iterations_per_sec", static_cast<double>(iterations) / seconds);
+    result.metrics.emplace_back("monitor_ns_per_poll",
+                                std::chrono::duration<double, std::nano>(elapsed).count() /
+                                    static_cast<double>(std::max<uint64_t>(1, polls * workers)));
+    result.metrics.emplace_back("observed_running", static_cast<double>(observed / std::max<uint64_t>(1, polls)));
+    return result;
+}
+
+/**
+ * @brief 循环回调的调用开销
+ *
+ * 同样的循环体分别交给 LoopWorker（std::function，每次迭代检查并计时）、
+ * LoopWorkerT（按类型保存，每次迭代检查）和每4096次迭代检查一次的 LoopWorkerT，
+ * 在当前线程直接调用 run()，报告每次迭代的平均耗时。
+ */
+std::vector<BenchResult> benchLoopDispatch(const BenchConfig& config) {
+    const int iterations = static_cast<int>(config.scaled(10000000));
+    std::vector<uint32_t> data(4096, 1);
+    auto body = [&data](int i) { data[static_cast<size_t>(i) & 4095] += static_cast<uint32_t>(i); };
+
+    auto measure = [&](const std::string& variant, int checkInterval, IThreadWorker& worker) {
+        BenchResult result;
+        result.name = "loop_dispatch";
+        result.params.emplace_back("variant", variant);
+        result.params.emplace_back("check_interval", std::to_string(checkInterval));
+        result.params.emplace_back("iterations", std::to_string(iterations));
+        auto start = Clock::now();
+        worker.run();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        result.metrics.emplace_back("ns_per_iteration", ns / static_cast<double>(iterations));
+        return result;
+    };
+
+    std::vector<BenchResult> results;
+    LoopWorker dynamic(iterations, body);
+    results.push_back(measure("std_function", 1, dynamic));
+    LoopWorkerT<decltype(body)> typed(iterations, body);
+    results.push_back(measure("typed", 1, typed));
+    LoopWorkerT<decltype(body)> blocked(iterations, body, 4096);
+    results.push_back(measure("typed", 4096, blocked));
+
+    uint64_t checksum = 0;
+    for (uint32_t value : data) {
+        checksum += value;
+    }
+    results.back().metrics.emplace_back("checksum", static_cast<double>(checksum % 1000));
+    return results;
+}
+
+/**
+ * @brief 跟踪点的开销
+ *
+ * 每次迭代都经过 timeCallback() 的 callback 跟踪点，分别在未开启和开启跟踪时运行，
+ * 未开启时应与 loop_dispatch 的 typed 变体相同。
+ */
+std::vector<BenchResult> benchTracingOverhead(const BenchConfig& config) {
+    const int iterations = static_cast<int>(config.scaled(1000000));
+    std::vector<uint32_t> data(4096, 1);
+    auto body = [&data](int i) { data[static_cast<size_t>(i) & 4095] += static_cast<uint32_t>(i); };
+
+    auto measure = [&](bool tracing) {
+        BenchResult result;
+        result.name = "tracing_overhead";
+        result.params.emplace_back("tracing", tracing ? "enabled" : "disabled");
+        result.params.emplace_back("iterations", std::to_string(iterations));
+        LoopWorkerT<decltype(body)> worker(iterations, body);
+        if (tracing) {
+            // 每次迭代一对 callback 事件，容量足够时不丢弃
+            Tracer::instance().start(static_cast<size_t>(iterations) * 2 + 16);
+        }
+        auto start = Clock::now();
+        worker.run();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        Tracer::instance().stop();
+        result.metrics.emplace_back("ns_per_iteration", ns / static_cast<double>(iterations));
+        if (tracing) {
+            result.metrics.emplace_back("events", static_cast<double>(Tracer::instance().getEventCount()));
+            result.metrics.emplace_back("dropped", static_cast<double>(Tracer::instance().getDroppedCount()));
+        }
+        return result;
+    };
+
+    std::vector<BenchResult> results;
+    results.push_back(measure(false));
+    results.push_back(measure(true));
+    return results;
+}
+
+/**
+ * @brief 带时限的关闭
+ *
+ * 一半工作者是长间隔的独占线程监控，一半由共享定时服务驱动，线程池中还排着大量任务；
+ * 报告 shutdown() 的耗时，以及排队任务被执行和丢弃的数量。
+ */
+BenchResult benchShutdown(const BenchConfig& config, ShutdownMode mode) {
+    const size_t workers = config.scaled(200);
+    const size_t tasks = config.scaled(100000);
+
+    BenchResult result;
+    result.name = "graceful_shutdown";
+    result.params.emplace_back("mode", mode == ShutdownMode::DRAIN ? "drain" : "abort");
+    result.params.emplace_back("workers", std::to_string(workers));
+    result.params.emplace_back("queued_tasks", std::to_string(tasks));
+
+    ThreadManager manager;
+    // 监控和定时器都在长时间的等待中，关闭时需要被立即唤醒
+    for (size_t i = 0; i < workers; ++i) {
+        if (i % 2 == 0) {
+            manager.createThreadWithWorker(std::make_unique<MonitorWorker>(std::chrono::seconds(30)), "monitor");
+        } else {
+            manager.createThreadWithWorker(std::make_unique<TimerWorker>(std::chrono::seconds(30), []() {}, -1,
+                                                                         TimerMode::SHARED_SERVICE), "timer");
+        }
+    }
+    std::atomic<uint64_t> executed{0};
+    for (size_t i = 0; i < tasks; ++i) {
+        manager.submit([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+    }
+
+    ShutdownOptions options = mode == ShutdownMode::DRAIN ? ShutdownOptions::drain(std::chrono::seconds(5))
+                                                          : ShutdownOptions::abort(std::chrono::seconds(5));
+    ShutdownReport report = manager.shutdown(options);
+    result.metrics.emplace_back("shutdown_ms", std::chrono::duration<double, std::milli>(report.elapsed).count());
+    result.metrics.emplace_back("finished_workers", static_cast<double>(report.finishedWorkers));
+    result.metrics.emplace_back("stragglers", static_cast<double>(report.stragglers.size()));
+    result.metrics.emplace_back("executed_tasks", static_cast<double>(executed.load()));
+    result.metrics.emplace_back("discarded_tasks", static_cast<double>(report.discardedTasks));
+    return result;
+}
+
+/**
+ * @brief 初始化代价高的工厂工作者
+ *
+ * onInitialize() 分配并填充一块缓冲区，模拟建立连接或预热缓存；run() 只读取一次。
+ */
+class BufferedWorker : public IThreadWorker {
+public:
+    void onInitialize() override {
+        buffer_.assign(256 * 1024, 1);
+    }
+
+    void run() override {
+        setState(ThreadState::RUNNING);
+        checksum_ += buffer_[checksum_ % buffer_.size()];
+        setState(ThreadState::FINISHED);
+    }
+
+    bool isPoolable() const override {
+        return true;
+    }
+
+    std::string getType() const override {
+        return "BufferedWorker";
+    }
+
+private:
+    std::vector<char> buffer_;
+    size_t checksum_ = 0;
+};
+
+class BufferedWorkerFactory : public IThreadWorkerFactory {
+public:
+    explicit BufferedWorkerFactory(bool recycle) : recycle_(recycle) {}
+
+    std::unique_ptr<IThreadWorker> createWorker() override {
+        return std::make_unique<BufferedWorker>();
+    }
+
+    std::string getFactoryType() const override {
+        return "buffered";
+    }
+
+    bool resetWorker(IThreadWorker& worker) override {
+        (void)worker;
+        return recycle_;
+    }
+
+private:
+    bool recycle_;
+};
+
+/**
+ * @brief 工厂创建与回收复用的开销
+ *
+ * 池化模式下反复 createThread() 一个初始化代价高的工作者并等待它结束，
+ * 比较每次调用工厂创建和复用空闲工作者时每次创建的耗时，并报告命中和未命中次数。
+ */
+BenchResult benchFactoryRecycling(const BenchConfig& config, bool recycle) {
+    const size_t iterations = config.scaled(5000);
+
+    BenchResult result;
+    result.name = "factory_recycling";
+    result.params.emplace_back("recycle", recycle ? "on" : "off");
+    result.params.emplace_back("iterations", std::to_string(iterations));
+
+    ThreadManager manager(0, ExecutionMode::POOLED);
+    manager.addFactory(std::make_unique<BufferedWorkerFactory>(recycle), "buffered");
+    auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        manager.createThread("buffered");
+        manager.waitForAll();
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    RecycleStats stats;
+    manager.getRecycleStats("buffered", stats);
+    result.metrics.emplace_back("us_per_create", ns / 1000.0 / static_cast<double>(iterations));
+    result.metrics.emplace_back("hits", static_cast<double>(stats.hits));
+    result.metrics.emplace_back("misses", static_cast<double>(stats.misses));
+    return result;
+}
+
+/**
+ * @brief 任务中临时向量的来源
+ */
+enum class ScratchMode {
+    HEAP,        ///< 每个任务用 std::vector 重新分配
+    ARENA,       ///< 每个任务用 ScratchVector 从线程的临时内存分配
+    THREAD_SLOT  ///< 每个池线程一份 ThreadLocalSlot 缓冲区，跨任务复用
+};
+
+const char* scratchModeName(ScratchMode mode) {
+    switch (mode) {
+        case ScratchMode::HEAP: return "heap";
+        case ScratchMode::ARENA: return "arena";
+        case ScratchMode::THREAD_SLOT: return "thread_slot";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief 池任务中临时向量的分配开销
+ *
+ * 每个任务逐个追加元素构建若干临时向量并求和，比较每次从通用分配器分配、
+ * 从线程的临时内存分配和使用每个池线程一份的缓冲区时的吞吐。
+ */
+BenchResult benchScratchArena(const BenchConfig& config, ScratchMode mode) {
+    const size_t tasks = config.scaled(100000);
+    const size_t vectors = 4;
+    const size_t elements = 512;
+
+    BenchResult result;
+    result.name = "scratch_arena";
+    result.params.emplace_back("mode", scratchModeName(mode));
+    result.params.emplace_back("threads", std::to_string(config.maxThreads));
+
+    static ThreadLocalSlot<std::vector<std::vector<int>>> buffers;
+    std::atomic<size_t> done{0};
+    std::atomic<uint64_t> checksum{0};
+    ThreadManager manager(0, ExecutionMode::POOLED, PoolOptions(config.maxThreads));
+
+    auto task = [&, mode]() {
+        uint64_t sum = 0;
+        if (mode == ScratchMode::THREAD_SLOT) {
+            std::vector<std::vector<int>>& slots = *buffers;
+            slots.resize(vectors);
+            for (std::vector<int>& values : slots) {
+                values.clear();
+                for (size_t i = 0; i < elements; ++i) {
+                    values.push_back(static_cast<int>(i));
+                }
+                sum += std::accumulate(values.begin(), values.end(), uint64_t{0});
+            }
+        } else if (mode == ScratchMode::ARENA) {
+            for (size_t v = 0; v < vectors; ++v) {
+                ScratchVector<int> values;
+                for (size_t i = 0; i < elements; ++i) {
+                    values.push_back(static_cast<int>(i));
+                }
+                sum += std::accumulate(values.begin(), values.end(), uint64_t{0});
+            }
+        } else {
+            for (size_t v = 0; v < vectors; ++v) {
+                std::vector<int> values;
+                for (size_t i = 0; i < elements; ++i) {
+                    values.push_back(static_cast<int>(i));
+                }
+                sum += std::accumulate(values.begin(), values.end(), uint64_t{0});
+            }
+        }
+        checksum.fetch_add(sum, std::memory_order_relaxed);
+        done.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < tasks; ++i) {
+        manager.submit(task);
+    }
+    spinUntil([&]() { return done.load(std::memory_order_relaxed) == tasks; }, std::chrono::milliseconds(60000));
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    result.metrics.emplace_back("tasks_per_sec", static_cast<double>(tasks) / seconds);
+    result.metrics.emplace_back("ns_per_task", seconds * 1e9 / static_cast<double>(tasks));
+    result.metrics.emplace_back("checksum_ok", checksum.load() == tasks * vectors * (elements * (elements - 1) / 2) ? 1 : 0);
+    return result;
+}
+
+std::string escapeJson(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out;
+}
+
+std::string formatNumber(double value) {
+    std::ostringstream stream;
+    stream.precision(6);
+    stream << value;
+    return stream.str();
+}
+
+void printJson(const std::vector<BenchResult>& results) {
+    std::cout << "{\n  \"suite\": \"thread_framework\",\n  \"version\": \"1.0.0\",\n"
+              << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        std::cout << "    {\"name\": \"" << escapeJson(r.name) << "\", \"params\": {";
+        for (size_t k = 0; k < r.params.size(); ++k) {
+            std::cout << (k ? ", " : "") << "\"" << escapeJson(r.params[k].first) << "\": \""
+                      << escapeJson(r.params[k].second) << "\"";
+        }
+        std::cout << "}, \"metrics\": {";
+        for (size_t k = 0; k < r.metrics.size(); ++k) {
+            std::cout << (k ? ", " : "") << "\"" << escapeJson(r.metrics[k].first) << "\": "
+                      << formatNumber(r.metrics[k].second);
+        }
+        std::cout << "}}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    std::cout << "  ]\n}" << std::endl;
+}
+
+void printCsv(const std::vector<BenchResult>& results) {
+    std::cout << "benchmark,params,metric,value\n";
+    for (const BenchResult& r : results) {
+        std::string params;
+        for (size_t k = 0; k < r.params.size(); ++k) {
+            params += (k ? ";" : "") + r.params[k].first + "=" + r.params[k].second;
+        }
+        for (const auto& metric : r.metrics) {
+            std::cout << r.name << "," << params << "," << metric.first << "," << formatNumber(metric.second) << "\n";
+        }
+    }
+    std::cout.flush();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--csv") == 0) {
+            config.csv = true;
+        } else if (std::strcmp(argv[i], "--quick") == 0) {
+            config.quick = true;
+        } else if (std::strcmp(argv[i], "--max-threads") == 0 && i + 1 < argc) {
+            config.maxThreads = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--csv] [--quick] [--max-threads N]" << std::endl;
+            return 2;
+        }
+    }
+    if (config.maxThreads == 0) {
+        config.maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // 工作者的启动和停止日志会干扰计时和输出
+    Logger::instance().setLevel(LogLevel::WARNING);
+
+    std::vector<BenchResult> results;
+    results.push_back(benchSpawnLatency(config, ExecutionMode::DEDICATED_THREAD));
+    results.push_back(benchSpawnLatency(config, ExecutionMode::POOLED));
+
+    std::vector<size_t> threadCounts;
+    for (size_t t = 1; t < config.maxThreads; t *= 2) {
+        threadCounts.push_back(t);
+    }
+    threadCounts.push_back(config.maxThreads);
+    for (size_t threads : threadCounts) {
+        results.push_back(benchTaskThroughput(config, threads));
+    }
+
+    for (BenchResult& r : benchControlLatency(config)) {
+        results.push_back(std::move(r));
+    }
+    results.push_back(benchTimerJitter(config, TimerMode::DEDICATED_THREAD));
+    results.push_back(benchTimerJitter(config, TimerMode::SHARED_SERVICE));
+    for (BenchResult& r : benchRegistryScale(config)) {
+        results.push_back(std::move(r));
+    }
+    results.push_back(benchControlPlaneContention(config, false));
+    results.push_back(benchControlPlaneContention(config, true));
+    for (BenchResult& r : benchLoopDispatch(config)) {
+        results.push_back(std::move(r));
+    }
+    for (BenchResult& r : benchTracingOverhead(config)) {
+        results.push_back(std::move(r));
+    }
+    results.push_back(benchShutdown(config, ShutdownMode::DRAIN));
+    results.push_back(benchShutdown(config, ShutdownMode::ABORT));
+    results.push_back(benchFactoryRecycling(config, false));
+    results.push_back(benchFactoryRecycling(config, true));
+    results.push_back(benchScratchArena(config, ScratchMode::HEAP));
+    results.push_back(benchScratchArena(config, ScratchMode::ARENA));
+    results.push_back(benchScratchArena(config, ScratchMode::THREAD_SLOT));
+
+    if (config.csv) {
+        printCsv(results);
+    } else {
+        printJson(results);
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file coroutine_workers.cpp
+ * @brief 协程工作者示例
+ *
+ * 这个文件展示了如何用 CoroutineWorker 在少量池线程上运行上万个以等待为主的检查器。
+ * 需要 C++20，Makefile 为这个示例单独加上 -std=c++20。
+ */
+
+#include "../include/thread_framework/ThreadManager.h"
+#include "../include/thread_framework/CoroutineWorker.h"
+#include <sys/socket.h>
+#include <unistd.h>
+#include <iostream>
+#include <atomic>
+#include <chrono>
+
+using namespace thread_framework;
+
+/**
+ * @brief 周期性检查器
+ *
+ * 每轮先睡眠，再把一次短小的检查提交到线程池并等待结果，等待期间不占用线程。
+ */
+class PeriodicChecker : public CoroutineWorker {
+private:
+    ThreadManager& manager_;
+    int rounds_;
+    std::chrono::milliseconds interval_;
+    std::atomic<int>& passed_;
+
+public:
+    PeriodicChecker(ThreadManager& manager, int rounds, std::chrono::milliseconds interval, std::atomic<int>& passed)
+        : manager_(manager), rounds_(rounds), interval_(interval), passed_(passed) {}
+
+    Task<void> runAsync() override {
+        for (int round = 0; round < rounds_; ++round) {
+            // GCC 12 在 if 条件中直接使用 co_await 可能生成错误的协程帧，先保存结果
+            bool proceed = co_await checkpoint();
+            if (!proceed) {
+                co_return;
+            }
+
+            bool slept = co_await sleepFor(interval_);
+            if (!slept) {
+                co_return;
+            }
+
+            bool healthy = co_await manager_.submit([round]() {
+                return round >= 0; // 模拟一次检查
+            });
+            if (healthy) {
+                passed_.fetch_add(1);
+            }
+        }
+    }
+
+    std::string getType() const override {
+        return "PeriodicChecker";
+    }
+};
+
+/**
+ * @brief 套接字读取器
+ *
+ * 等待描述符可读，超时后继续等待，直到对端关闭或收到停止请求。
+ */
+class SocketReader : public CoroutineWorker {
+private:
+    int fd_;
+    std::atomic<int>& received_;
+
+public:
+    SocketReader(int fd, std::atomic<int>& received) : fd_(fd), received_(received) {}
+
+    Task<void> runAsync() override {
+        char buffer[64];
+        while (true) {
+            WaitResult result = co_await waitReadable(fd_, std::chrono::milliseconds(200));
+            if (result == WaitResult::STOPPED || result == WaitResult::FAILED) {
+                co_return;
+            }
+            if (result == WaitResult::TIMEOUT) {
+                continue;
+            }
+
+            ssize_t count = read(fd_, buffer, sizeof(buffer));
+            if (count <= 0) {
+                co_return; // 对端关闭
+            }
+            received_.fetch_add(static_cast<int>(count));
+        }
+    }
+
+    std::string getType() const override {
+        return "SocketReader";
+    }
+};
+
+int main() {
+    std::cout << "=== 协程工作者示例 ===" << std::endl;
+
+    const int checkerCount = 10000;
+    const int rounds = 3;
+    std::atomic<int> passed{0};
+    std::atomic<int> received{0};
+
+    ThreadManager manager(0, ExecutionMode::DEDICATED_THREAD, PoolOptions(4));
+
+    // 示例1: 一万个检查器共享4个池线程
+    std::cout << "\n1. 启动 " << checkerCount << " 个协程检查器" << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < checkerCount; ++i) {
+        manager.createThreadWithWorker(
+            std::make_unique<PeriodicChecker>(manager, rounds, std::chrono::milliseconds(50 + i % 50), passed),
+            "Checker-" + std::to_string(i));
+    }
+
+    // 示例2: 等待套接字可读
+    std::cout << "\n2. 等待套接字数据" << std::endl;
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, sockets) != 0) {
+        std::cerr << "socketpair failed" << std::endl;
+        return 1;
+    }
+    size_t readerId = manager.createThreadWithWorker(std::make_unique<SocketReader>(sockets[0], received), "Reader");
+
+    for (int i = 0; i < 5; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        ssize_t written = write(sockets[1], "ping", 4);
+        (void)written;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::cout << "活跃工作者: " << manager.getActiveThreadCount() << std::endl;
+
+    manager.stopThread(readerId);
+    close(sockets[0]);
+    close(sockets[1]);
+    std::cout << "读取器收到 " << received.load() << " 字节" << std::endl;
+
+    manager.waitForAll();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "检查通过 " << passed.load() << "/" << checkerCount * rounds
+              << "，耗时 " << elapsed.count() << "ms" << std::endl;
+
+    auto poolStats = manager.getPoolStats();
+    std::cout << "池线程数: " << poolStats.threadCount << std::endl;
+
+    std::cout << "\n=== 示例完成 ===" << std::endl;
+    return 0;
+}
@@ -2,24 +2,29 @@
  * @file custom_worker.cpp
  * @brief 自定义工作者示例
  *
- * 这个文件展示了如何继承IThreadWorker接口来创建自定义的工作者类。
+ * 这个文件展示了如何继承IThreadWorker接口来创建自定义的工作者类，
+ * 以及如何继承 EventLoopWorker 用就绪事件代替轮询。
  */
 
 #include "../include/thread_framework/IThreadWorker.h"
 #include "../include/thread_framework/ThreadManager.h"
+#include "../include/thread_framework/BaseWorkers.h"
+#include "../include/thread_framework/DataParallel.h"
 #include <iostream>
 #include <fstream>
 #include <random>
 #include <chrono>
+#include <numeric>
 
 using namespace thread_framework;
 
 /**
  * @brief 文件监控工作者 - 自定义工作者示例
  *
- * 继承IThreadWorker，实现文件监控功能
+ * 继承EventLoopWorker，用 inotify 在文件写入完成时立即检查，空闲时线程不会醒来。
+ * 无法监视文件时退回到按间隔检查。
  */
-class FileMonitorWorker : public IThreadWorker {
+class FileMonitorWorker : public EventLoopWorker {
 private:
     std::string filePath_;
     std::chrono::milliseconds checkInterval_;
@@ -31,27 +36,11 @@ public:
      * @brief 构造函数
      *
      * @param filePath 要监控的文件路径
-     * @param interval 检查间隔
+     * @param interval 无法使用 inotify 时的检查间隔
      */
     FileMonitorWorker(const std::string& filePath, std::chrono::milliseconds interval = std::chrono::seconds(5))
         : filePath_(filePath), checkInterval_(interval) {}
 
-    /**
-     * @brief 执行文件监控逻辑
-     */
-    void run() override {
-        setState(ThreadState::RUNNING);
-
-        std::cout << "[" << getType() << "] 开始监控文件: " << filePath_ << std::endl;
-
-        while (shouldContinue()) {
-            checkFile();
-            std::this_thread::sleep_for(checkInterval_);
-        }
-
-        setState(ThreadState::FINISHED);
-    }
-
     /**
      * @brief 获取工作者类型
      */
@@ -74,6 +63,25 @@ public:
     }
 
 protected:
+    /**
+     * @brief 注册文件监视，在工作者线程上调用
+     */
+    void onLoopStart(EventLoop& loop) override {
+        std::cout << "[" << getType() << "] 开始监控文件: " << filePath_ << std::endl;
+        checkFile();
+
+        EventLoop::SourceId watch = loop.addFileWatch(filePath_, IN_CLOSE_WRITE | IN_MODIFY,
+            [this](uint32_t mask, const std::string&) {
+                if (mask & IN_CLOSE_WRITE) {
+                    checkFile();
+                }
+            });
+        if (watch == 0) {
+            std::cout << "[" << getType() << "] 无法监视文件，改为每 " << checkInterval_.count() << "ms 检查一次" << std::endl;
+            loop.addTimer(checkInterval_, checkInterval_, [this]() { checkFile(); });
+        }
+    }
+
     /**
      * @brief 检查文件变化
      */
@@ -115,11 +123,11 @@ public:
     /**
      * @brief 构造函数
      *
-     * @param data 要处理的数据
+     * @param data 要处理的数据，按值接收，调用方可以移动传入避免复制
      * @param processor 数据处理函数
      */
-    DataProcessorWorker(const std::vector<int>& data, std::function<int(const std::vector<int>&)> processor)
-        : data_(data), processor_(processor) {}
+    DataProcessorWorker(std::vector<int> data, std::function<int(const std::vector<int>&)> processor)
+        : data_(std::move(data)), processor_(std::move(processor)) {}
 
     /**
      * @brief 执行数据处理
@@ -134,7 +142,7 @@ public:
                 result_.store(processor_(data_));
                 std::cout << "[" << getType() << "] 数据处理完成，结果: " << result_.load() << std::endl;
             } catch (const std::exception& e) {
-                onError(std::string("数据处理失败: ") + e.what());
+                reportError(std::string("数据处理失败: ") + e.what());
             }
         }
 
@@ -162,13 +170,18 @@ public:
 
 /**
  * @brief 网络检查工作者 - 模拟网络连接检查
+ *
+ * 继承EventLoopWorker：每轮检查由定时器触发，各端点的模拟探测同时发出，
+ * 在随机延迟后以定时器事件完成，工作者线程不会 sleep。
  */
-class NetworkCheckerWorker : public IThreadWorker {
+class NetworkCheckerWorker : public EventLoopWorker {
 private:
     std::vector<std::string> endpoints_;
     std::chrono::milliseconds checkInterval_;
     std::atomic<int> successCount_{0};
     std::atomic<int> failCount_{0};
+    std::mt19937 random_{std::random_device{}()};
+    size_t pending_ = 0;   ///< 本轮尚未完成的探测数，只在工作者线程上访问
 
 public:
     /**
@@ -180,22 +193,6 @@ public:
     NetworkCheckerWorker(const std::vector<std::string>& endpoints, std::chrono::milliseconds interval = std::chrono::seconds(3))
         : endpoints_(endpoints), checkInterval_(interval) {}
 
-    /**
-     * @brief 执行网络检查
-     */
-    void run() override {
-        setState(ThreadState::RUNNING);
-
-        std::cout << "[" << getType() << "] 开始网络检查，监控 " << endpoints_.size() << " 个端点" << std::endl;
-
-        while (shouldContinue()) {
-            checkEndpoints();
-            std::this_thread::sleep_for(checkInterval_);
-        }
-
-        setState(ThreadState::FINISHED);
-    }
-
     /**
      * @brief 获取工作者类型
      */
@@ -219,31 +216,48 @@ public:
 
 protected:
     /**
-     * @brief 检查所有端点
+     * @brief 立即开始第一轮检查，之后按间隔由定时器触发
      */
-    void checkEndpoints() {
-        std::random_device rd;
-        std::mt19937 gen(rd());
+    void onLoopStart(EventLoop& loop) override {
+        std::cout << "[" << getType() << "] 开始网络检查，监控 " << endpoints_.size() << " 个端点" << std::endl;
+
+        checkEndpoints(loop);
+        loop.addTimer(checkInterval_, checkInterval_, [this, &loop]() { checkEndpoints(loop); });
+    }
+
+    /**
+     * @brief 向所有端点发出探测
+     */
+    void checkEndpoints(EventLoop& loop) {
         std::uniform_int_distribution<> dis(100, 500);
 
+        pending_ += endpoints_.size();
         for (const auto& endpoint : endpoints_) {
-            // 模拟网络检查延迟
-            std::this_thread::sleep_for(std::chrono::milliseconds(dis(gen)));
-
-            // 模拟网络检查结果（70%成功率）
-            bool success = (dis(gen) % 100) < 70;
+            // 模拟网络检查延迟和结果（70%成功率），探测完成时触发单次定时器
+            std::chrono::milliseconds latency(dis(random_));
+            bool success = (dis(random_) % 100) < 70;
+            loop.addTimer(latency, std::chrono::milliseconds(0), [this, endpoint, success]() {
+                onProbeComplete(endpoint, success);
+            });
+        }
+    }
 
-            if (success) {
-                successCount_++;
-                std::cout << "[" << getType() << "] ✓ " << endpoint << " - 连接正常" << std::endl;
-            } else {
-                failCount_++;
-                std::cout << "[" << getType() << "] ✗ " << endpoint << " - 连接失败" << std::endl;
-            }
+    /**
+     * @brief 探测完成
+     */
+    void onProbeComplete(const std::string& endpoint, bool success) {
+        if (success) {
+            successCount_++;
+            std::cout << "[" << getType() << "] ✓ " << endpoint << " - 连接正常" << std::endl;
+        } else {
+            failCount_++;
+            std::cout << "[" << getType() << "] ✗ " << endpoint << " - 连接失败" << std::endl;
         }
 
-        std::cout << "[" << getType() << "] 检查完成 - 成功: " << successCount_.load()
-                  << ", 失败: " << failCount_.load() << std::endl;
+        if (--pending_ == 0) {
+            std::cout << "[" << getType() << "] 检查完成 - 成功: " << successCount_.load()
+                      << ", 失败: " << failCount_.load() << std::endl;
+        }
     }
 
     void onStop() override {
@@ -272,7 +286,7 @@ int main() {
     std::cout << "\n2. 数据处理工作者" << std::endl;
 
     std::vector<int> numbers = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
-    auto dataProcessor = std::make_unique<DataProcessorWorker>(numbers, [](const std::vector<int>& data) {
+    auto dataProcessor = std::make_unique<DataProcessorWorker>(std::move(numbers), [](const std::vector<int>& data) {
         int sum = 0;
         for (int num : data) {
             sum += num;
@@ -283,6 +297,47 @@ int main() {
 
     size_t dataProcessorId = manager.createThreadWithWorker(std::move(dataProcessor), "DataProcessor");
 
+    // 大批量数据：接管数据的所有权，按缓存大小分块并行处理，不复制
+    std::vector<int> batch(4000000);
+    std::iota(batch.begin(), batch.end(), 0);
+    auto sumWorker = std::make_unique<DataParallelWorker<int, long long>>(
+        manager, DataView<int>::adopt(std::move(batch)), 0LL,
+        [](const DataView<int>& chunk) {
+            long long sum = 0;
+            for (int value : chunk) {
+                sum += value;
+            }
+            return sum;
+        },
+        [](long long a, long long b) { return a + b; });
+    Future<long long> batchSum = sumWorker->getFuture();
+    manager.createThreadWithWorker(std::move(sumWorker), "DataParallel");
+    std::cout << "[DataParallelWorker] 批量求和结果: " << batchSum.get() << std::endl;
+
+    // 小批量任务：临时向量从池线程的临时内存分配，任务结束后自动回收；
+    // 每个池线程的分词缓冲区只创建一次，在后续任务中复用
+    static ThreadLocalSlot<std::vector<std::string>> tokenCache;
+    std::vector<Future<size_t>> lineLengths;
+    for (int line = 0; line < 8; ++line) {
+        lineLengths.push_back(manager.submit([line]() {
+            ScratchVector<int> squares;
+            for (int i = 0; i <= line; ++i) {
+                squares.push_back(i * i);
+            }
+            std::vector<std::string>& tokens = *tokenCache;
+            tokens.clear();
+            for (int value : squares) {
+                tokens.push_back(std::to_string(value));
+            }
+            return tokens.size();
+        }));
+    }
+    size_t totalTokens = 0;
+    for (auto& length : lineLengths) {
+        totalTokens += length.get();
+    }
+    std::cout << "[ScratchArena] 小批量任务共生成 " << totalTokens << " 个记号" << std::endl;
+
     // 示例3: 网络检查工作者
     std::cout << "\n3. 网络检查工作者" << std::endl;
 
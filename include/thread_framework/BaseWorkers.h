@@ -2,13 +2,28 @@
 #define BASE_WORKERS_H
 
 #include "IThreadWorker.h"
-#include <iostream>
+#include "MPMCQueue.h"
+#include "EventLoop.h"
+#include "Logger.h"
+#include "Counters.h"
 #include <functional>
 #include <chrono>
 #include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace thread_framework {
 
+/**
+ * @brief 周期性工作者的驱动方式
+ */
+enum class TimerMode {
+    DEDICATED_THREAD,   ///< 独占一个线程，在线程中等待间隔
+    SHARED_SERVICE      ///< 注册到线程管理器的共享定时服务，不占用线程
+};
+
 /**
  * @brief 监控工作者 - 持续运行的监控线程
  *
@@ -19,7 +34,8 @@ private:
     std::chrono::milliseconds interval_;
     std::function<void()> callback_;
     std::atomic<bool> enabled_{true};
-    std::atomic<int> iterationCount_{0};
+    OwnedCounter<int> iterationCount_; ///< 只由工作者线程递增
+    TimerMode mode_;
 
 public:
     /**
@@ -27,10 +43,12 @@ public:
      *
      * @param interval 监控间隔，默认1000毫秒
      * @param callback 监控回调函数，可选
+     * @param mode 驱动方式，默认独占线程
      */
     explicit MonitorWorker(std::chrono::milliseconds interval = std::chrono::milliseconds(1000),
-                          std::function<void()> callback = nullptr)
-        : interval_(interval), callback_(callback) {}
+                          std::function<void()> callback = nullptr,
+                          TimerMode mode = TimerMode::DEDICATED_THREAD)
+        : interval_(interval), callback_(callback), mode_(mode) {}
 
     /**
      * @brief 执行监控逻辑
@@ -39,18 +57,18 @@ public:
         setState(ThreadState::RUNNING);
 
         while (shouldContinue() && enabled_.load()) {
-            iterationCount_++;
+            iterationCount_.add();
 
             // 执行监控逻辑
             if (callback_) {
-                callback_();
+                timeCallback(callback_);
             } else {
                 // 默认监控逻辑
                 defaultMonitorLogic();
             }
 
-            // 等待下一次监控
-            std::this_thread::sleep_for(interval_);
+            // 等待下一次监控，停止请求会立即结束等待
+            waitFor(interval_);
         }
 
         setState(ThreadState::FINISHED);
@@ -105,18 +123,50 @@ public:
         return interval_;
     }
 
+    /**
+     * @brief 共享定时服务模式下返回监控间隔
+     */
+    std::chrono::milliseconds getSharedTimerInterval() const override {
+        return mode_ == TimerMode::SHARED_SERVICE ? interval_ : std::chrono::milliseconds(0);
+    }
+
+    void onTimerAttach() override {
+        setState(ThreadState::RUNNING);
+    }
+
+    /**
+     * @brief 共享定时服务模式下执行一次监控
+     */
+    bool onTimerTick() override {
+        if (isStopRequested() || !enabled_.load()) {
+            setState(ThreadState::FINISHED);
+            return false;
+        }
+        if (!updatePausedState()) {
+            return true; // 暂停期间跳过本次监控
+        }
+
+        iterationCount_.add();
+        if (callback_) {
+            timeCallback(callback_);
+        } else {
+            defaultMonitorLogic();
+        }
+        return true;
+    }
+
 protected:
     /**
      * @brief 默认监控逻辑
      */
     virtual void defaultMonitorLogic() {
         // 默认的监控实现，子类可以重写
-        std::cout << "[" << getType() << "] Monitoring check #" << getIterationCount() << std::endl;
+        TF_LOG_INFO("[", getType(), "] Monitoring check #", getIterationCount());
     }
 
     void onStop() override {
         enabled_.store(false);
-        std::cout << "[" << getType() << "] Monitoring stopped after " << getIterationCount() << " checks" << std::endl;
+        TF_LOG_INFO("[", getType(), "] Monitoring stopped after ", getIterationCount(), " checks");
     }
 };
 
@@ -147,12 +197,13 @@ public:
     void run() override {
         setState(ThreadState::RUNNING);
 
-        if (task_) {
+        // 排队期间已被停止的任务不再执行
+        if (task_ && shouldContinue()) {
             try {
-                task_();
+                timeCallback(task_);
                 completed_.store(true);
             } catch (const std::exception& e) {
-                onError(std::string("Task execution failed: ") + e.what());
+                reportError(std::string("Task execution failed: ") + e.what());
             }
         }
 
@@ -180,26 +231,38 @@ public:
         return completed_.load();
     }
 
+    /**
+     * @brief 一次性任务可以在线程池中执行
+     */
+    bool isPoolable() const override {
+        return true;
+    }
+
     void onStart() override {
-        std::cout << "[" << getType() << "] Starting task: " << description_ << std::endl;
+        TF_LOG_INFO("[", getType(), "] Starting task: ", description_);
     }
 
     void onStop() override {
-        std::cout << "[" << getType() << "] Task stopped: " << description_ << std::endl;
+        TF_LOG_INFO("[", getType(), "] Task stopped: ", description_);
     }
 };
 
 /**
- * @brief 定时器工作者 - 周期性触发回调
+ * @brief 定时器工作者的公共实现
  *
- * 适用于定时任务、周期性检查、定时器等场景。
+ * 负责独占线程的定时循环、共享定时服务的触发和触发计数，回调以 Callback 类型保存。
+ * TimerWorker 以 std::function 保存回调，TimerWorkerT（StaticWorkers.h）以可调用对象本身的类型保存。
+ *
+ * @tparam Callback 可调用对象类型，签名 void()
  */
-class TimerWorker : public IThreadWorker {
+template <typename Callback>
+class BasicTimerWorker : public IThreadWorker {
 private:
     std::chrono::milliseconds interval_;
-    std::function<void()> callback_;
+    Callback callback_;
     int maxTriggers_;
-    std::atomic<int> triggerCount_{0};
+    OwnedCounter<int> triggerCount_; ///< 只由触发回调的线程递增
+    TimerMode mode_;
 
 public:
     /**
@@ -208,50 +271,71 @@ public:
      * @param interval 触发间隔
      * @param callback 回调函数
      * @param maxTriggers 最大触发次数，-1表示无限次
+     * @param mode 驱动方式，默认独占线程
      */
-    TimerWorker(std::chrono::milliseconds interval,
-                std::function<void()> callback,
-                int maxTriggers = -1)
-        : interval_(interval), callback_(callback), maxTriggers_(maxTriggers) {}
+    BasicTimerWorker(std::chrono::milliseconds interval, Callback callback, int maxTriggers = -1,
+                     TimerMode mode = TimerMode::DEDICATED_THREAD)
+        : interval_(interval), callback_(std::move(callback)), maxTriggers_(maxTriggers), mode_(mode) {}
 
     /**
      * @brief 执行定时器逻辑
+     *
+     * 按绝对截止时间等待，回调的执行时间不会累积成漂移。
+     * 暂停或回调超时后落后的周期被跳过，与共享定时服务相同，恢复后不会连续补发。
      */
     void run() override {
         setState(ThreadState::RUNNING);
 
+        auto deadline = std::chrono::steady_clock::now();
         while (shouldContinue()) {
             // 检查是否达到最大触发次数
-            if (maxTriggers_ > 0 && triggerCount_.load() >= maxTriggers_) {
+            if (reachedMaxTriggers()) {
                 break;
             }
 
-            // 等待触发间隔
-            std::this_thread::sleep_for(interval_);
-
-            if (!shouldContinue()) {
+            // 等待到下一个截止时间，停止请求会立即结束等待
+            deadline = nextDeadline(deadline);
+            if (!waitUntil(deadline) || !shouldContinue()) {
                 break;
             }
 
-            // 执行回调
-            triggerCount_++;
-            if (callback_) {
-                try {
-                    callback_();
-                } catch (const std::exception& e) {
-                    onError(std::string("Timer callback failed: ") + e.what());
-                }
-            }
+            TF_TRACE(TraceKind::TIMER_FIRE, TracePhase::INSTANT, Tracer::CURRENT_WORKER, 0);
+            fire();
         }
 
         setState(ThreadState::FINISHED);
     }
 
     /**
-     * @brief 获取工作者类型
+     * @brief 共享定时服务模式下返回触发间隔
      */
-    std::string getType() const override {
-        return "TimerWorker";
+    std::chrono::milliseconds getSharedTimerInterval() const override {
+        return mode_ == TimerMode::SHARED_SERVICE ? interval_ : std::chrono::milliseconds(0);
+    }
+
+    void onTimerAttach() override {
+        setState(ThreadState::RUNNING);
+    }
+
+    /**
+     * @brief 共享定时服务模式下触发一次回调
+     */
+    bool onTimerTick() override {
+        if (isStopRequested() || reachedMaxTriggers()) {
+            setState(ThreadState::FINISHED);
+            return false;
+        }
+        if (!updatePausedState()) {
+            return true; // 暂停期间跳过本次触发
+        }
+
+        fire();
+
+        if (reachedMaxTriggers()) {
+            setState(ThreadState::FINISHED);
+            return false;
+        }
+        return true;
     }
 
     /**
@@ -262,6 +346,13 @@ public:
                (maxTriggers_ > 0 ? " (max " + std::to_string(maxTriggers_) + " triggers)" : " (infinite)");
     }
 
+    /**
+     * @brief 获取触发间隔
+     */
+    std::chrono::milliseconds getInterval() const {
+        return interval_;
+    }
+
     /**
      * @brief 获取触发次数
      */
@@ -283,12 +374,90 @@ public:
         return maxTriggers_;
     }
 
+private:
+    bool reachedMaxTriggers() const {
+        return maxTriggers_ > 0 && triggerCount_.load() >= maxTriggers_;
+    }
+
+    /**
+     * @brief 计算下一次触发的截止时间
+     *
+     * 落后超过一个间隔时跳过错过的触发并对齐到原有节拍。
+     */
+    std::chrono::steady_clock::time_point nextDeadline(std::chrono::steady_clock::time_point deadline) const {
+        auto now = std::chrono::steady_clock::now();
+        if (interval_.count() <= 0) {
+            return now;
+        }
+        deadline += interval_;
+        if (deadline <= now) {
+            auto missed = (now - deadline) / interval_ + 1;
+            deadline += interval_ * missed;
+        }
+        return deadline;
+    }
+
+    /**
+     * @brief 回调是否可调用，空的 std::function 只计数不调用
+     */
+    static bool hasCallback(const std::function<void()>& callback) {
+        return static_cast<bool>(callback);
+    }
+
+    template <typename F>
+    static bool hasCallback(const F&) {
+        return true;
+    }
+
+    /**
+     * @brief 执行回调
+     */
+    void fire() {
+        triggerCount_.add();
+        if (hasCallback(callback_)) {
+            try {
+                timeCallback(callback_);
+            } catch (const std::exception& e) {
+                reportError(std::string("Timer callback failed: ") + e.what());
+            }
+        }
+    }
+};
+
+/**
+ * @brief 定时器工作者 - 周期性触发回调
+ *
+ * 适用于定时任务、周期性检查、定时器等场景。
+ */
+class TimerWorker : public BasicTimerWorker<std::function<void()>> {
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param interval 触发间隔
+     * @param callback 回调函数
+     * @param maxTriggers 最大触发次数，-1表示无限次
+     * @param mode 驱动方式，默认独占线程
+     */
+    TimerWorker(std::chrono::milliseconds interval,
+                std::function<void()> callback,
+                int maxTriggers = -1,
+                TimerMode mode = TimerMode::DEDICATED_THREAD)
+        : BasicTimerWorker(interval, std::move(callback), maxTriggers, mode) {}
+
+    /**
+     * @brief 获取工作者类型
+     */
+    std::string getType() const override {
+        return "TimerWorker";
+    }
+
     void onStart() override {
-        std::cout << "[" << getType() << "] Timer started (" << interval_.count() << "ms interval)" << std::endl;
+        TF_LOG_INFO("[", getType(), "] Timer started (", getInterval().count(), "ms interval)");
     }
 
     void onStop() override {
-        std::cout << "[" << getType() << "] Timer stopped after " << getTriggerCount() << " triggers" << std::endl;
+        TF_LOG_INFO("[", getType(), "] Timer stopped after ", getTriggerCount(), " triggers");
     }
 };
 
@@ -303,7 +472,7 @@ private:
     std::function<void(int)> loopCallback_;
     std::function<void()> startCallback_;
     std::function<void()> endCallback_;
-    std::atomic<int> currentLoop_{0};
+    OwnedCounter<int> currentLoop_; ///< 只由工作者线程写入
 
 public:
     /**
@@ -335,9 +504,9 @@ public:
             currentLoop_.store(i);
             if (loopCallback_) {
                 try {
-                    loopCallback_(i);
+                    timeCallback([this, i]() { loopCallback_(i); });
                 } catch (const std::exception& e) {
-                    onError(std::string("Loop callback failed: ") + e.what());
+                    reportError(std::string("Loop callback failed: ") + e.what());
                 }
             }
         }
@@ -383,6 +552,244 @@ public:
     double getProgress() const {
         return static_cast<double>(getCurrentLoop()) / loopCount_ * 100.0;
     }
+
+    /**
+     * @brief 固定次数的循环可以在线程池中执行
+     */
+    bool isPoolable() const override {
+        return true;
+    }
+};
+
+/**
+ * @brief 队列工作者 - 从共享队列中消费元素
+ *
+ * 适用于生产者/消费者模式：多个 QueueWorker 共享同一个有界无锁队列，
+ * 每次批量取出最多 batchSize 个元素处理。队列为空时在队列上休眠，不轮询；
+ * 停止请求或队列关闭会立即唤醒它。队列关闭后处理完剩余元素再结束。
+ *
+ * 派生类可以重写 process() 代替传入处理函数。
+ *
+ * @tparam T 元素类型
+ */
+template <typename T>
+class QueueWorker : public IThreadWorker {
+public:
+    using Queue = MPMCQueue<T>;
+
+    /**
+     * @brief 构造函数
+     *
+     * @param queue 共享队列
+     * @param handler 元素处理函数，可选
+     * @param batchSize 每次最多取出的元素数量
+     */
+    explicit QueueWorker(std::shared_ptr<Queue> queue,
+                         std::function<void(T&)> handler = nullptr,
+                         size_t batchSize = 32)
+        : queue_(std::move(queue)), handler_(std::move(handler)),
+          batchSize_(batchSize == 0 ? 1 : batchSize) {}
+
+    /**
+     * @brief 执行消费循环
+     */
+    void run() override {
+        setState(ThreadState::RUNNING);
+
+        std::vector<T> batch;
+        batch.reserve(batchSize_);
+        while (shouldContinue()) {
+            batch.clear();
+            // 暂停请求也结束等待，暂停的消费者不再取走元素，留给其它消费者
+            size_t count = queue_->popBulk(batch, batchSize_,
+                                           [this]() { return isStopRequested() || isPauseRequested(); });
+            if (count == 0) {
+                if (queue_->isClosed() && queue_->empty()) {
+                    break; // 队列已关闭且已取完
+                }
+                continue; // 停止或暂停请求，由 shouldContinue() 结束循环或进入暂停
+            }
+
+            for (auto& item : batch) {
+                try {
+                    timeCallback([this, &item]() { process(item); });
+                } catch (const std::exception& e) {
+                    reportError(std::string("Queue item processing failed: ") + e.what());
+                }
+                processedCount_.add();
+            }
+        }
+
+        setState(ThreadState::FINISHED);
+    }
+
+    /**
+     * @brief 获取工作者类型
+     */
+    std::string getType() const override {
+        return "QueueWorker";
+    }
+
+    /**
+     * @brief 获取工作者描述
+     */
+    std::string getDescription() const override {
+        return "Queue worker with batch size " + std::to_string(batchSize_);
+    }
+
+    /**
+     * @brief 停止时唤醒在队列上休眠的消费者
+     */
+    void onStop() override {
+        queue_->wakeConsumers();
+    }
+
+    /**
+     * @brief 暂停时唤醒在队列上休眠的消费者，让它进入暂停而不是取走下一批元素
+     */
+    void onPause() override {
+        queue_->wakeConsumers();
+    }
+
+    /**
+     * @brief 获取已处理的元素数量
+     */
+    uint64_t getProcessedCount() const {
+        return processedCount_.load();
+    }
+
+    /**
+     * @brief 获取共享队列
+     */
+    const std::shared_ptr<Queue>& getQueue() const {
+        return queue_;
+    }
+
+protected:
+    /**
+     * @brief 处理一个元素，默认调用构造时传入的处理函数
+     *
+     * @param item 队列元素
+     */
+    virtual void process(T& item) {
+        if (handler_) {
+            handler_(item);
+        }
+    }
+
+private:
+    std::shared_ptr<Queue> queue_;
+    std::function<void(T&)> handler_;
+    size_t batchSize_;
+    OwnedCounter<uint64_t> processedCount_;
+};
+
+/**
+ * @brief 事件循环工作者 - 由就绪事件驱动的线程
+ *
+ * 拥有一个 epoll 事件循环并在自己的线程上运行它。描述符、定时器（timerfd）、
+ * 通知（eventfd）和文件监视（inotify）注册到 getLoop() 后，线程只在事件发生时醒来，
+ * 空闲时不消耗CPU，用来代替按固定间隔 sleep 轮询。
+ *
+ * 事件源可以在构造时传入的设置函数或重写的 onLoopStart() 中注册（在工作者线程上调用），
+ * 也可以随时从其它线程注册。暂停期间不分派事件，恢复后处理积压的事件。
+ */
+class EventLoopWorker : public IThreadWorker {
+public:
+    using SetupCallback = std::function<void(EventLoop&)>;
+
+    /**
+     * @brief 构造函数
+     *
+     * @param setup 循环开始前在工作者线程上调用的设置函数，可选
+     */
+    explicit EventLoopWorker(SetupCallback setup = nullptr) : setup_(std::move(setup)) {}
+
+    /**
+     * @brief 运行事件循环，直到停止请求
+     */
+    void run() override {
+        setState(ThreadState::RUNNING);
+
+        try {
+            onLoopStart(loop_);
+        } catch (const std::exception& e) {
+            reportError(std::string("Event loop setup failed: ") + e.what());
+        }
+
+        while (shouldContinue()) {
+            size_t dispatched = loop_.runOnce(-1);
+            eventCount_.add(dispatched);
+        }
+
+        onLoopStop(loop_);
+        setState(ThreadState::FINISHED);
+    }
+
+    /**
+     * @brief 停止或恢复请求之后唤醒阻塞在 epoll_wait 中的线程
+     */
+    void wakeAsync() override {
+        loop_.wakeup();
+    }
+
+    /**
+     * @brief 获取工作者类型
+     */
+    std::string getType() const override {
+        return "EventLoopWorker";
+    }
+
+    /**
+     * @brief 获取工作者描述
+     */
+    std::string getDescription() const override {
+        return "Event loop worker with " + std::to_string(loop_.getHandlerCount()) + " event sources";
+    }
+
+    /**
+     * @brief 获取事件循环，可以从任意线程注册事件源
+     */
+    EventLoop& getLoop() {
+        return loop_;
+    }
+
+    /**
+     * @brief 获取已分派的事件数量
+     */
+    uint64_t getEventCount() const {
+        return eventCount_.load();
+    }
+
+    void onStart() override {
+        TF_LOG_INFO("[", getType(), "] Event loop started");
+    }
+
+    void onStop() override {
+        TF_LOG_INFO("[", getType(), "] Event loop stopped after ", getEventCount(), " events");
+    }
+
+protected:
+    /**
+     * @brief 循环开始前在工作者线程上调用，默认调用构造时传入的设置函数
+     */
+    virtual void onLoopStart(EventLoop& loop) {
+        if (setup_) {
+            setup_(loop);
+        }
+    }
+
+    /**
+     * @brief 循环结束后在工作者线程上调用，可以在这里释放事件源
+     */
+    virtual void onLoopStop(EventLoop& loop) {
+        (void)loop;
+    }
+
+private:
+    EventLoop loop_;
+    SetupCallback setup_;
+    OwnedCounter<uint64_t> eventCount_;
 };
 
 } // namespace thread_framework
@@ -0,0 +1,547 @@
+#ifndef CANCELLATION_TOKEN_H
+#define CANCELLATION_TOKEN_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+/**
+ * @file CancellationToken.h
+ * @brief 层级取消令牌和截止时间
+ *
+ * CancellationSource 发出取消，CancellationToken 观察取消。源可以挂在父令牌下，
+ * 取消父令牌会取消所有子令牌；子令牌的截止时间不晚于父令牌。
+ * 取消是协作式的：工作者的 shouldContinue()、Future、MPMC 队列的等待和线程管理器
+ * 会观察令牌，正在执行的代码需要自己检查 isCancelled()。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+class ThreadManager;
+class CancellationSource;
+class CancellationRegistration;
+
+/**
+ * @brief 取消原因
+ */
+enum class CancellationReason {
+    NONE,       ///< 未取消
+    CANCELLED,  ///< 显式取消（包括父令牌被取消）
+    DEADLINE    ///< 超过截止时间
+};
+
+/**
+ * @brief 被取消的操作抛出的异常
+ */
+class OperationCancelled : public std::runtime_error {
+public:
+    explicit OperationCancelled(CancellationReason reason)
+        : std::runtime_error(reason == CancellationReason::DEADLINE ? "deadline exceeded" : "operation cancelled"),
+          reason_(reason) {}
+
+    CancellationReason getReason() const {
+        return reason_;
+    }
+
+private:
+    CancellationReason reason_;
+};
+
+namespace detail {
+
+/**
+ * @brief 取消令牌的共享状态
+ *
+ * 截止时间在构造时确定，之后不变。到达截止时间时 isCancelled() 立即返回 true，
+ * 但回调只在显式取消或定时器触发 cancel(DEADLINE) 时执行。
+ */
+class CancellationState {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit CancellationState(Clock::time_point deadline) : deadline_(deadline) {}
+
+    ~CancellationState() {
+        if (parent_) {
+            parent_->removeCallback(parentCallback_);
+        }
+    }
+
+    CancellationState(const CancellationState&) = delete;
+    CancellationState& operator=(const CancellationState&) = delete;
+
+    /**
+     * @brief 挂到父状态下，父状态取消时取消本状态
+     */
+    static void link(const std::shared_ptr<CancellationState>& child, const std::shared_ptr<CancellationState>& parent) {
+        std::weak_ptr<CancellationState> weak = child;
+        std::weak_ptr<CancellationState> weakParent = parent;
+        child->parent_ = parent;
+        child->parentCallback_ = parent->addCallback([weak, weakParent]() {
+            auto state = weak.lock();
+            auto owner = weakParent.lock();
+            if (state) {
+                state->cancel(owner ? owner->reason() : CancellationReason::CANCELLED);
+            }
+        });
+    }
+
+    /**
+     * @brief 是否已取消或超过截止时间，不加锁
+     */
+    bool isCancelled() const {
+        return reason_.load(std::memory_order_acquire) != static_cast<int>(CancellationReason::NONE) ||
+               (hasDeadline() && Clock::now() >= deadline_);
+    }
+
+    CancellationReason reason() const {
+        int value = reason_.load(std::memory_order_acquire);
+        if (value != static_cast<int>(CancellationReason::NONE)) {
+            return static_cast<CancellationReason>(value);
+        }
+        return hasDeadline() && Clock::now() >= deadline_ ? CancellationReason::DEADLINE : CancellationReason::NONE;
+    }
+
+    bool hasDeadline() const {
+        return deadline_ != Clock::time_point::max();
+    }
+
+    Clock::time_point deadline() const {
+        return deadline_;
+    }
+
+    /**
+     * @brief 取消并按注册顺序执行回调
+     *
+     * 回调在调用 cancel() 的线程上执行，执行时不持有锁，因此回调中可以注册或注销回调。
+     *
+     * @return true 本次调用完成了取消
+     * @return false 已经取消过
+     */
+    bool cancel(CancellationReason why) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (reason_.load(std::memory_order_relaxed) != static_cast<int>(CancellationReason::NONE)) {
+            return false;
+        }
+        reason_.store(static_cast<int>(why), std::memory_order_release);
+
+        while (!callbacks_.empty()) {
+            Callback callback = std::move(callbacks_.front());
+            callbacks_.pop_front();
+            runningId_ = callback.id;
+            runningThread_ = std::this_thread::get_id();
+            lock.unlock();
+            try {
+                callback.function();
+            } catch (...) {
+                // 回调不应抛出异常，忽略以保证其余回调仍然执行
+            }
+            lock.lock();
+            runningId_ = 0;
+            condition_.notify_all();
+        }
+        lock.unlock();
+        condition_.notify_all();
+        return true;
+    }
+
+    /**
+     * @brief 注册回调
+     *
+     * @return uint64_t 回调ID；已取消时回调立即在当前线程执行，返回0
+     */
+    uint64_t addCallback(std::function<void()> function) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!isCancelled()) {
+                uint64_t id = nextId_++;
+                callbacks_.push_back(Callback{id, std::move(function)});
+                return id;
+            }
+        }
+        function();
+        return 0;
+    }
+
+    /**
+     * @brief 注销回调
+     *
+     * 回调正在其它线程上执行时等待它返回，之后回调捕获的对象可以安全销毁。
+     */
+    void removeCallback(uint64_t id) {
+        if (id == 0) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (auto it = callbacks_.begin(); it != callbacks_.end(); ++it) {
+            if (it->id == id) {
+                callbacks_.erase(it);
+                return;
+            }
+        }
+        if (runningId_ == id && runningThread_ != std::this_thread::get_id()) {
+            condition_.wait(lock, [this, id]() { return runningId_ != id; });
+        }
+    }
+
+    /**
+     * @brief 休眠到 until，取消时提前返回
+     *
+     * @return true 到达 until 且未取消
+     */
+    bool sleepUntil(Clock::time_point until) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        Clock::time_point limit = std::min(until, deadline_);
+        condition_.wait_until(lock, limit, [this]() {
+            return reason_.load(std::memory_order_relaxed) != static_cast<int>(CancellationReason::NONE);
+        });
+        return !isCancelled() && Clock::now() >= until;
+    }
+
+    /**
+     * @brief 标记已安排截止时间定时器
+     *
+     * @return true 第一次标记
+     */
+    bool markDeadlineArmed() {
+        return !deadlineArmed_.exchange(true);
+    }
+
+private:
+    struct Callback {
+        uint64_t id;
+        std::function<void()> function;
+    };
+
+    std::atomic<int> reason_{static_cast<int>(CancellationReason::NONE)};
+    const Clock::time_point deadline_;
+    std::atomic<bool> deadlineArmed_{false};
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<Callback> callbacks_;
+    uint64_t nextId_ = 1;
+    uint64_t runningId_ = 0;         ///< 正在执行的回调ID
+    std::thread::id runningThread_;  ///< 执行回调的线程
+
+    std::shared_ptr<CancellationState> parent_;
+    uint64_t parentCallback_ = 0;
+};
+
+} // namespace detail
+
+/**
+ * @brief 取消令牌，只能观察取消
+ *
+ * 复制令牌只复制引用。默认构造的令牌永远不会被取消，检查它几乎没有开销。
+ * 令牌本身也是一个返回 bool 的停止条件，可以直接传给 MPMCQueue 的 push()/pop()/popBulk()。
+ */
+class CancellationToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief 永远不会被取消的令牌
+     */
+    CancellationToken() = default;
+
+    /**
+     * @brief 是否可能被取消（是否关联了源）
+     */
+    bool canBeCancelled() const {
+        return state_ != nullptr;
+    }
+
+    /**
+     * @brief 是否已取消或超过截止时间
+     */
+    bool isCancelled() const {
+        return state_ && state_->isCancelled();
+    }
+
+    /**
+     * @brief 作为停止条件使用
+     */
+    bool operator()() const {
+        return isCancelled();
+    }
+
+    /**
+     * @brief 获取取消原因
+     */
+    CancellationReason getReason() const {
+        return state_ ? state_->reason() : CancellationReason::NONE;
+    }
+
+    /**
+     * @brief 是否有截止时间
+     */
+    bool hasDeadline() const {
+        return state_ && state_->hasDeadline();
+    }
+
+    /**
+     * @brief 获取截止时间，没有截止时间时为 time_point::max()
+     */
+    Clock::time_point getDeadline() const {
+        return state_ ? state_->deadline() : Clock::time_point::max();
+    }
+
+    /**
+     * @brief 已取消时抛出 OperationCancelled
+     *
+     * @throws OperationCancelled 已取消或超过截止时间
+     */
+    void throwIfCancelled() const {
+        if (isCancelled()) {
+            throw OperationCancelled(getReason());
+        }
+    }
+
+    /**
+     * @brief 注册取消回调
+     *
+     * 回调在调用 cancel() 的线程（或截止时间定时器的线程）上执行一次，应尽量简短且不抛出异常。
+     * 已取消时回调立即在当前线程执行。
+     *
+     * @param callback 回调
+     * @return CancellationRegistration 销毁时注销回调；回调正在其它线程执行时等待它返回
+     */
+    inline CancellationRegistration onCancel(std::function<void()> callback) const;
+
+    /**
+     * @brief 可取消的休眠
+     *
+     * @param duration 休眠时长
+     * @return true 休眠了完整时长
+     * @return false 被取消或到达截止时间
+     */
+    template <typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& duration) const {
+        return waitUntil(Clock::now() + std::chrono::duration_cast<Clock::duration>(duration));
+    }
+
+    /**
+     * @brief 可取消地休眠到指定时间点
+     *
+     * @return true 到达时间点
+     * @return false 被取消或到达截止时间
+     */
+    bool waitUntil(Clock::time_point until) const {
+        if (!state_) {
+            std::this_thread::sleep_until(until);
+            return true;
+        }
+        return state_->sleepUntil(until);
+    }
+
+    /**
+     * @brief 获取当前线程正在执行的工作的令牌
+     *
+     * 线程管理器在执行工作者的 run()、定时回调和 submit() 的任务时设置，
+     * 使 TaskWorker 的任务函数等不持有工作者引用的代码也能观察取消。没有时返回永不取消的令牌。
+     */
+    static const CancellationToken& current() {
+        const CancellationToken* token = currentSlot();
+        return token ? *token : none();
+    }
+
+private:
+    friend class CancellationSource;
+    friend class CancellationScope;
+    friend class ThreadManager;
+
+    std::shared_ptr<detail::CancellationState> state_;
+
+    explicit CancellationToken(std::shared_ptr<detail::CancellationState> state) : state_(std::move(state)) {}
+
+    static const CancellationToken& none() {
+        static const CancellationToken token;
+        return token;
+    }
+
+    static const CancellationToken*& currentSlot() {
+        static thread_local const CancellationToken* token = nullptr;
+        return token;
+    }
+};
+
+/**
+ * @brief 取消回调的注册，销毁时注销
+ */
+class CancellationRegistration {
+public:
+    CancellationRegistration() = default;
+
+    ~CancellationRegistration() {
+        unregister();
+    }
+
+    CancellationRegistration(CancellationRegistration&& other) noexcept
+        : state_(std::move(other.state_)), id_(other.id_) {
+        other.id_ = 0;
+    }
+
+    CancellationRegistration& operator=(CancellationRegistration&& other) noexcept {
+        if (this != &other) {
+            unregister();
+            state_ = std::move(other.state_);
+            id_ = other.id_;
+            other.id_ = 0;
+        }
+        return *this;
+    }
+
+    CancellationRegistration(const CancellationRegistration&) = delete;
+    CancellationRegistration& operator=(const CancellationRegistration&) = delete;
+
+    /**
+     * @brief 注销回调，回调正在其它线程执行时等待它返回
+     */
+    void unregister() {
+        if (state_) {
+            state_->removeCallback(id_);
+            state_.reset();
+            id_ = 0;
+        }
+    }
+
+private:
+    friend class CancellationToken;
+
+    std::shared_ptr<detail::CancellationState> state_;
+    uint64_t id_ = 0;
+
+    CancellationRegistration(std::shared_ptr<detail::CancellationState> state, uint64_t id)
+        : state_(std::move(state)), id_(id) {}
+};
+
+inline CancellationRegistration CancellationToken::onCancel(std::function<void()> callback) const {
+    if (!state_) {
+        return CancellationRegistration();
+    }
+    uint64_t id = state_->addCallback(std::move(callback));
+    return CancellationRegistration(id != 0 ? state_ : nullptr, id);
+}
+
+/**
+ * @brief 取消源
+ *
+ * 复制的源共享同一个状态。源销毁时不会取消令牌；挂在父令牌下的源保持与父令牌的关联，
+ * 直到最后一个引用（源或令牌）销毁。
+ *
+ * @code
+ * CancellationSource request(CancellationToken(), std::chrono::seconds(2));
+ * ThreadLaunchOptions options;
+ * options.cancellation = request.getToken();
+ * manager.createThreadWithWorker(std::make_unique<Crawler>(), "crawler", options);
+ *
+ * // 在工作者内部派生子任务，取消 request 时一并取消
+ * CancellationSource child(getCancellationToken());
+ * @endcode
+ */
+class CancellationSource {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief 创建没有父令牌和截止时间的源
+     */
+    CancellationSource() : CancellationSource(CancellationToken(), Clock::time_point::max()) {}
+
+    /**
+     * @brief 创建挂在父令牌下的源
+     *
+     * @param parent 父令牌，取消它会取消本源；可以是永不取消的令牌
+     */
+    explicit CancellationSource(const CancellationToken& parent)
+        : CancellationSource(parent, Clock::time_point::max()) {}
+
+    /**
+     * @brief 创建带截止时间的源
+     *
+     * @param parent 父令牌
+     * @param deadline 截止时间，晚于父令牌的截止时间时使用父令牌的截止时间
+     */
+    CancellationSource(const CancellationToken& parent, Clock::time_point deadline) {
+        state_ = std::make_shared<detail::CancellationState>(std::min(deadline, parent.getDeadline()));
+        if (parent.state_) {
+            detail::CancellationState::link(state_, parent.state_);
+        }
+    }
+
+    /**
+     * @brief 创建从现在起 timeout 后到期的源
+     *
+     * @param parent 父令牌
+     * @param timeout 超时时长
+     */
+    template <typename Rep, typename Period>
+    CancellationSource(const CancellationToken& parent, const std::chrono::duration<Rep, Period>& timeout)
+        : CancellationSource(parent, Clock::now() + std::chrono::duration_cast<Clock::duration>(timeout)) {}
+
+    /**
+     * @brief 获取令牌
+     */
+    CancellationToken getToken() const {
+        return CancellationToken(state_);
+    }
+
+    /**
+     * @brief 取消，执行所有回调并取消子令牌
+     *
+     * @return true 本次调用完成了取消
+     * @return false 已经取消过
+     */
+    bool cancel() {
+        CancellationReason why = state_->reason() == CancellationReason::DEADLINE ? CancellationReason::DEADLINE
+                                                                                 : CancellationReason::CANCELLED;
+        return state_->cancel(why);
+    }
+
+    /**
+     * @brief 是否已取消或超过截止时间
+     */
+    bool isCancelled() const {
+        return state_->isCancelled();
+    }
+
+private:
+    std::shared_ptr<detail::CancellationState> state_;
+};
+
+/**
+ * @brief 在当前线程上设置 CancellationToken::current() 的作用域
+ */
+class CancellationScope {
+public:
+    explicit CancellationScope(const CancellationToken& token)
+        : previous_(CancellationToken::currentSlot()) {
+        CancellationToken::currentSlot() = &token;
+    }
+
+    ~CancellationScope() {
+        CancellationToken::currentSlot() = previous_;
+    }
+
+    CancellationScope(const CancellationScope&) = delete;
+    CancellationScope& operator=(const CancellationScope&) = delete;
+
+private:
+    const CancellationToken* previous_;
+};
+
+} // namespace thread_framework
+
+#endif // CANCELLATION_TOKEN_H
@@ -0,0 +1,648 @@
+#ifndef COROUTINE_WORKER_H
+#define COROUTINE_WORKER_H
+
+#if __cplusplus < 202002L || !defined(__cpp_impl_coroutine)
+#error "CoroutineWorker.h requires C++20 coroutines (compile with -std=c++20)"
+#endif
+
+#include "IThreadWorker.h"
+#include "ThreadPool.h"
+#include "TimerService.h"
+#include "EventLoop.h"
+#include "Future.h"
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <atomic>
+#include <memory>
+#include <chrono>
+
+/**
+ * @file CoroutineWorker.h
+ * @brief 基于 C++20 协程的工作者
+ *
+ * 协程工作者不独占线程。线程管理器在线程池上启动它，等待定时器、文件描述符就绪或
+ * 其它任务的 Future 时协程挂起并让出池线程，等待结束后在任意一个池线程上继续执行。
+ * 少量池线程即可承载大量以等待为主的工作者，例如上万个网络检查器。
+ *
+ * 框架其余部分仍为 C++17，只有包含这个头文件的翻译单元需要 -std=c++20。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+template <typename T = void>
+class Task;
+
+/**
+ * @brief 协程等待的结果
+ */
+enum class WaitResult {
+    READY,      ///< 等待的事件已发生
+    TIMEOUT,    ///< 超时
+    STOPPED,    ///< 收到停止请求
+    FAILED      ///< 无法开始等待，例如描述符无效
+};
+
+namespace detail {
+
+/**
+ * @brief 在池线程上恢复协程的任务
+ */
+class ResumeTask : public PoolTask {
+public:
+    explicit ResumeTask(std::coroutine_handle<> handle) : handle_(handle) {}
+
+    void execute() override {
+        handle_.resume();
+    }
+
+private:
+    std::coroutine_handle<> handle_;
+};
+
+/**
+ * @brief Task 的 promise 公共部分
+ *
+ * 协程创建后先挂起，被 co_await 时才开始执行；结束时通过对称转移直接恢复等待方，
+ * 深层的 co_await 链不会增长调用栈。
+ */
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            return handle.promise().continuation;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+
+    void unhandled_exception() noexcept {
+        error = std::current_exception();
+    }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+
+    template <typename V>
+    void return_value(V&& result) {
+        value.emplace(std::forward<V>(result));
+    }
+
+    T result() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object() noexcept;
+
+    void return_void() const noexcept {}
+
+    void result() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+/**
+ * @brief 协程工作者的等待通道
+ *
+ * 每次等待分配一个新的代数，定时器、描述符回调和控制请求各自持有（通道，代数），
+ * 只有第一个把状态从“等待中”改为“已完成”的一方负责恢复协程，迟到的一方什么也不做。
+ * 通道由 shared_ptr 持有，工作者销毁后迟到的回调仍可以安全访问。
+ *
+ * 状态字从低位起：等待中、挂起进行中、恢复时唤醒、两位结果、其余为代数。
+ * 在 await_suspend 返回之前完成的等待由挂起方直接恢复，不经过线程池。
+ */
+class WaitChannel {
+public:
+    void setPool(ThreadPool* pool) {
+        pool_ = pool;
+    }
+
+    /**
+     * @brief 开始一次等待，只能由协程自己调用
+     *
+     * @param handle 要恢复的协程
+     * @param wakeOnResume 为true时恢复请求也会结束这次等待
+     * @return uint64_t 本次等待的代数
+     */
+    uint64_t arm(std::coroutine_handle<> handle, bool wakeOnResume) {
+        handle_ = handle;
+        uint64_t generation = ++generation_;
+        state_.store((generation << kGenerationShift) | kArmed | kSuspending |
+                     (wakeOnResume ? kWakeOnResume : 0));
+        return generation;
+    }
+
+    /**
+     * @brief 结束指定代数的等待
+     *
+     * @return true 本次调用结束了等待
+     * @return false 等待已被其它来源结束或已过期
+     */
+    bool complete(uint64_t generation, WaitResult result) {
+        uint64_t current = state_.load();
+        uint64_t next;
+        do {
+            if ((current >> kGenerationShift) != generation || (current & kArmed) == 0) {
+                return false;
+            }
+            next = (current & ~(kArmed | kResultMask)) |
+                   (static_cast<uint64_t>(result) << kResultShift);
+        } while (!state_.compare_exchange_weak(current, next));
+
+        if ((current & kSuspending) == 0) {
+            pool_->submit(new ResumeTask(handle_));
+        }
+        return true;
+    }
+
+    /**
+     * @brief 在 await_suspend 的最后调用
+     *
+     * @return true 仍在等待，协程保持挂起
+     * @return false 等待已经结束，协程应立即继续
+     */
+    bool finishSuspend() {
+        return (state_.fetch_and(~kSuspending) & kArmed) != 0;
+    }
+
+    /**
+     * @brief 获取最近一次等待的结果，在协程恢复后调用
+     */
+    WaitResult result() const {
+        return static_cast<WaitResult>((state_.load() & kResultMask) >> kResultShift);
+    }
+
+    /**
+     * @brief 获取当前等待的代数
+     *
+     * @param wakeOnResume 输出当前等待是否响应恢复请求
+     * @return uint64_t 代数，没有进行中的等待时为0
+     */
+    uint64_t armedGeneration(bool& wakeOnResume) const {
+        uint64_t state = state_.load();
+        wakeOnResume = (state & kWakeOnResume) != 0;
+        return (state & kArmed) != 0 ? state >> kGenerationShift : 0;
+    }
+
+private:
+    static constexpr uint64_t kArmed = 1;
+    static constexpr uint64_t kSuspending = 2;
+    static constexpr uint64_t kWakeOnResume = 4;
+    static constexpr int kResultShift = 3;
+    static constexpr uint64_t kResultMask = uint64_t(3) << kResultShift;
+    static constexpr int kGenerationShift = 5;
+
+    std::atomic<uint64_t> state_{0};
+    uint64_t generation_ = 0;               ///< 只由协程自己修改
+    std::coroutine_handle<> handle_;
+    ThreadPool* pool_ = nullptr;
+};
+
+/**
+ * @brief co_await Future 的等待器
+ *
+ * 未就绪时把协程注册为 Future 的延续，结果就绪后在 Future 所属的线程池上恢复。
+ */
+template <typename R>
+class FutureAwaiter {
+public:
+    explicit FutureAwaiter(Future<R>&& future) : future_(std::move(future)) {}
+
+    bool await_ready() const {
+        return future_.isReady();
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        future_.state_->setContinuation(new ResumeTask(handle));
+    }
+
+    R await_resume() {
+        return future_.get();
+    }
+
+private:
+    Future<R> future_;
+};
+
+/**
+ * @brief 协程工作者的根协程，立即开始执行，结束时自行销毁
+ */
+struct DetachedCoroutine {
+    struct promise_type {
+        DetachedCoroutine get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+} // namespace detail
+
+/**
+ * @brief 惰性协程任务
+ *
+ * 被 co_await 时才开始执行，返回值或异常在 co_await 处取得。只能移动，销毁时释放协程帧。
+ *
+ * @tparam T 结果类型
+ */
+template <typename T>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept {
+        return handle_.done();
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+
+    T await_resume() {
+        return handle_.promise().result();
+    }
+
+private:
+    friend struct detail::TaskPromise<T>;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+} // namespace detail
+
+/**
+ * @brief 在协程中等待 Future
+ *
+ * 等待期间不占用线程，结果就绪后在 Future 所属的线程池上继续执行。Future 随之失效。
+ */
+template <typename R>
+detail::FutureAwaiter<R> operator co_await(Future<R>&& future) {
+    return detail::FutureAwaiter<R>(std::move(future));
+}
+
+template <typename R>
+detail::FutureAwaiter<R> operator co_await(Future<R>& future) {
+    return detail::FutureAwaiter<R>(std::move(future));
+}
+
+/**
+ * @brief 协程工作者基类
+ *
+ * 派生类实现 runAsync()，在其中用 co_await 等待 sleepFor()、waitReadable()、
+ * waitWritable()、checkpoint() 或 Future。停止请求会立即结束正在进行的等待，
+ * 派生类检查返回值后应尽快 co_return。
+ *
+ * 只能由线程管理器启动：isAsync() 返回true，线程管理器不调用 run()。
+ */
+class CoroutineWorker : public IThreadWorker {
+public:
+    CoroutineWorker() : channel_(std::make_shared<detail::WaitChannel>()) {}
+
+    /**
+     * @brief 协程主体
+     *
+     * @return Task<void> 协程任务，抛出的异常通过 reportError() 报告
+     */
+    virtual Task<void> runAsync() = 0;
+
+    bool isAsync() const final { return true; }
+
+    /**
+     * @brief 协程工作者不能在调用方线程上同步执行
+     */
+    void run() final {
+        reportError("CoroutineWorker must be started by ThreadManager");
+        setState(ThreadState::FINISHED);
+    }
+
+    void startAsync(const AsyncContext& context, std::function<void()> onFinished) final {
+        context_ = context;
+        channel_->setPool(context.pool);
+        setState(ThreadState::RUNNING);
+        start(this, std::move(onFinished));
+    }
+
+    void wakeAsync() final {
+        bool wakeOnResume = false;
+        uint64_t generation = channel_->armedGeneration(wakeOnResume);
+        if (generation == 0) {
+            return;
+        }
+        if (isStopRequested()) {
+            channel_->complete(generation, WaitResult::STOPPED);
+        } else if (wakeOnResume && !isPauseRequested()) {
+            channel_->complete(generation, WaitResult::READY);
+        }
+    }
+
+protected:
+    /**
+     * @brief 定时等待的等待器
+     */
+    class SleepAwaiter {
+    public:
+        SleepAwaiter(CoroutineWorker& worker, TimerService::Clock::time_point deadline)
+            : worker_(worker), deadline_(deadline) {}
+
+        bool await_ready() const {
+            return worker_.isStopRequested() || deadline_ <= TimerService::Clock::now();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            suspended_ = true;
+            std::shared_ptr<detail::WaitChannel> channel = worker_.channel_;
+            uint64_t generation = channel->arm(handle, false);
+            timer_ = worker_.context_.timers->scheduleAt(deadline_, [channel, generation]() {
+                channel->complete(generation, WaitResult::TIMEOUT);
+            });
+            if (worker_.isStopRequested()) {
+                channel->complete(generation, WaitResult::STOPPED);
+            }
+            return channel->finishSuspend();
+        }
+
+        bool await_resume() const {
+            if (!suspended_) {
+                return !worker_.isStopRequested();
+            }
+            WaitResult result = worker_.channel_->result();
+            if (result != WaitResult::TIMEOUT) {
+                worker_.context_.timers->cancel(timer_);
+            }
+            return result == WaitResult::TIMEOUT;
+        }
+
+    private:
+        CoroutineWorker& worker_;
+        TimerService::Clock::time_point deadline_;
+        TimerService::TimerId timer_ = 0;
+        bool suspended_ = false;
+    };
+
+    /**
+     * @brief 文件描述符就绪的等待器
+     */
+    class IoAwaiter {
+    public:
+        IoAwaiter(CoroutineWorker& worker, int fd, uint32_t events, std::chrono::milliseconds timeout)
+            : worker_(worker), fd_(fd), events_(events), timeout_(timeout) {}
+
+        bool await_ready() const {
+            return worker_.isStopRequested();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            suspended_ = true;
+            std::shared_ptr<detail::WaitChannel> channel = worker_.channel_;
+            uint64_t generation = channel->arm(handle, false);
+
+            registered_ = worker_.context_.events->add(fd_, events_, [channel, generation](uint32_t) {
+                channel->complete(generation, WaitResult::READY);
+            }, true);
+            if (!registered_) {
+                channel->complete(generation, WaitResult::FAILED);
+            } else if (timeout_.count() > 0) {
+                timer_ = worker_.context_.timers->scheduleAfter(timeout_, [channel, generation]() {
+                    channel->complete(generation, WaitResult::TIMEOUT);
+                });
+            }
+            if (worker_.isStopRequested()) {
+                channel->complete(generation, WaitResult::STOPPED);
+            }
+            return channel->finishSuspend();
+        }
+
+        WaitResult await_resume() const {
+            if (!suspended_) {
+                return WaitResult::STOPPED; // 在 await_ready 中就已停止
+            }
+            WaitResult result = worker_.channel_->result();
+            if (registered_) {
+                worker_.context_.events->remove(fd_);
+            }
+            if (timer_ != 0 && result != WaitResult::TIMEOUT) {
+                worker_.context_.timers->cancel(timer_);
+            }
+            return result;
+        }
+
+    private:
+        CoroutineWorker& worker_;
+        int fd_;
+        uint32_t events_;
+        std::chrono::milliseconds timeout_;
+        bool suspended_ = false;
+        bool registered_ = false;
+        TimerService::TimerId timer_ = 0;
+    };
+
+    /**
+     * @brief 暂停检查点的等待器
+     */
+    class CheckpointAwaiter {
+    public:
+        explicit CheckpointAwaiter(CoroutineWorker& worker) : worker_(worker) {}
+
+        bool await_ready() const {
+            return !worker_.isPauseRequested() || worker_.isStopRequested();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            suspended_ = true;
+            pauseStart_ = std::chrono::steady_clock::now();
+            worker_.setState(ThreadState::PAUSED);
+
+            std::shared_ptr<detail::WaitChannel> channel = worker_.channel_;
+            uint64_t generation = channel->arm(handle, true);
+            if (!worker_.isPauseRequested() || worker_.isStopRequested()) {
+                channel->complete(generation, WaitResult::READY);
+            }
+            return channel->finishSuspend();
+        }
+
+        bool await_resume() const {
+            if (suspended_) {
+                worker_.getMetrics().recordPause(std::chrono::steady_clock::now() - pauseStart_);
+                worker_.setState(ThreadState::RUNNING);
+            }
+            return !worker_.isStopRequested();
+        }
+
+    private:
+        CoroutineWorker& worker_;
+        bool suspended_ = false;
+        std::chrono::steady_clock::time_point pauseStart_;
+    };
+
+    /**
+     * @brief 让出池线程的等待器，协程重新排队到线程池
+     */
+    class YieldAwaiter {
+    public:
+        explicit YieldAwaiter(ThreadPool* pool) : pool_(pool) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            pool_->submit(new detail::ResumeTask(handle));
+        }
+
+        void await_resume() const noexcept {}
+
+    private:
+        ThreadPool* pool_;
+    };
+
+    /**
+     * @brief 挂起指定时长
+     *
+     * @return 可等待对象，结果为true表示睡满了时长，false表示被停止请求打断
+     */
+    template <typename Rep, typename Period>
+    SleepAwaiter sleepFor(const std::chrono::duration<Rep, Period>& duration) {
+        return SleepAwaiter(*this, TimerService::Clock::now() +
+                                       std::chrono::duration_cast<TimerService::Clock::duration>(duration));
+    }
+
+    /**
+     * @brief 挂起到指定时间点
+     *
+     * @return 可等待对象，结果同 sleepFor()
+     */
+    SleepAwaiter sleepUntil(TimerService::Clock::time_point deadline) {
+        return SleepAwaiter(*this, deadline);
+    }
+
+    /**
+     * @brief 等待描述符可读
+     *
+     * 描述符在等待期间注册在共享事件循环中，同一个描述符同时只能有一个等待。
+     *
+     * @param fd 文件描述符
+     * @param timeout 超时时长，0表示不超时
+     * @return 可等待对象，结果为 WaitResult
+     */
+    IoAwaiter waitReadable(int fd, std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) {
+        return IoAwaiter(*this, fd, EPOLLIN, timeout);
+    }
+
+    /**
+     * @brief 等待描述符可写，参数同 waitReadable()
+     */
+    IoAwaiter waitWritable(int fd, std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) {
+        return IoAwaiter(*this, fd, EPOLLOUT, timeout);
+    }
+
+    /**
+     * @brief 暂停检查点，对应 shouldContinue()
+     *
+     * 有暂停请求时挂起到恢复或停止，期间不占用线程。
+     *
+     * @return 可等待对象，结果为true表示继续，false表示已请求停止
+     */
+    CheckpointAwaiter checkpoint() {
+        return CheckpointAwaiter(*this);
+    }
+
+    /**
+     * @brief 让出当前池线程，重新排队后继续执行
+     *
+     * 长时间计算的协程应定期调用，避免阻塞同一线程上的其它工作者。
+     */
+    YieldAwaiter yield() {
+        return YieldAwaiter(context_.pool);
+    }
+
+    /**
+     * @brief 获取执行环境，未启动时各指针为空
+     */
+    const AsyncContext& getContext() const {
+        return context_;
+    }
+
+private:
+    std::shared_ptr<detail::WaitChannel> channel_;
+    AsyncContext context_;
+
+    /**
+     * @brief 运行协程主体，结束时通知线程管理器
+     *
+     * 调用 onFinished 之后工作者可能已被销毁，不能再访问 self。
+     */
+    static detail::DetachedCoroutine start(CoroutineWorker* self, std::function<void()> onFinished) {
+        try {
+            co_await self->runAsync();
+        } catch (const std::exception& e) {
+            self->reportError(e.what());
+        } catch (...) {
+            self->reportError("unknown exception");
+        }
+        self->setState(ThreadState::FINISHED);
+        onFinished();
+    }
+};
+
+} // namespace thread_framework
+
+#endif // COROUTINE_WORKER_H
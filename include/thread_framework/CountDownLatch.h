@@ -0,0 +1,106 @@
+#ifndef COUNT_DOWN_LATCH_H
+#define COUNT_DOWN_LATCH_H
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/**
+ * @file CountDownLatch.h
+ * @brief 倒计数门闩
+ *
+ * 线程管理器用它等待一组工作者全部完成：每个成员完成时计数减一，
+ * 只有最后一个成员会加锁并唤醒等待方，等待方只被唤醒一次。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief 倒计数门闩
+ *
+ * 计数归零之前的 countDown() 只是一次原子减法，不加锁也不通知。
+ */
+class CountDownLatch {
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param count 初始计数
+     */
+    explicit CountDownLatch(size_t count) : count_(count) {}
+
+    CountDownLatch(const CountDownLatch&) = delete;
+    CountDownLatch& operator=(const CountDownLatch&) = delete;
+
+    /**
+     * @brief 计数减少
+     *
+     * @param n 减少的数量，不能超过剩余计数
+     */
+    void countDown(size_t n = 1) {
+        if (n == 0) {
+            return;
+        }
+        if (count_.fetch_sub(n, std::memory_order_acq_rel) == n) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+            }
+            condition_.notify_all();
+        }
+    }
+
+    /**
+     * @brief 等待计数归零
+     */
+    void wait() {
+        if (isReleased()) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this]() { return isReleased(); });
+    }
+
+    /**
+     * @brief 等待计数归零，最多等待指定时长
+     *
+     * @param timeout 超时时长
+     * @return true 计数已归零
+     * @return false 超时
+     */
+    template <typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& timeout) {
+        if (isReleased()) {
+            return true;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        return condition_.wait_for(lock, timeout, [this]() { return isReleased(); });
+    }
+
+    /**
+     * @brief 获取剩余计数
+     */
+    size_t getCount() const {
+        return count_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief 计数是否已归零
+     */
+    bool isReleased() const {
+        return getCount() == 0;
+    }
+
+private:
+    std::atomic<size_t> count_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+};
+
+} // namespace thread_framework
+
+#endif // COUNT_DOWN_LATCH_H
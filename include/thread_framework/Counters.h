@@ -0,0 +1,121 @@
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file Counters.h
+ * @brief 避免伪共享和读改写指令的统计计数器
+ *
+ * 只有一个线程修改的计数器用 OwnedCounter，递增是 relaxed 的读和写；
+ * 多个线程同时递增的计数器用 ShardedCounter，每个线程写自己的缓存行，读取时求和。
+ * 两者都只保证读到的值最终一致，不能用来做同步。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief 单写者计数器
+ *
+ * 只能由一个线程（或由锁、启动顺序等保证先后的多个线程）修改，其它线程可以随时读取。
+ * 递增不使用带锁前缀的读改写指令，也不会让读取方看到撕裂的值。
+ *
+ * @tparam T 整数类型
+ */
+template <typename T>
+class OwnedCounter {
+public:
+    OwnedCounter() = default;
+    explicit OwnedCounter(T initial) : value_(initial) {}
+
+    OwnedCounter(const OwnedCounter&) = delete;
+    OwnedCounter& operator=(const OwnedCounter&) = delete;
+
+    /**
+     * @brief 增加计数，只能由写者调用
+     *
+     * @return T 增加后的值
+     */
+    T add(T count = 1) {
+        T next = value_.load(std::memory_order_relaxed) + count;
+        value_.store(next, std::memory_order_relaxed);
+        return next;
+    }
+
+    void store(T value) {
+        value_.store(value, std::memory_order_relaxed);
+    }
+
+    T load() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<T> value_{0};
+};
+
+/**
+ * @brief 分片计数器
+ *
+ * 线程第一次使用时按顺序分到一个分片，之后总是递增自己的分片；分片各占一个缓存行，
+ * 不同线程的递增不会争用同一缓存行。读取时对所有分片求和，代价与分片数成正比。
+ */
+class ShardedCounter {
+public:
+    static constexpr size_t SHARDS = 8; ///< 分片数，超过分片数的线程共享分片
+
+    ShardedCounter() = default;
+
+    ShardedCounter(const ShardedCounter&) = delete;
+    ShardedCounter& operator=(const ShardedCounter&) = delete;
+
+    /**
+     * @brief 增加计数，可以被任意线程调用
+     */
+    void add(uint64_t count = 1) {
+        shards_[shardIndex()].value.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 读取所有分片之和
+     */
+    uint64_t load() const {
+        uint64_t sum = 0;
+        for (const Shard& shard : shards_) {
+            sum += shard.value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    /**
+     * @brief 清零，不能与 add() 并发调用
+     */
+    void reset() {
+        for (Shard& shard : shards_) {
+            shard.value.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+
+    Shard shards_[SHARDS];
+
+    static size_t shardIndex() {
+        static std::atomic<size_t> nextShard{0};
+        static thread_local size_t index = nextShard.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+        return index;
+    }
+};
+
+} // namespace thread_framework
+
+#endif // COUNTERS_H
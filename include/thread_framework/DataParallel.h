@@ -0,0 +1,330 @@
+#ifndef DATA_PARALLEL_H
+#define DATA_PARALLEL_H
+
+#include "ThreadManager.h"
+#include <unistd.h>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @file DataParallel.h
+ * @brief 零拷贝的数据视图和数据并行工作者
+ *
+ * DataView 是只读的连续数据视图（C++17 下 std::span 的替代），可以借用调用方的数据、
+ * 通过移动接管 std::vector，或者共享不可变的缓冲区，复制视图不会复制数据。
+ * DataParallelWorker 把视图切成适合缓存的块，在线程池上并行处理，
+ * 每个块的结果写入各自的槽位，全部完成后再依次合并，热路径上没有原子操作。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief 只读的连续数据视图
+ *
+ * 借用的视图不管理数据的生命周期，调用方必须保证数据比视图和使用它的工作者活得更久；
+ * 接管或共享的视图持有缓冲区的引用，最后一个视图销毁时释放数据。
+ *
+ * @tparam T 元素类型
+ */
+template <typename T>
+class DataView {
+public:
+    /**
+     * @brief 空视图
+     */
+    DataView() = default;
+
+    /**
+     * @brief 借用一段连续内存
+     *
+     * @param data 起始地址
+     * @param size 元素个数
+     */
+    static DataView borrow(const T* data, size_t size) {
+        return DataView(data, size, nullptr);
+    }
+
+    /**
+     * @brief 借用连续容器（std::vector、std::array、std::span 等）
+     *
+     * @param container 容器，必须比视图活得更久
+     */
+    template <typename Container>
+    static DataView borrow(const Container& container) {
+        return DataView(container.data(), container.size(), nullptr);
+    }
+
+    /**
+     * @brief 通过移动接管数据，不复制元素
+     *
+     * @param data 数据，调用后为空
+     */
+    static DataView adopt(std::vector<T>&& data) {
+        return share(std::make_shared<const std::vector<T>>(std::move(data)));
+    }
+
+    /**
+     * @brief 共享不可变的缓冲区
+     *
+     * @param buffer 缓冲区，视图持有一个引用
+     */
+    static DataView share(std::shared_ptr<const std::vector<T>> buffer) {
+        if (!buffer) {
+            return DataView();
+        }
+        const T* data = buffer->data();
+        size_t size = buffer->size();
+        return DataView(data, size, std::move(buffer));
+    }
+
+    /**
+     * @brief 获取起始地址
+     */
+    const T* data() const {
+        return data_;
+    }
+
+    /**
+     * @brief 获取元素个数
+     */
+    size_t size() const {
+        return size_;
+    }
+
+    /**
+     * @brief 是否为空
+     */
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    const T* begin() const {
+        return data_;
+    }
+
+    const T* end() const {
+        return data_ + size_;
+    }
+
+    const T& operator[](size_t index) const {
+        return data_[index];
+    }
+
+    /**
+     * @brief 是否持有数据的所有权
+     */
+    bool ownsData() const {
+        return owner_ != nullptr;
+    }
+
+    /**
+     * @brief 获取子视图，与本视图共享所有权
+     *
+     * @param offset 起始下标，超出范围时返回空视图
+     * @param count 元素个数，超出末尾时截断
+     */
+    DataView subview(size_t offset, size_t count) const {
+        DataView result = slice(offset, count);
+        result.owner_ = owner_;
+        return result;
+    }
+
+    /**
+     * @brief 获取不持有所有权的子视图
+     *
+     * 不复制引用计数，用于在本视图有效期间临时访问一部分数据。
+     *
+     * @param offset 起始下标，超出范围时返回空视图
+     * @param count 元素个数，超出末尾时截断
+     */
+    DataView slice(size_t offset, size_t count) const {
+        if (offset >= size_) {
+            return DataView();
+        }
+        return DataView(data_ + offset, std::min(count, size_ - offset), nullptr);
+    }
+
+private:
+    DataView(const T* data, size_t size, std::shared_ptr<const void> owner)
+        : data_(data), size_(size), owner_(std::move(owner)) {}
+
+    const T* data_ = nullptr;
+    size_t size_ = 0;
+    std::shared_ptr<const void> owner_; ///< 接管或共享时持有缓冲区
+};
+
+/**
+ * @brief 根据二级缓存大小选择每个块的字节数
+ *
+ * 无法获取缓存大小时使用 256KB。
+ */
+inline size_t defaultChunkBytes() {
+    static const size_t bytes = []() {
+        long size = -1;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+        size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+        // 留一半给输出和其它热数据
+        return size > 0 ? static_cast<size_t>(size) / 2 : size_t(256 * 1024);
+    }();
+    return bytes;
+}
+
+/**
+ * @brief 数据并行工作者 - 分块并行处理一批数据
+ *
+ * 数据通过 DataView 传入，不复制。run() 把数据切成 chunkSize 个元素的块，
+ * 在 manager 的线程池上并行调用 map(chunk)，再按块的顺序用 combine 合并，
+ * 因此 combine 只需要满足结合律。结果通过 getFuture() 返回的 Future 取回，
+ * 管理器回收工作者之后 Future 仍然有效。
+ *
+ * 任一块抛出的异常通过 reportError() 报告，并传递到 Future。停止请求在块之间检查，
+ * 已开始的块会处理完，Future 收到 std::runtime_error。
+ *
+ * 工作者可以运行在独占线程或线程池中，等待各块期间会帮助执行池中的任务。
+ *
+ * @tparam T 元素类型
+ * @tparam R 结果类型
+ */
+template <typename T, typename R>
+class DataParallelWorker : public IThreadWorker {
+public:
+    using MapFunction = std::function<R(const DataView<T>& chunk)>;
+    using CombineFunction = std::function<R(R, R)>;
+
+    /**
+     * @brief 构造函数
+     *
+     * @param manager 提供线程池的线程管理器，必须比工作者的运行活得更久
+     * @param data 要处理的数据
+     * @param identity 合并的初始值
+     * @param map 块处理函数，参数为不持有所有权的块视图
+     * @param combine 合并函数
+     * @param chunkSize 每块的元素个数，0表示按二级缓存大小自动选择
+     */
+    DataParallelWorker(ThreadManager& manager, DataView<T> data, R identity, MapFunction map,
+                       CombineFunction combine, size_t chunkSize = 0)
+        : manager_(manager), data_(std::move(data)), identity_(std::move(identity)), map_(std::move(map)),
+          combine_(std::move(combine)),
+          chunkSize_(chunkSize != 0 ? chunkSize : std::max<size_t>(1, defaultChunkBytes() / sizeof(T))),
+          promise_(manager.makePromise<R>()) {}
+
+    /**
+     * @brief 执行数据处理
+     */
+    void run() override {
+        setState(ThreadState::RUNNING);
+
+        size_t chunks = getChunkCount();
+        // 每块的结果独占一个缓存行：不同池线程写相邻的块不会伪共享，R = bool 时也不会像 vector<bool> 那样按位打包
+        std::vector<PartialSlot> partials(chunks, PartialSlot{identity_});
+        try {
+            manager_.parallelFor(0, chunks, 1, [this, &partials](size_t chunk) {
+                if (!isStopRequested()) {
+                    partials[chunk].value = map_(data_.slice(chunk * chunkSize_, chunkSize_));
+                }
+            }, &progress_);
+
+            // 停止请求可能让部分块被跳过，此时不产生结果
+            if (isStopRequested()) {
+                throw std::runtime_error("DataParallelWorker stopped");
+            }
+            R result = identity_;
+            for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                result = combine_(std::move(result), std::move(partials[chunk].value));
+            }
+            promise_.setValue(std::move(result));
+        } catch (const std::exception& e) {
+            reportError(std::string("数据并行处理失败: ") + e.what());
+            promise_.setException(std::current_exception());
+        } catch (...) {
+            reportError("数据并行处理失败: unknown exception");
+            promise_.setException(std::current_exception());
+        }
+
+        setState(ThreadState::FINISHED);
+    }
+
+    /**
+     * @brief 获取工作者类型
+     */
+    std::string getType() const override {
+        return "DataParallelWorker";
+    }
+
+    /**
+     * @brief 分块在线程池中执行，工作者本身也可以池化
+     */
+    bool isPoolable() const override {
+        return true;
+    }
+
+    /**
+     * @brief 获取结果的 Future
+     *
+     * 应在把工作者交给管理器之前调用，只能调用一次。工作者没有运行就被销毁时，
+     * Future 收到 std::runtime_error("broken promise")。
+     */
+    Future<R> getFuture() {
+        return promise_.getFuture();
+    }
+
+    /**
+     * @brief 获取数据视图
+     */
+    const DataView<T>& getData() const {
+        return data_;
+    }
+
+    /**
+     * @brief 获取每块的元素个数
+     */
+    size_t getChunkSize() const {
+        return chunkSize_;
+    }
+
+    /**
+     * @brief 获取块数
+     */
+    size_t getChunkCount() const {
+        return (data_.size() + chunkSize_ - 1) / chunkSize_;
+    }
+
+    /**
+     * @brief 获取进度，以块为单位
+     */
+    const ParallelProgress& getProgress() const {
+        return progress_;
+    }
+
+private:
+    /**
+     * @brief 单块的结果，按缓存行对齐
+     */
+    struct alignas(64) PartialSlot {
+        R value;
+    };
+
+    ThreadManager& manager_;
+    DataView<T> data_;
+    R identity_;
+    MapFunction map_;
+    CombineFunction combine_;
+    size_t chunkSize_;
+    ParallelProgress progress_;
+    Promise<R> promise_;
+};
+
+} // namespace thread_framework
+
+#endif // DATA_PARALLEL_H
@@ -0,0 +1,534 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <system_error>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <chrono>
+
+/**
+ * @file EventLoop.h
+ * @brief 基于 epoll 的事件循环
+ *
+ * 文件描述符就绪时在事件循环线程上调用注册的回调，其它线程可以随时注册、注销描述符，
+ * 或者投递要在事件循环线程上执行的函数。除了外部描述符，还可以注册由循环自己创建和关闭的
+ * 定时器（timerfd）、通知（eventfd）和文件监视（inotify）。
+ * 协程工作者的I/O等待由线程管理器中的共享事件循环驱动，EventLoopWorker 在自己的线程上运行一个循环。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief epoll 事件循环
+ *
+ * 一个线程调用 run() 驱动循环，其它方法都是线程安全的。
+ * 回调在事件循环线程上执行，应尽量简短，不能阻塞。
+ */
+class EventLoop {
+public:
+    using Callback = std::function<void(uint32_t events)>;
+    using FileWatchCallback = std::function<void(uint32_t mask, const std::string& name)>;
+    using SourceId = uint64_t;   ///< 循环自己创建的事件源的ID，0表示无效
+
+    /**
+     * @brief 构造函数
+     *
+     * @throws std::system_error 创建 epoll 或 eventfd 失败
+     */
+    EventLoop() {
+        epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "epoll_create1 failed");
+        }
+        wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeFd_ < 0) {
+            int error = errno;
+            ::close(epollFd_);
+            throw std::system_error(error, std::generic_category(), "eventfd failed");
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = kWakeToken;
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &event);
+    }
+
+    ~EventLoop() {
+        for (auto& entry : handlers_) {
+            if (entry.second->owned) {
+                ::close(entry.first);
+            }
+        }
+        ::close(wakeFd_);
+        ::close(epollFd_);
+    }
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * @brief 注册文件描述符
+     *
+     * @param fd 文件描述符，同一个描述符只能注册一次
+     * @param events epoll 事件掩码，例如 EPOLLIN、EPOLLOUT
+     * @param callback 就绪回调，参数为实际发生的事件
+     * @param oneShot 为true时只触发一次，之后需要 remove() 后重新注册
+     * @return true 注册成功
+     * @return false 描述符已注册或 epoll_ctl 失败
+     */
+    bool add(int fd, uint32_t events, Callback callback, bool oneShot = false) {
+        return addSource(fd, events, std::move(callback), oneShot, false) != 0;
+    }
+
+    /**
+     * @brief 修改已注册描述符的事件掩码，也用于重新启用单次触发的描述符
+     *
+     * @return true 修改成功
+     * @return false 描述符未注册或 epoll_ctl 失败
+     */
+    bool modify(int fd, uint32_t events, bool oneShot = false) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = handlers_.find(fd);
+        if (it == handlers_.end()) {
+            return false;
+        }
+
+        epoll_event event{};
+        event.events = events | (oneShot ? EPOLLONESHOT : 0u);
+        event.data.u64 = it->second->token;
+        return epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &event) == 0;
+    }
+
+    /**
+     * @brief 注销文件描述符
+     *
+     * 返回后回调不会再被调用；回调正在其它线程上执行时等待它结束，在回调内部调用不会等待。
+     * 描述符应在注销之后再关闭。
+     *
+     * @return true 注销成功
+     * @return false 描述符未注册
+     */
+    bool remove(int fd) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = handlers_.find(fd);
+        if (it == handlers_.end() || it->second->owned) {
+            return false;
+        }
+        removeLocked(lock, it);
+        return true;
+    }
+
+    /**
+     * @brief 注册定时器
+     *
+     * 由 timerfd 实现，到期时在事件循环线程上调用回调；循环忙时错过的多次到期合并为一次回调。
+     * 单次定时器触发后自动释放。
+     *
+     * @param delay 第一次触发前的延迟
+     * @param interval 之后的触发间隔，0表示只触发一次
+     * @param callback 回调函数
+     * @return SourceId 定时器ID，失败时为0
+     */
+    SourceId addTimer(std::chrono::nanoseconds delay, std::chrono::nanoseconds interval,
+                      std::function<void()> callback) {
+        int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (fd < 0) {
+            return 0;
+        }
+
+        bool once = interval.count() <= 0;
+        auto self = std::make_shared<std::atomic<SourceId>>(0); // 注册完成后才启动定时器，回调读取时已写入
+        SourceId id = addSource(fd, EPOLLIN, [this, fd, once, self, callback = std::move(callback)](uint32_t) {
+            uint64_t expirations;
+            if (read(fd, &expirations, sizeof(expirations)) != static_cast<ssize_t>(sizeof(expirations))) {
+                return; // 重新设置后的虚假唤醒
+            }
+            if (once) {
+                release(self->load(std::memory_order_relaxed));
+            }
+            if (callback) {
+                callback();
+            }
+        }, false, true);
+        if (id == 0) {
+            ::close(fd);
+            return 0;
+        }
+        self->store(id, std::memory_order_relaxed);
+
+        itimerspec spec{};
+        spec.it_value = toTimespec(delay.count() > 0 ? delay : std::chrono::nanoseconds(1));
+        spec.it_interval = toTimespec(once ? std::chrono::nanoseconds(0) : interval);
+        if (timerfd_settime(fd, 0, &spec, nullptr) != 0) {
+            release(id);
+            return 0;
+        }
+        return id;
+    }
+
+    /**
+     * @brief 注册通知
+     *
+     * 由 eventfd 实现。任意线程调用 notify() 后，事件循环线程调用一次回调，
+     * 回调执行前的多次通知合并为一次。
+     *
+     * @param callback 回调函数
+     * @return SourceId 通知ID，失败时为0
+     */
+    SourceId addNotifier(std::function<void()> callback) {
+        int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fd < 0) {
+            return 0;
+        }
+
+        SourceId id = addSource(fd, EPOLLIN, [fd, callback = std::move(callback)](uint32_t) {
+            uint64_t count;
+            if (read(fd, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))) {
+                return;
+            }
+            if (callback) {
+                callback();
+            }
+        }, false, true);
+        if (id == 0) {
+            ::close(fd);
+        }
+        return id;
+    }
+
+    /**
+     * @brief 触发通知
+     *
+     * @param id addNotifier() 返回的ID
+     * @return true 已触发
+     * @return false 通知不存在或已释放
+     */
+    bool notify(SourceId id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = tokens_.find(id);
+        if (it == tokens_.end() || !it->second->owned) {
+            return false;
+        }
+        uint64_t one = 1;
+        return write(it->second->fd, &one, sizeof(one)) == static_cast<ssize_t>(sizeof(one));
+    }
+
+    /**
+     * @brief 注册文件或目录监视
+     *
+     * 由 inotify 实现，每个 inotify 事件调用一次回调。监视文件时 name 为空，
+     * 监视目录时 name 为目录中发生变化的文件名。
+     *
+     * @param path 文件或目录路径
+     * @param mask inotify 事件掩码，例如 IN_MODIFY | IN_CLOSE_WRITE
+     * @param callback 回调函数，参数为事件掩码和文件名
+     * @return SourceId 监视ID，路径不存在或失败时为0
+     */
+    SourceId addFileWatch(const std::string& path, uint32_t mask, FileWatchCallback callback) {
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) {
+            return 0;
+        }
+        if (inotify_add_watch(fd, path.c_str(), mask) < 0) {
+            ::close(fd);
+            return 0;
+        }
+
+        SourceId id = addSource(fd, EPOLLIN, [fd, callback = std::move(callback)](uint32_t) {
+            alignas(inotify_event) char buffer[4096];
+            ssize_t length;
+            while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+                for (ssize_t offset = 0; offset < length;) {
+                    const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                    std::string name = event->len > 0 ? std::string(event->name) : std::string();
+                    if (callback) {
+                        callback(event->mask, name);
+                    }
+                    offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                }
+            }
+        }, false, true);
+        if (id == 0) {
+            ::close(fd);
+        }
+        return id;
+    }
+
+    /**
+     * @brief 释放由 addTimer()、addNotifier() 或 addFileWatch() 创建的事件源
+     *
+     * 注销并关闭其描述符，等待语义同 remove()。
+     *
+     * @param id 事件源ID
+     * @return true 释放成功
+     * @return false 事件源不存在或已释放
+     */
+    bool release(SourceId id) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto token = tokens_.find(id);
+        if (token == tokens_.end() || !token->second->owned) {
+            return false;
+        }
+        removeLocked(lock, handlers_.find(token->second->fd));
+        return true;
+    }
+
+    /**
+     * @brief 投递一个在事件循环线程上执行的函数
+     */
+    void post(std::function<void()> function) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            posted_.push_back(std::move(function));
+        }
+        wakeup();
+    }
+
+    /**
+     * @brief 唤醒阻塞在 epoll_wait 中的事件循环
+     */
+    void wakeup() {
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd_, &one, sizeof(one));
+        (void)written; // 计数器溢出时写失败，但循环已经处于可读状态
+    }
+
+    /**
+     * @brief 在当前线程上运行事件循环，直到 stop()
+     *
+     * stop() 之后循环不能再次运行。
+     */
+    void run() {
+        while (!stopped_.load()) {
+            runOnce(-1);
+        }
+    }
+
+    /**
+     * @brief 等待并分派一轮事件
+     *
+     * @param timeoutMs 最长等待时间（毫秒），-1表示一直等待
+     * @return size_t 分派的事件数量，不包括唤醒和投递的函数
+     */
+    size_t runOnce(int timeoutMs) {
+        loopThread_.store(std::this_thread::get_id());
+
+        epoll_event events[kMaxEvents];
+        int count = epoll_wait(epollFd_, events, kMaxEvents, timeoutMs);
+        size_t dispatched = 0;
+        for (int i = 0; i < count; ++i) {
+            if (events[i].data.u64 == kWakeToken) {
+                uint64_t value;
+                ssize_t drained = read(wakeFd_, &value, sizeof(value));
+                (void)drained;
+                continue;
+            }
+            if (dispatch(events[i].data.u64, events[i].events)) {
+                dispatched++;
+            }
+        }
+
+        runPosted();
+        return dispatched;
+    }
+
+    /**
+     * @brief 让 run() 返回
+     */
+    void stop() {
+        stopped_.store(true);
+        wakeup();
+    }
+
+    /**
+     * @brief 检查是否在事件循环线程上
+     */
+    bool isInLoopThread() const {
+        return std::this_thread::get_id() == loopThread_.load();
+    }
+
+    /**
+     * @brief 获取已注册的描述符数量
+     */
+    size_t getHandlerCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return handlers_.size();
+    }
+
+private:
+    static constexpr uint64_t kWakeToken = 0;
+    static constexpr int kMaxEvents = 256;
+
+    /**
+     * @brief 注册项，用递增的令牌区分，描述符被复用时旧事件不会调用新回调
+     */
+    struct Handler {
+        uint64_t token = 0;
+        int fd = -1;
+        bool owned = false;     ///< 描述符由循环创建，注销时关闭
+        bool closePending = false; ///< 在自己的回调中被释放，回调返回后关闭，由 mutex_ 保护
+        Callback callback;
+    };
+
+    int epollFd_ = -1;
+    int wakeFd_ = -1;
+    mutable std::mutex mutex_;
+    std::condition_variable dispatched_;                 ///< 回调执行完毕的通知，供 remove() 等待
+    std::unordered_map<int, std::shared_ptr<Handler>> handlers_;
+    std::unordered_map<uint64_t, std::shared_ptr<Handler>> tokens_;
+    std::vector<std::function<void()>> posted_;
+    uint64_t nextToken_ = 1;
+    uint64_t runningToken_ = 0;                          ///< 正在执行的回调，由 mutex_ 保护
+    std::atomic<std::thread::id> loopThread_{};
+    std::atomic<bool> stopped_{false};
+
+    SourceId addSource(int fd, uint32_t events, Callback callback, bool oneShot, bool owned) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (handlers_.count(fd) != 0) {
+            return 0;
+        }
+
+        auto handler = std::make_shared<Handler>();
+        handler->token = nextToken_++;
+        handler->fd = fd;
+        handler->owned = owned;
+        handler->callback = std::move(callback);
+
+        epoll_event event{};
+        event.events = events | (oneShot ? EPOLLONESHOT : 0u);
+        event.data.u64 = handler->token;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            return 0;
+        }
+
+        SourceId token = handler->token;
+        tokens_.emplace(token, handler);
+        handlers_.emplace(fd, std::move(handler));
+        return token;
+    }
+
+    /**
+     * @brief 注销注册项，必要时关闭描述符并等待正在执行的回调
+     */
+    void removeLocked(std::unique_lock<std::mutex>& lock,
+                      std::unordered_map<int, std::shared_ptr<Handler>>::iterator it) {
+        std::shared_ptr<Handler> handler = std::move(it->second);
+        epoll_ctl(epollFd_, EPOLL_CTL_DEL, handler->fd, nullptr);
+        tokens_.erase(handler->token);
+        handlers_.erase(it);
+
+        uint64_t token = handler->token;
+        if (std::this_thread::get_id() != loopThread_.load()) {
+            dispatched_.wait(lock, [this, token]() { return runningToken_ != token; });
+        } else if (runningToken_ == token) {
+            handler->closePending = handler->owned; // 在自己的回调中释放，回调返回后再关闭
+            return;
+        }
+
+        // 回调结束后才关闭，描述符号不会在回调仍在读取时被复用
+        if (handler->owned) {
+            ::close(handler->fd);
+        }
+    }
+
+    static timespec toTimespec(std::chrono::nanoseconds duration) {
+        timespec value{};
+        value.tv_sec = static_cast<time_t>(duration.count() / 1000000000);
+        value.tv_nsec = static_cast<long>(duration.count() % 1000000000);
+        return value;
+    }
+
+    bool dispatch(uint64_t token, uint32_t events) {
+        std::shared_ptr<Handler> handler;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = tokens_.find(token);
+            if (it == tokens_.end()) {
+                return false; // 已注销
+            }
+            handler = it->second;
+            runningToken_ = token;
+        }
+
+        try {
+            handler->callback(events);
+        } catch (...) {
+            // 回调自身负责报告错误，这里只保护事件循环
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            runningToken_ = 0;
+            if (handler->closePending) {
+                ::close(handler->fd);
+            }
+        }
+        dispatched_.notify_all();
+        return true;
+    }
+
+    void runPosted() {
+        std::vector<std::function<void()>> posted;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (posted_.empty()) {
+                return;
+            }
+            posted.swap(posted_);
+        }
+        for (auto& function : posted) {
+            try {
+                function();
+            } catch (...) {
+            }
+        }
+    }
+};
+
+/**
+ * @brief 在自己的线程上运行的事件循环
+ *
+ * 析构时停止循环并等待线程退出。
+ */
+class EventLoopThread {
+public:
+    EventLoopThread() : thread_([this]() { loop_.run(); }) {}
+
+    ~EventLoopThread() {
+        loop_.stop();
+        thread_.join();
+    }
+
+    EventLoopThread(const EventLoopThread&) = delete;
+    EventLoopThread& operator=(const EventLoopThread&) = delete;
+
+    EventLoop& getLoop() {
+        return loop_;
+    }
+
+private:
+    EventLoop loop_;
+    std::thread thread_;
+};
+
+} // namespace thread_framework
+
+#endif // EVENT_LOOP_H
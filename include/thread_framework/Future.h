@@ -0,0 +1,592 @@
+#ifndef FUTURE_H
+#define FUTURE_H
+
+#include "ThreadPool.h"
+#include "CancellationToken.h"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <chrono>
+#include <type_traits>
+
+/**
+ * @file Future.h
+ * @brief 任务结果的 Future 和延续
+ *
+ * ThreadManager::submit() 返回 Future，用来取回任务的返回值或异常。
+ * 任务的可调用对象、参数和结果存放在同一个共享状态对象中，这个对象本身就是
+ * 线程池任务，每次提交只进行一次堆分配，不经过 std::function。
+ * 不是由 submit() 产生的结果（例如工作者的处理结果）通过 Promise 写入。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+template <typename R>
+class Future;
+
+template <typename R>
+class Promise;
+
+namespace detail {
+
+template <typename R>
+class FutureAwaiter;
+
+/**
+ * @brief void 结果的占位类型
+ */
+struct VoidResult {};
+
+template <typename R>
+struct StoredResult {
+    using type = R;
+};
+
+template <>
+struct StoredResult<void> {
+    using type = VoidResult;
+};
+
+/**
+ * @brief Future 的共享状态
+ *
+ * 保存结果或异常，以及最多一个延续任务。通过引用计数管理生命周期：
+ * Future 持有一个引用，尚未执行的任务持有一个引用。
+ *
+ * @tparam R 结果类型
+ */
+template <typename R>
+class FutureState {
+public:
+    explicit FutureState(ThreadPool* executor) : executor_(executor) {}
+    virtual ~FutureState() = default;
+
+    FutureState(const FutureState&) = delete;
+    FutureState& operator=(const FutureState&) = delete;
+
+    void addRef() {
+        refs_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void releaseRef() {
+        if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    /**
+     * @brief 设置结果
+     */
+    template <typename... V>
+    void setValue(V&&... value) {
+        value_.emplace(std::forward<V>(value)...);
+        complete();
+    }
+
+    /**
+     * @brief 设置异常
+     */
+    void setException(std::exception_ptr error) {
+        error_ = std::move(error);
+        complete();
+    }
+
+    bool isReady() const {
+        return ready_.load(std::memory_order_acquire);
+    }
+
+    void wait() {
+        if (isReady()) {
+            return;
+        }
+        ThreadPool::BlockingRegion region; // 在池线程中等待时允许弹性线程池补充线程
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this]() { return isReady(); });
+    }
+
+    template <typename Clock, typename Duration>
+    bool waitUntil(const std::chrono::time_point<Clock, Duration>& deadline) {
+        if (isReady()) {
+            return true;
+        }
+        ThreadPool::BlockingRegion region;
+        std::unique_lock<std::mutex> lock(mutex_);
+        return condition_.wait_until(lock, deadline, [this]() { return isReady(); });
+    }
+
+    /**
+     * @brief 等待就绪，令牌被取消或到达截止时间时提前返回
+     *
+     * @return true 已就绪
+     */
+    bool wait(const CancellationToken& token) {
+        if (isReady()) {
+            return true;
+        }
+        ThreadPool::BlockingRegion region;
+        // 在加锁之前注册：令牌已取消时回调立即执行，同样需要获取 mutex_
+        CancellationRegistration wake = token.onCancel([this]() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            condition_.notify_all();
+        });
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto done = [this, &token]() { return isReady() || token.isCancelled(); };
+        if (token.hasDeadline()) {
+            condition_.wait_until(lock, token.getDeadline(), done);
+        } else {
+            condition_.wait(lock, done);
+        }
+        return isReady();
+    }
+
+    /**
+     * @brief 取出结果，有异常时重新抛出
+     *
+     * 只能在就绪之后调用一次。
+     */
+    R take() {
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+        if constexpr (!std::is_void<R>::value) {
+            return std::move(*value_);
+        }
+    }
+
+    const std::exception_ptr& error() const { return error_; }
+
+    typename StoredResult<R>::type& value() { return *value_; }
+
+    ThreadPool* executor() const { return executor_; }
+
+    /**
+     * @brief 注册延续任务
+     *
+     * 已经就绪时立即提交，否则在完成时提交。
+     */
+    void setContinuation(PoolTask* continuation) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!isReady()) {
+                continuation_ = continuation;
+                return;
+            }
+        }
+        executor_->submit(continuation);
+    }
+
+private:
+    ThreadPool* executor_;
+    std::atomic<uint32_t> refs_{1};
+    std::atomic<bool> ready_{false};
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    PoolTask* continuation_ = nullptr;
+    std::optional<typename StoredResult<R>::type> value_;
+    std::exception_ptr error_;
+
+    void complete() {
+        PoolTask* continuation;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready_.store(true, std::memory_order_release);
+            continuation = continuation_;
+            continuation_ = nullptr;
+        }
+        condition_.notify_all();
+
+        if (continuation) {
+            executor_->submit(continuation);
+        }
+    }
+};
+
+/**
+ * @brief 调用可调用对象并把结果或异常写入共享状态
+ */
+template <typename R, typename Invoke>
+void fulfill(FutureState<R>& state, Invoke&& invoke) {
+    try {
+        if constexpr (std::is_void<R>::value) {
+            invoke();
+            state.setValue();
+        } else {
+            state.setValue(invoke());
+        }
+    } catch (...) {
+        state.setException(std::current_exception());
+    }
+}
+
+/**
+ * @brief 提交到线程池的任务，同时也是它自己的共享状态
+ */
+template <typename R, typename F, typename... Args>
+class TaskState : public FutureState<R>, public PoolTask {
+public:
+    TaskState(ThreadPool* executor, F function, Args... args)
+        : FutureState<R>(executor), function_(std::move(function)), args_(std::move(args)...) {
+        this->addRef(); // 任务执行完毕前持有的引用
+    }
+
+    void execute() override {
+        // 排队期间已被取消的任务不再执行
+        if (cancellation_.isCancelled()) {
+            this->setException(std::make_exception_ptr(OperationCancelled(cancellation_.getReason())));
+            return;
+        }
+        CancellationScope scope(cancellation_);
+        fulfill(*this, [this]() -> R {
+            return std::apply(function_, std::move(args_));
+        });
+    }
+
+    void release() override {
+        this->releaseRef();
+    }
+
+    /**
+     * @brief 丢弃时 Future 收到 OperationCancelled，不调用函数
+     */
+    bool discard() override {
+        this->setException(std::make_exception_ptr(OperationCancelled(CancellationReason::CANCELLED)));
+        return true;
+    }
+
+    /**
+     * @brief 设置取消令牌，必须在提交之前调用
+     */
+    void setCancellation(const CancellationToken& token) {
+        cancellation_ = token;
+    }
+
+private:
+    F function_;
+    std::tuple<Args...> args_;
+    CancellationToken cancellation_;
+};
+
+/**
+ * @brief 延续任务，在前一个 Future 就绪后执行
+ *
+ * 前一个结果有异常时不调用延续函数，异常直接传递到新的 Future。
+ */
+template <typename R, typename F, typename Prev>
+class ContinuationState : public FutureState<R>, public PoolTask {
+public:
+    ContinuationState(FutureState<Prev>* previous, F function)
+        : FutureState<R>(previous->executor()), function_(std::move(function)), previous_(previous) {
+        this->addRef(); // 任务执行完毕前持有的引用
+    }
+
+    ~ContinuationState() override {
+        previous_->releaseRef();
+    }
+
+    void execute() override {
+        if (previous_->error()) {
+            this->setException(previous_->error());
+            return;
+        }
+
+        fulfill(*this, [this]() -> R {
+            if constexpr (std::is_void<Prev>::value) {
+                return function_();
+            } else {
+                return function_(std::move(previous_->value()));
+            }
+        });
+    }
+
+    void release() override {
+        this->releaseRef();
+    }
+
+    bool discard() override {
+        this->setException(std::make_exception_ptr(OperationCancelled(CancellationReason::CANCELLED)));
+        return true;
+    }
+
+private:
+    F function_;
+    FutureState<Prev>* previous_;
+};
+
+template <typename F, typename Prev>
+struct ContinuationResult {
+    using type = typename std::invoke_result<F, Prev>::type;
+};
+
+template <typename F>
+struct ContinuationResult<F, void> {
+    using type = typename std::invoke_result<F>::type;
+};
+
+} // namespace detail
+
+/**
+ * @brief 任务结果
+ *
+ * 只能移动，不能复制。get() 等待任务完成并返回结果，任务抛出的异常在 get() 中重新抛出。
+ * then() 注册一个在任务完成后于同一线程池中执行的延续，不需要占用线程等待。
+ *
+ * 注意：在池线程中调用 get()/wait() 会阻塞该池线程；弹性线程池会为此补充线程。
+ *
+ * @tparam R 结果类型
+ */
+template <typename R>
+class Future {
+public:
+    Future() = default;
+
+    Future(Future&& other) noexcept : state_(other.state_) {
+        other.state_ = nullptr;
+    }
+
+    Future& operator=(Future&& other) noexcept {
+        if (this != &other) {
+            reset();
+            state_ = other.state_;
+            other.state_ = nullptr;
+        }
+        return *this;
+    }
+
+    Future(const Future&) = delete;
+    Future& operator=(const Future&) = delete;
+
+    ~Future() {
+        reset();
+    }
+
+    /**
+     * @brief 是否关联了共享状态
+     */
+    bool valid() const {
+        return state_ != nullptr;
+    }
+
+    /**
+     * @brief 结果是否已经就绪
+     */
+    bool isReady() const {
+        return state_ && state_->isReady();
+    }
+
+    /**
+     * @brief 等待结果就绪
+     */
+    void wait() const {
+        state_->wait();
+    }
+
+    /**
+     * @brief 等待结果就绪，最多等待指定时长
+     *
+     * @param timeout 超时时长
+     * @return true 已就绪
+     * @return false 超时
+     */
+    template <typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& timeout) const {
+        return state_->waitUntil(std::chrono::steady_clock::now() + timeout);
+    }
+
+    /**
+     * @brief 等待结果就绪，令牌被取消时提前返回
+     *
+     * 只放弃等待，不取消产生结果的任务。
+     *
+     * @param token 取消令牌
+     * @return true 已就绪
+     * @return false 令牌被取消或到达截止时间
+     */
+    bool wait(const CancellationToken& token) const {
+        return state_->wait(token);
+    }
+
+    /**
+     * @brief 等待并取出结果
+     *
+     * 调用后 Future 失效。任务抛出的异常在这里重新抛出。
+     *
+     * @return R 任务的返回值
+     */
+    R get() {
+        state_->wait();
+        Future holder(std::move(*this)); // 返回或抛出后释放共享状态
+        return holder.state_->take();
+    }
+
+    /**
+     * @brief 等待并取出结果，令牌被取消时放弃等待
+     *
+     * 放弃等待时 Future 仍然有效，之后可以再次等待。
+     *
+     * @param token 取消令牌
+     * @return R 任务的返回值
+     * @throws OperationCancelled 令牌在结果就绪前被取消或到达截止时间
+     */
+    R get(const CancellationToken& token) {
+        if (!state_->wait(token)) {
+            throw OperationCancelled(token.getReason());
+        }
+        return get();
+    }
+
+    /**
+     * @brief 注册延续
+     *
+     * 延续函数以前一个结果为参数（void 结果时无参数），在同一线程池中执行，
+     * 返回值成为新 Future 的结果。前一个任务抛出异常时不调用延续函数，
+     * 异常传递到新的 Future。调用后当前 Future 失效。
+     *
+     * @param function 延续函数
+     * @return Future 延续函数结果的 Future
+     */
+    template <typename F>
+    auto then(F&& function) -> Future<typename detail::ContinuationResult<typename std::decay<F>::type, R>::type> {
+        using Next = typename detail::ContinuationResult<typename std::decay<F>::type, R>::type;
+        using State = detail::ContinuationState<Next, typename std::decay<F>::type, R>;
+
+        detail::FutureState<R>* previous = state_;
+        state_ = nullptr; // 引用转移给延续任务
+
+        auto* next = new State(previous, std::forward<F>(function));
+        previous->setContinuation(next);
+        return Future<Next>(next);
+    }
+
+private:
+    template <typename>
+    friend class Future;
+    template <typename>
+    friend class Promise;
+    template <typename>
+    friend class detail::FutureAwaiter;
+    friend class ThreadManager;
+
+    explicit Future(detail::FutureState<R>* state) : state_(state) {}
+
+    void reset() {
+        if (state_) {
+            state_->releaseRef();
+            state_ = nullptr;
+        }
+    }
+
+    detail::FutureState<R>* state_ = nullptr;
+};
+
+/**
+ * @brief 结果的写入端
+ *
+ * 只能移动，不能复制。getFuture() 返回读取端，setValue()/setException() 只能调用其中一个且只调用一次。
+ * Promise 在写入结果之前销毁时，Future 收到 std::runtime_error("broken promise")。
+ *
+ * @tparam R 结果类型
+ */
+template <typename R>
+class Promise {
+public:
+    Promise() = default;
+
+    /**
+     * @brief 构造函数
+     *
+     * @param executor 执行延续的线程池，必须比 Future 的延续活得更久
+     */
+    explicit Promise(ThreadPool& executor) : state_(new detail::FutureState<R>(&executor)) {}
+
+    Promise(Promise&& other) noexcept : state_(other.state_), retrieved_(other.retrieved_) {
+        other.state_ = nullptr;
+    }
+
+    Promise& operator=(Promise&& other) noexcept {
+        if (this != &other) {
+            reset();
+            state_ = other.state_;
+            retrieved_ = other.retrieved_;
+            other.state_ = nullptr;
+        }
+        return *this;
+    }
+
+    Promise(const Promise&) = delete;
+    Promise& operator=(const Promise&) = delete;
+
+    ~Promise() {
+        reset();
+    }
+
+    /**
+     * @brief 是否关联了共享状态
+     */
+    bool valid() const {
+        return state_ != nullptr;
+    }
+
+    /**
+     * @brief 获取读取端
+     *
+     * @return Future 结果的 Future，第二次调用返回无效的 Future
+     */
+    Future<R> getFuture() {
+        if (!state_ || retrieved_) {
+            return Future<R>();
+        }
+        retrieved_ = true;
+        state_->addRef();
+        return Future<R>(state_);
+    }
+
+    /**
+     * @brief 写入结果
+     */
+    template <typename... V>
+    void setValue(V&&... value) {
+        state_->setValue(std::forward<V>(value)...);
+    }
+
+    /**
+     * @brief 写入异常
+     */
+    void setException(std::exception_ptr error) {
+        state_->setException(std::move(error));
+    }
+
+    /**
+     * @brief 是否已经写入结果或异常
+     */
+    bool isSatisfied() const {
+        return state_ && state_->isReady();
+    }
+
+private:
+    detail::FutureState<R>* state_ = nullptr;
+    bool retrieved_ = false;
+
+    void reset() {
+        if (!state_) {
+            return;
+        }
+        if (!state_->isReady()) {
+            state_->setException(std::make_exception_ptr(std::runtime_error("broken promise")));
+        }
+        state_->releaseRef();
+        state_ = nullptr;
+    }
+};
+
+} // namespace thread_framework
+
+#endif // FUTURE_H
@@ -8,6 +8,11 @@
 #include <atomic>
 #include <chrono>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "WorkerMetrics.h"
+#include "CancellationToken.h"
+#include "Tracing.h"
 
 /**
  * @file IThreadWorker.h
@@ -32,6 +37,19 @@ enum class ThreadState {
     FINISHED    ///< 线程已完成
 };
 
+class ThreadPool;
+class TimerService;
+class EventLoop;
+
+/**
+ * @brief 异步工作者的执行环境，由线程管理器在启动时提供
+ */
+struct AsyncContext {
+    ThreadPool* pool = nullptr;        ///< 恢复执行所用的线程池
+    TimerService* timers = nullptr;    ///< 共享定时服务
+    EventLoop* events = nullptr;       ///< 共享事件循环，用于等待文件描述符就绪
+};
+
 /**
  * @brief 线程工作者基类接口
  *
@@ -118,7 +136,7 @@ public:
      *
      * @return ThreadState 当前线程状态
      */
-    virtual ThreadState getState() const { return state.load(); }
+    virtual ThreadState getState() const { return state.load(std::memory_order_acquire); }
 
     /**
      * @brief 检查线程是否正在运行
@@ -126,7 +144,7 @@ public:
      * @return true 线程正在运行
      * @return false 线程未运行
      */
-    virtual bool isRunning() const { return state.load() == ThreadState::RUNNING; }
+    virtual bool isRunning() const { return state.load(std::memory_order_acquire) == ThreadState::RUNNING; }
 
     /**
      * @brief 检查线程是否已暂停
@@ -134,7 +152,7 @@ public:
      * @return true 线程已暂停
      * @return false 线程未暂停
      */
-    virtual bool isPaused() const { return state.load() == ThreadState::PAUSED; }
+    virtual bool isPaused() const { return state.load(std::memory_order_acquire) == ThreadState::PAUSED; }
 
     /**
      * @brief 检查线程是否已停止
@@ -142,7 +160,7 @@ public:
      * @return true 线程已停止
      * @return false 线程未停止
      */
-    virtual bool isStopped() const { return state.load() == ThreadState::STOPPED; }
+    virtual bool isStopped() const { return state.load(std::memory_order_acquire) == ThreadState::STOPPED; }
 
     /**
      * @brief 检查线程是否已完成
@@ -150,10 +168,204 @@ public:
      * @return true 线程已完成
      * @return false 线程未完成
      */
-    virtual bool isFinished() const { return state.load() == ThreadState::FINISHED; }
+    virtual bool isFinished() const { return state.load(std::memory_order_acquire) == ThreadState::FINISHED; }
+
+    /**
+     * @brief 检查工作者是否可以在线程池中执行
+     *
+     * 池化模式下，可池化的工作者会排队到已有的池线程上执行，而不是独占一个新线程。
+     * 只有执行时间有限的工作者才应该返回true，持续运行的工作者会长期占用池线程。
+     *
+     * @return true 可以在线程池中执行
+     * @return false 需要独占线程（默认）
+     */
+    virtual bool isPoolable() const { return false; }
+
+    // 共享定时服务驱动 - 周期性工作者可以不占用线程，由线程管理器的定时服务按间隔回调
+
+    /**
+     * @brief 获取共享定时服务模式下的触发间隔
+     *
+     * 返回大于0的间隔时，线程管理器不会为工作者创建线程或调用 run()，
+     * 而是把它注册到共享定时服务，每到期一次调用一次 onTimerTick()。
+     *
+     * @return std::chrono::milliseconds 触发间隔，0表示不使用共享定时服务（默认）
+     */
+    virtual std::chrono::milliseconds getSharedTimerInterval() const { return std::chrono::milliseconds(0); }
+
+    /**
+     * @brief 注册到共享定时服务前的回调
+     *
+     * 在 onStart() 之后调用，派生类在这里把状态设置为 RUNNING。
+     */
+    virtual void onTimerAttach() {}
+
+    /**
+     * @brief 共享定时服务每次到期时的回调
+     *
+     * 在定时服务线程上执行，实现应尽量简短，不能阻塞。
+     * 检测到停止请求或完成时应把状态设置为 FINISHED 并返回false。
+     *
+     * @return true 继续调度
+     * @return false 结束，线程管理器将其视为已完成
+     */
+    virtual bool onTimerTick() { return false; }
+
+    // 异步执行 - 协程工作者不独占线程，在线程池上运行，等待期间让出池线程
+
+    /**
+     * @brief 是否以异步方式执行
+     *
+     * 返回true时线程管理器不会调用 run()，而是在线程池上调用 startAsync()。
+     *
+     * @return true 异步工作者
+     * @return false 普通工作者（默认）
+     */
+    virtual bool isAsync() const { return false; }
+
+    /**
+     * @brief 启动异步执行
+     *
+     * 在 onStart() 之后于池线程上调用，应尽快返回。工作者结束时必须恰好调用一次 onFinished，
+     * 此后线程管理器可能立即销毁工作者。抛出异常时视为已结束，不能再调用 onFinished。
+     *
+     * @param context 执行环境
+     * @param onFinished 结束通知
+     */
+    virtual void startAsync(const AsyncContext& context, std::function<void()> onFinished) {
+        (void)context;
+        onFinished();
+    }
+
+    /**
+     * @brief 控制请求之后的通知
+     *
+     * 线程管理器在请求停止、暂停或恢复之后调用，异步工作者和 EventLoopWorker 借此结束正在进行的等待。
+     */
+    virtual void wakeAsync() {}
+
+    // 控制请求 - 由线程管理器调用，立即唤醒正在等待的工作者
+
+    /**
+     * @brief 请求停止
+     *
+     * 设置停止标志并唤醒在 shouldContinue()、waitFor() 或 waitUntil() 中等待的线程。
+     */
+    void requestStop() {
+        {
+            std::lock_guard<std::mutex> lock(controlMutex_);
+            shouldStop.store(true);
+        }
+        controlCondition_.notify_all();
+    }
+
+    /**
+     * @brief 请求暂停
+     *
+     * 工作者在下一次调用 shouldContinue() 时进入暂停状态。
+     */
+    void requestPause() {
+        std::lock_guard<std::mutex> lock(controlMutex_);
+        shouldPause.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief 请求恢复
+     *
+     * 清除暂停标志并唤醒在 shouldContinue() 中暂停的线程。
+     */
+    void requestResume() {
+        {
+            std::lock_guard<std::mutex> lock(controlMutex_);
+            shouldPause.store(false, std::memory_order_release);
+        }
+        controlCondition_.notify_all();
+    }
+
+    /**
+     * @brief 清除控制状态以便复用
+     *
+     * 状态回到 STOPPED，清除停止和暂停请求、取消令牌和运行指标。
+     * 只能在工作者没有执行、也没有其它线程访问它时调用，线程管理器在回收工作者时调用。
+     */
+    void resetControlState() {
+        {
+            std::lock_guard<std::mutex> lock(controlMutex_);
+            shouldStop.store(false);
+            shouldPause.store(false, std::memory_order_release);
+            cancellation_ = CancellationToken();
+        }
+        metrics_.reset();
+        state.store(ThreadState::STOPPED);
+    }
+
+    /**
+     * @brief 报告错误
+     *
+     * 计入错误次数后调用 onError()。框架和内置工作者通过它报告错误，
+     * 自定义工作者也应使用它代替直接调用 onError()。
+     *
+     * @param error 错误信息
+     */
+    void reportError(const std::string& error) {
+        metrics_.recordError();
+        onError(error);
+    }
+
+    /**
+     * @brief 获取运行指标
+     *
+     * 包括运行时间、排队等待时间、暂停时间、错误次数和回调延迟直方图。
+     */
+    WorkerMetrics& getMetrics() { return metrics_; }
+    const WorkerMetrics& getMetrics() const { return metrics_; }
+
+    /**
+     * @brief 检查是否已请求停止
+     *
+     * 取消令牌被取消或超过截止时间也视为请求停止。
+     */
+    bool isStopRequested() const { return shouldStop.load() || cancellation_.isCancelled(); }
+
+    /**
+     * @brief 设置取消令牌
+     *
+     * 必须在启动之前设置。线程管理器按 ThreadLaunchOptions::cancellation 设置，
+     * 令牌被取消时像 stopThread() 一样向工作者发出停止请求，到达截止时间时也会发出。
+     *
+     * @param token 取消令牌
+     */
+    void setCancellationToken(CancellationToken token) { cancellation_ = std::move(token); }
+
+    /**
+     * @brief 获取取消令牌
+     *
+     * 可以传给 Future::get()、MPMCQueue 的等待，或作为父令牌派生子任务的 CancellationSource。
+     */
+    const CancellationToken& getCancellationToken() const { return cancellation_; }
+
+    /**
+     * @brief 检查是否已请求暂停
+     */
+    bool isPauseRequested() const { return shouldPause.load(std::memory_order_acquire); }
+
+private:
+    // 冷数据放在对象开头，只在暂停、停止和等待时访问
+    std::mutex controlMutex_;                   ///< 保护暂停/停止等待
+    std::condition_variable controlCondition_;  ///< 控制请求的唤醒通知
+    CancellationToken cancellation_;            ///< 取消令牌，默认永不取消
+    std::chrono::steady_clock::time_point pauseStart_; ///< 定时服务模式下暂停开始的时间
 
 protected:
-    std::atomic<ThreadState> state{ThreadState::STOPPED};
+    /**
+     * 控制标志独占一个缓存行：工作者在每次 shouldContinue() 中读取，控制方只在状态变化时写入。
+     * 工作者频繁写入的指标和派生类的计数器从下一个缓存行开始，
+     * 管理器遍历所有工作者读取状态时不会与工作者自己的写入争用缓存行。
+     *
+     * shouldStop 保持 seq_cst：stopThread() 写入后读取条目的启动标志，与工作者启动时的顺序相反，
+     * 需要全序保证“启动前请求的停止”一定被看到。
+     */
+    alignas(64) std::atomic<ThreadState> state{ThreadState::STOPPED};
     std::atomic<bool> shouldStop{false};
     std::atomic<bool> shouldPause{false};
 
@@ -161,16 +373,109 @@ protected:
      * @brief 检查线程是否应该继续执行
      *
      * 这个方法应该在派生类的run()方法中定期调用，以响应暂停和停止请求。
+     * 暂停期间线程阻塞在条件变量上，状态为 PAUSED，恢复或停止请求会立即唤醒它。
      *
      * @return true 线程应该继续执行
      * @return false 线程应该停止执行
      */
     virtual bool shouldContinue() {
         // 处理暂停状态
-        while (shouldPause.load() && !shouldStop.load()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (shouldPause.load(std::memory_order_acquire) && !shouldStop.load()) {
+            std::unique_lock<std::mutex> lock(controlMutex_);
+            ThreadState previous = state.load(std::memory_order_relaxed);
+            setState(ThreadState::PAUSED);
+            TF_TRACE(TraceKind::PAUSE, TracePhase::ASYNC_BEGIN, Tracer::CURRENT_WORKER, 0);
+            auto pauseStart = std::chrono::steady_clock::now();
+            controlCondition_.wait(lock, [this]() {
+                return !shouldPause.load(std::memory_order_relaxed) || shouldStop.load() || cancellation_.isCancelled();
+            });
+            metrics_.recordPause(std::chrono::steady_clock::now() - pauseStart);
+            TF_TRACE(TraceKind::PAUSE, TracePhase::ASYNC_END, Tracer::CURRENT_WORKER, 0);
+            setState(previous);
         }
-        return !shouldStop.load();
+        return !isStopRequested();
+    }
+
+    /**
+     * @brief 根据暂停请求更新状态，不阻塞
+     *
+     * 供共享定时服务驱动的工作者在 onTimerTick() 中使用，代替会阻塞的 shouldContinue()。
+     *
+     * @return true 未暂停，可以执行本次工作
+     * @return false 已暂停，应跳过本次工作
+     */
+    bool updatePausedState() {
+        if (shouldPause.load(std::memory_order_acquire)) {
+            if (state.load(std::memory_order_relaxed) != ThreadState::PAUSED) {
+                pauseStart_ = std::chrono::steady_clock::now();
+                setState(ThreadState::PAUSED);
+                TF_TRACE(TraceKind::PAUSE, TracePhase::ASYNC_BEGIN, Tracer::CURRENT_WORKER, 0);
+            }
+            return false;
+        }
+        if (state.load(std::memory_order_relaxed) == ThreadState::PAUSED) {
+            metrics_.recordPause(std::chrono::steady_clock::now() - pauseStart_);
+            TF_TRACE(TraceKind::PAUSE, TracePhase::ASYNC_END, Tracer::CURRENT_WORKER, 0);
+            setState(ThreadState::RUNNING);
+        }
+        return true;
+    }
+
+    /**
+     * @brief 执行回调并记录耗时
+     *
+     * 耗时进入回调延迟直方图，开启跟踪时记录为 callback 区间，回调抛出的异常继续向外传播。
+     *
+     * @param callback 回调
+     */
+    template <typename F>
+    void timeCallback(F&& callback) {
+        TF_TRACE_SPAN(TraceKind::CALLBACK, Tracer::CURRENT_WORKER);
+        auto start = std::chrono::steady_clock::now();
+        try {
+            callback();
+        } catch (...) {
+            metrics_.recordCallbackLatency(std::chrono::steady_clock::now() - start);
+            throw;
+        }
+        metrics_.recordCallbackLatency(std::chrono::steady_clock::now() - start);
+    }
+
+    /**
+     * @brief 可中断的等待
+     *
+     * 用于替代 std::this_thread::sleep_for，停止请求会立即结束等待。
+     *
+     * @param duration 等待时长
+     * @return true 等待了完整时长
+     * @return false 等待被停止请求中断
+     */
+    template <typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& duration) {
+        return waitUntil(std::chrono::steady_clock::now() + duration);
+    }
+
+    /**
+     * @brief 可中断地等待到指定时间点
+     *
+     * 取消令牌的截止时间早于 deadline 时在令牌的截止时间结束等待。
+     *
+     * @param deadline 截止时间
+     * @return true 到达截止时间
+     * @return false 等待被停止请求或取消中断
+     */
+    template <typename Clock, typename Duration>
+    bool waitUntil(const std::chrono::time_point<Clock, Duration>& deadline) {
+        std::unique_lock<std::mutex> lock(controlMutex_);
+        auto stopped = [this]() { return shouldStop.load() || cancellation_.isCancelled(); };
+        if (cancellation_.hasDeadline()) {
+            auto remaining = cancellation_.getDeadline() - std::chrono::steady_clock::now();
+            if (Clock::now() + remaining < deadline) {
+                controlCondition_.wait_for(lock, remaining, stopped);
+                return false;
+            }
+        }
+        return !controlCondition_.wait_until(lock, deadline, stopped);
     }
 
     /**
@@ -179,8 +484,11 @@ protected:
      * @param newState 新的线程状态
      */
     virtual void setState(ThreadState newState) {
-        state.store(newState);
+        state.store(newState, std::memory_order_release);
     }
+
+private:
+    alignas(64) WorkerMetrics metrics_;         ///< 运行指标，由工作者线程写入，与控制标志不在同一缓存行
 };
 
 /**
@@ -216,6 +524,30 @@ public:
     virtual bool supportsConfig(const std::string& config) const {
         return true; // 默认支持所有配置
     }
+
+    /**
+     * @brief 重置已结束的工作者以便复用
+     *
+     * 返回true时工作者进入该类型的空闲列表，之后的 createThread() 直接取用，
+     * 不再调用 createWorker() 和 onInitialize()，onInitialize() 中建立的连接、缓冲区等得以保留。
+     * 调用时工作者已经结束，停止/暂停请求、取消令牌和运行指标已由框架清除，
+     * 这里只需要恢复派生类自己的状态（计数、进度等）。默认返回false，工作者被销毁。
+     *
+     * @param worker 由本工厂创建、已结束的工作者
+     * @return true 可以复用
+     * @return false 不能复用，销毁工作者
+     */
+    virtual bool resetWorker(IThreadWorker& worker) {
+        (void)worker;
+        return false;
+    }
+
+    /**
+     * @brief 空闲列表最多保留的工作者数，超出时结束的工作者被销毁
+     */
+    virtual size_t getRecycleLimit() const {
+        return 16;
+    }
 };
 
 } // namespace thread_framework
@@ -0,0 +1,564 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <chrono>
+#include <charconv>
+#include <type_traits>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+/**
+ * @file Logger.h
+ * @brief 异步日志
+ *
+ * 框架内部的输出都经过这里，不再直接写 std::cout。每个写日志的线程拥有一个单生产者环形缓冲区，
+ * 写日志只是把格式化后的文本复制到本线程的缓冲区，不加锁、不进行系统调用；
+ * 后台刷新线程定期收集所有缓冲区，按时间顺序交给日志输出端。缓冲区满时丢弃消息并计数，不阻塞调用方。
+ *
+ * 编译时用 THREAD_FRAMEWORK_LOG_LEVEL 指定最低级别，低于该级别的 TF_LOG_* 调用连同参数求值一起被消除。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+/**
+ * @brief 编译时的最低日志级别，数值与 LogLevel 相同，默认为 INFO
+ */
+#ifndef THREAD_FRAMEWORK_LOG_LEVEL
+#define THREAD_FRAMEWORK_LOG_LEVEL 2
+#endif
+
+namespace thread_framework {
+
+/**
+ * @brief 日志级别枚举
+ */
+enum class LogLevel {
+    TRACE = 0,      ///< 最详细的跟踪信息
+    VERBOSE = 1,    ///< 调试信息
+    INFO = 2,       ///< 一般信息
+    WARNING = 3,    ///< 警告
+    ERROR = 4,      ///< 错误
+    OFF = 5         ///< 关闭日志
+};
+
+/**
+ * @brief 获取日志级别名称
+ */
+inline const char* getLogLevelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::TRACE: return "TRACE";
+        case LogLevel::VERBOSE: return "VERBOSE";
+        case LogLevel::INFO: return "INFO";
+        case LogLevel::WARNING: return "WARNING";
+        case LogLevel::ERROR: return "ERROR";
+        case LogLevel::OFF: return "OFF";
+    }
+    return "UNKNOWN";
+}
+
+/**
+ * @brief 一条日志记录
+ *
+ * 固定大小，直接在环形缓冲区的槽位中格式化，超长的文本被截断。
+ */
+struct LogRecord {
+    static constexpr size_t kMaxText = 240;
+
+    uint64_t timestampNs = 0;        ///< 写入时间，system_clock 纪元以来的纳秒数
+    LogLevel level = LogLevel::INFO; ///< 日志级别
+    uint32_t length = 0;             ///< 文本长度
+    char text[kMaxText];             ///< 文本，不以0结尾
+
+    std::string_view message() const {
+        return std::string_view(text, length);
+    }
+};
+
+/**
+ * @brief 日志输出端接口
+ *
+ * 只由刷新线程（或调用 Logger::flush() 的线程）在刷新锁内调用，实现不需要自己加锁。
+ */
+class ILogSink {
+public:
+    virtual ~ILogSink() = default;
+
+    /**
+     * @brief 输出一条记录
+     */
+    virtual void write(const LogRecord& record) = 0;
+
+    /**
+     * @brief 一批记录输出完毕后调用
+     */
+    virtual void flush() {}
+};
+
+/**
+ * @brief 输出到 stdio 流的日志输出端，每条记录一行
+ */
+class StreamLogSink : public ILogSink {
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param stream 输出流，默认为标准输出
+     * @param showLevel 是否在文本前输出级别
+     */
+    explicit StreamLogSink(FILE* stream = stdout, bool showLevel = false)
+        : stream_(stream), showLevel_(showLevel) {}
+
+    void write(const LogRecord& record) override {
+        if (showLevel_) {
+            std::fprintf(stream_, "%s: ", getLogLevelName(record.level));
+        }
+        std::fwrite(record.text, 1, record.length, stream_);
+        std::fputc('\n', stream_);
+    }
+
+    void flush() override {
+        std::fflush(stream_);
+    }
+
+private:
+    FILE* stream_;
+    bool showLevel_;
+};
+
+namespace detail {
+
+/**
+ * @brief 向固定大小的缓冲区追加文本，超出部分被截断
+ */
+class LogWriter {
+public:
+    LogWriter(char* buffer, size_t capacity) : buffer_(buffer), capacity_(capacity) {}
+
+    void append(const char* data, size_t size) {
+        size_t count = std::min(size, capacity_ - length_);
+        std::memcpy(buffer_ + length_, data, count);
+        length_ += count;
+    }
+
+    template <typename T>
+    void appendValue(const T& value) {
+        using V = typename std::decay<T>::type;
+        if constexpr (std::is_same<V, bool>::value) {
+            append(value ? "true" : "false", value ? 4 : 5);
+        } else if constexpr (std::is_same<V, char>::value) {
+            append(&value, 1);
+        } else if constexpr (std::is_integral<V>::value) {
+            char digits[24];
+            auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            append(digits, static_cast<size_t>(result.ptr - digits));
+        } else if constexpr (std::is_floating_point<V>::value) {
+            char digits[32];
+            int count = std::snprintf(digits, sizeof(digits), "%g", static_cast<double>(value));
+            append(digits, count > 0 ? std::min<size_t>(static_cast<size_t>(count), sizeof(digits) - 1) : 0);
+        } else if constexpr (std::is_enum<V>::value) {
+            appendValue(static_cast<typename std::underlying_type<V>::type>(value));
+        } else if constexpr (std::is_convertible<const V&, std::string_view>::value) {
+            std::string_view text(value);
+            append(text.data(), text.size());
+        } else if constexpr (std::is_pointer<V>::value) {
+            char digits[24];
+            int count = std::snprintf(digits, sizeof(digits), "%p", static_cast<const void*>(value));
+            append(digits, count > 0 ? std::min<size_t>(static_cast<size_t>(count), sizeof(digits) - 1) : 0);
+        } else {
+            static_assert(std::is_void<V>::value && false, "unsupported log argument type");
+        }
+    }
+
+    size_t length() const {
+        return length_;
+    }
+
+private:
+    char* buffer_;
+    size_t capacity_;
+    size_t length_ = 0;
+};
+
+/**
+ * @brief 单生产者单消费者的日志环形缓冲区
+ *
+ * 生产者是拥有它的线程，消费者是持有刷新锁的线程。
+ */
+class LogRing {
+public:
+    static constexpr size_t kCapacity = 256;
+
+    /**
+     * @brief 获取下一个可写的槽位
+     *
+     * @return LogRecord* 槽位，缓冲区已满时返回 nullptr
+     */
+    LogRecord* beginWrite() {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) >= kCapacity) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &records_[tail & (kCapacity - 1)];
+    }
+
+    /**
+     * @brief 发布 beginWrite() 返回的槽位
+     *
+     * @return true 缓冲区刚好达到半满，应提前唤醒刷新线程
+     */
+    bool commit() {
+        size_t tail = tail_.load(std::memory_order_relaxed) + 1;
+        tail_.store(tail, std::memory_order_release);
+        return tail - head_.load(std::memory_order_relaxed) == kCapacity / 2;
+    }
+
+    /**
+     * @brief 取出所有已发布的记录
+     */
+    void drain(std::vector<LogRecord>& out) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+            out.push_back(records_[head & (kCapacity - 1)]);
+        }
+        head_.store(head, std::memory_order_release);
+    }
+
+    /**
+     * @brief 取出并清零丢弃计数
+     */
+    uint64_t takeDropped() {
+        return dropped_.exchange(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 拥有者线程退出，缓冲区取空后可以分配给新线程
+     */
+    void orphan() {
+        orphaned_.store(true, std::memory_order_release);
+    }
+
+    bool isReusable() const {
+        return orphaned_.load(std::memory_order_acquire) &&
+               head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_relaxed);
+    }
+
+    void adopt() {
+        orphaned_.store(false, std::memory_order_relaxed);
+        free = false;
+    }
+
+    bool free = false;       ///< 是否在空闲列表中，由 Logger 的 ringsMutex_ 保护
+
+private:
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<bool> orphaned_{false};
+    LogRecord records_[kCapacity];
+};
+
+} // namespace detail
+
+/**
+ * @brief 异步日志器
+ *
+ * 进程级单例，第一次使用时创建，刻意不析构：静态对象析构期间写的日志仍然有效。
+ * 进程退出时剩余的日志被刷新，之后的日志同步写入输出端。
+ */
+class Logger {
+public:
+    /**
+     * @brief 获取日志器
+     */
+    static Logger& instance() {
+        static Logger* logger = new Logger();
+        static ShutdownGuard guard(*logger);
+        return *logger;
+    }
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    /**
+     * @brief 检查运行时级别是否允许输出
+     */
+    bool isEnabled(LogLevel level) const {
+        return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 设置运行时的最低级别
+     *
+     * 只能在编译时级别的基础上进一步过滤，被编译时级别消除的调用不会恢复。
+     */
+    void setLevel(LogLevel level) {
+        level_.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    LogLevel getLevel() const {
+        return static_cast<LogLevel>(level_.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief 替换日志输出端
+     *
+     * 先刷新已缓冲的日志到旧的输出端。
+     *
+     * @param sink 新的输出端，为空时恢复为标准输出
+     */
+    void setSink(std::unique_ptr<ILogSink> sink) {
+        flush();
+        std::lock_guard<std::mutex> lock(flushMutex_);
+        sink_ = sink ? std::move(sink) : std::make_unique<StreamLogSink>();
+    }
+
+    /**
+     * @brief 设置后台刷新间隔
+     */
+    void setFlushInterval(std::chrono::milliseconds interval) {
+        flushIntervalMs_.store(std::max<int64_t>(1, interval.count()), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 写一条日志，不阻塞
+     *
+     * 参数依次追加到同一条记录中，支持字符串、整数、浮点数、布尔值、枚举和指针。
+     */
+    template <typename... Args>
+    void log(LogLevel level, const Args&... args) {
+        if (shutdown_.load(std::memory_order_acquire) || threadExited()) {
+            LogRecord record;
+            format(record, level, args...);
+            std::lock_guard<std::mutex> lock(flushMutex_);
+            sink_->write(record);
+            sink_->flush();
+            return;
+        }
+
+        detail::LogRing& ring = localRing();
+        LogRecord* record = ring.beginWrite();
+        if (!record) {
+            return; // 缓冲区已满，丢弃并计数
+        }
+        format(*record, level, args...);
+        if (ring.commit()) {
+            // 不加锁，错过时刷新线程按间隔醒来
+            wakeRequested_.store(true, std::memory_order_relaxed);
+            wakeCondition_.notify_one();
+        }
+    }
+
+    /**
+     * @brief 立即把所有已缓冲的日志写入输出端
+     */
+    void flush() {
+        std::lock_guard<std::mutex> lock(flushMutex_);
+        drainLocked();
+    }
+
+    /**
+     * @brief 获取因缓冲区满而丢弃的消息总数
+     */
+    uint64_t getDroppedCount() const {
+        return droppedTotal_.load(std::memory_order_relaxed);
+    }
+
+private:
+    /**
+     * @brief 在静态对象析构阶段停止刷新线程并刷新剩余日志
+     */
+    struct ShutdownGuard {
+        Logger& logger;
+
+        explicit ShutdownGuard(Logger& l) : logger(l) {}
+
+        ~ShutdownGuard() {
+            logger.shutdown();
+        }
+    };
+
+    /**
+     * @brief 线程退出时交还环形缓冲区
+     */
+    struct RingHolder {
+        detail::LogRing* ring = nullptr;
+
+        ~RingHolder() {
+            if (ring) {
+                ring->orphan();
+                ring = nullptr;
+            }
+            threadExited() = true;
+        }
+    };
+
+    /**
+     * @brief 当前线程的 RingHolder 是否已析构，之后的日志同步写入
+     */
+    static bool& threadExited() {
+        thread_local bool exited = false;
+        return exited;
+    }
+
+    std::atomic<int> level_{static_cast<int>(LogLevel::INFO)};
+    std::atomic<bool> shutdown_{false};
+    std::atomic<int64_t> flushIntervalMs_{5};
+    std::atomic<uint64_t> droppedTotal_{0};
+    std::atomic<bool> wakeRequested_{false};
+
+    std::mutex ringsMutex_;
+    std::vector<std::unique_ptr<detail::LogRing>> rings_;   ///< 由 ringsMutex_ 保护
+    std::vector<detail::LogRing*> freeRings_;              ///< 已取空、可复用的缓冲区，由 ringsMutex_ 保护
+
+    std::mutex flushMutex_;                                ///< 保护输出端和消费端
+    std::unique_ptr<ILogSink> sink_;
+    std::vector<LogRecord> batch_;                         ///< 刷新时的临时缓冲，由 flushMutex_ 保护
+
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCondition_;
+    std::thread flusher_;
+
+    Logger() : sink_(std::make_unique<StreamLogSink>()) {
+        flusher_ = std::thread([this]() { flusherLoop(); });
+    }
+
+    template <typename... Args>
+    static void format(LogRecord& record, LogLevel level, const Args&... args) {
+        record.timestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        record.level = level;
+        detail::LogWriter writer(record.text, LogRecord::kMaxText);
+        (writer.appendValue(args), ...);
+        record.length = static_cast<uint32_t>(writer.length());
+    }
+
+    /**
+     * @brief 获取当前线程的环形缓冲区，第一次调用时分配或复用一个
+     */
+    detail::LogRing& localRing() {
+        thread_local RingHolder holder;
+        if (!holder.ring) {
+            std::lock_guard<std::mutex> lock(ringsMutex_);
+            if (!freeRings_.empty()) {
+                holder.ring = freeRings_.back();
+                freeRings_.pop_back();
+                holder.ring->adopt();
+            } else {
+                rings_.push_back(std::make_unique<detail::LogRing>());
+                holder.ring = rings_.back().get();
+            }
+        }
+        return *holder.ring;
+    }
+
+    /**
+     * @brief 收集所有缓冲区并按时间顺序输出，调用方持有 flushMutex_
+     */
+    void drainLocked() {
+        std::vector<detail::LogRing*> active;
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex_);
+            active.reserve(rings_.size());
+            for (const auto& ring : rings_) {
+                if (!ring->free) {
+                    active.push_back(ring.get());
+                }
+            }
+        }
+
+        uint64_t dropped = 0;
+        batch_.clear();
+        for (detail::LogRing* ring : active) {
+            ring->drain(batch_);
+            dropped += ring->takeDropped();
+        }
+
+        if (!batch_.empty() || dropped > 0) {
+            std::stable_sort(batch_.begin(), batch_.end(), [](const LogRecord& a, const LogRecord& b) {
+                return a.timestampNs < b.timestampNs;
+            });
+            for (const auto& record : batch_) {
+                sink_->write(record);
+            }
+            if (dropped > 0) {
+                droppedTotal_.fetch_add(dropped, std::memory_order_relaxed);
+                LogRecord notice;
+                format(notice, LogLevel::WARNING, "[Logger] Dropped ", dropped, " messages, log buffer full");
+                sink_->write(notice);
+            }
+            sink_->flush();
+        }
+
+        // 拥有者已退出且已取空的缓冲区留给新线程复用
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        for (detail::LogRing* ring : active) {
+            if (!ring->free && ring->isReusable()) {
+                ring->free = true;
+                freeRings_.push_back(ring);
+            }
+        }
+    }
+
+    void flusherLoop() {
+        while (!shutdown_.load(std::memory_order_acquire)) {
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex_);
+                auto interval = std::chrono::milliseconds(flushIntervalMs_.load(std::memory_order_relaxed));
+                wakeCondition_.wait_for(lock, interval, [this]() {
+                    return shutdown_.load(std::memory_order_acquire) ||
+                           wakeRequested_.exchange(false, std::memory_order_relaxed);
+                });
+            }
+            flush();
+        }
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            shutdown_.store(true, std::memory_order_release);
+        }
+        wakeCondition_.notify_all();
+        if (flusher_.joinable()) {
+            flusher_.join();
+        }
+        flush();
+    }
+};
+
+} // namespace thread_framework
+
+/**
+ * @brief 写日志，级别低于 THREAD_FRAMEWORK_LOG_LEVEL 时整条语句在编译时被消除，参数不会求值
+ */
+#define TF_LOG(level, ...)                                                                          \
+    do {                                                                                            \
+        if constexpr (static_cast<int>(level) >= THREAD_FRAMEWORK_LOG_LEVEL) {                      \
+            ::thread_framework::Logger& tfLogger = ::thread_framework::Logger::instance();          \
+            if (tfLogger.isEnabled(level)) {                                                        \
+                tfLogger.log(level, __VA_ARGS__);                                                   \
+            }                                                                                       \
+        }                                                                                           \
+    } while (0)
+
+#define TF_LOG_TRACE(...) TF_LOG(::thread_framework::LogLevel::TRACE, __VA_ARGS__)
+#define TF_LOG_VERBOSE(...) TF_LOG(::thread_framework::LogLevel::VERBOSE, __VA_ARGS__)
+#define TF_LOG_INFO(...) TF_LOG(::thread_framework::LogLevel::INFO, __VA_ARGS__)
+#define TF_LOG_WARNING(...) TF_LOG(::thread_framework::LogLevel::WARNING, __VA_ARGS__)
+#define TF_LOG_ERROR(...) TF_LOG(::thread_framework::LogLevel::ERROR, __VA_ARGS__)
+
+#endif // LOGGER_H
@@ -0,0 +1,504 @@
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include "CancellationToken.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <new>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file MPMCQueue.h
+ * @brief 有界无锁多生产者多消费者队列
+ *
+ * 基于 Dmitry Vyukov 的有界 MPMC 环形队列：每个槽位带一个序号，生产者和消费者
+ * 只通过对入队/出队位置的 CAS 竞争，不需要锁。QueueWorker 使用它在多个消费者之间分发任务。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief 有界无锁 MPMC 队列
+ *
+ * tryPush()/tryPop() 是无锁操作。push()/pop()/popBulk() 的阻塞版本在队列满或空时
+ * 在条件变量上休眠，只有存在休眠方时对方才会加锁通知，没有等待方时不增加开销。
+ * close() 之后不能再入队，消费者取完剩余元素后返回。
+ * 停止条件可以是 CancellationToken：令牌被取消或到达截止时间时等待立即结束，不需要调用 wake*()。
+ *
+ * @tparam T 元素类型，必须可默认构造和移动
+ */
+template <typename T>
+class MPMCQueue {
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param capacity 容量，向上取整为2的幂，至少为2
+     */
+    explicit MPMCQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+
+        cells_.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief 析构函数，销毁剩余元素
+     */
+    ~MPMCQueue() {
+        T item;
+        while (tryPop(item)) {
+        }
+    }
+
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    /**
+     * @brief 尝试入队，不阻塞
+     *
+     * @param item 要入队的元素，成功时被移走
+     * @return true 入队成功
+     * @return false 队列已满或已关闭（背压）
+     */
+    bool tryPush(T&& item) {
+        if (closed_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (!enqueue(item)) {
+            return false;
+        }
+        notifyConsumers();
+        return true;
+    }
+
+    bool tryPush(const T& item) {
+        T copy(item);
+        return tryPush(std::move(copy));
+    }
+
+    /**
+     * @brief 入队，队列满时阻塞
+     *
+     * @param item 要入队的元素
+     * @return true 入队成功
+     * @return false 队列已关闭
+     */
+    bool push(T item) {
+        return push(std::move(item), []() { return false; });
+    }
+
+    /**
+     * @brief 入队，队列满时阻塞，可以被停止条件中断
+     *
+     * @param item 要入队的元素
+     * @param stop 停止条件，返回true时放弃等待；改变条件后需调用 wakeProducers()
+     * @return true 入队成功
+     * @return false 队列已关闭或停止条件成立
+     */
+    template <typename Stop>
+    bool push(T item, Stop&& stop) {
+        while (!closed_.load(std::memory_order_relaxed)) {
+            if (enqueue(item)) {
+                notifyConsumers();
+                return true;
+            }
+            if (stop()) {
+                return false;
+            }
+
+            CancellationRegistration wake = wakeOnCancel(stop, notFull_);
+            std::unique_lock<std::mutex> lock(mutex_);
+            producerWaiters_.fetch_add(1, std::memory_order_seq_cst);
+            waitWithStop(notFull_, lock, stop, [this, &stop]() {
+                return canPush() || closed_.load(std::memory_order_relaxed) || stop();
+            });
+            producerWaiters_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return false;
+    }
+
+    /**
+     * @brief 尝试出队，不阻塞
+     *
+     * @param item 输出参数
+     * @return true 取到元素
+     * @return false 队列为空
+     */
+    bool tryPop(T& item) {
+        if (!dequeue(item)) {
+            return false;
+        }
+        notifyProducers();
+        return true;
+    }
+
+    /**
+     * @brief 出队，队列空时休眠等待
+     *
+     * @param item 输出参数
+     * @param stop 停止条件，返回true时放弃等待；改变条件后需调用 wakeConsumers()
+     * @return true 取到元素
+     * @return false 队列已关闭且为空，或停止条件成立
+     */
+    template <typename Stop>
+    bool pop(T& item, Stop&& stop) {
+        while (true) {
+            if (tryPop(item)) {
+                return true;
+            }
+            if (!waitForItems(stop)) {
+                return tryPop(item);
+            }
+        }
+    }
+
+    bool pop(T& item) {
+        return pop(item, []() { return false; });
+    }
+
+    /**
+     * @brief 批量出队，不阻塞
+     *
+     * @param out 取出的元素追加到这里
+     * @param maxItems 最多取出的数量
+     * @return size_t 取出的数量
+     */
+    size_t tryPopBulk(std::vector<T>& out, size_t maxItems) {
+        size_t count = 0;
+        T item;
+        while (count < maxItems && dequeue(item)) {
+            out.push_back(std::move(item));
+            ++count;
+        }
+        if (count > 0) {
+            notifyProducers();
+        }
+        return count;
+    }
+
+    /**
+     * @brief 批量出队，队列空时休眠等待至少一个元素
+     *
+     * @param out 取出的元素追加到这里
+     * @param maxItems 最多取出的数量
+     * @param stop 停止条件，返回true时放弃等待；改变条件后需调用 wakeConsumers()
+     * @return size_t 取出的数量，0表示队列已关闭且为空或停止条件成立
+     */
+    template <typename Stop>
+    size_t popBulk(std::vector<T>& out, size_t maxItems, Stop&& stop) {
+        while (true) {
+            size_t count = tryPopBulk(out, maxItems);
+            if (count > 0) {
+                return count;
+            }
+            if (!waitForItems(stop)) {
+                return tryPopBulk(out, maxItems);
+            }
+        }
+    }
+
+    size_t popBulk(std::vector<T>& out, size_t maxItems) {
+        return popBulk(out, maxItems, []() { return false; });
+    }
+
+    /**
+     * @brief 微批出队：等待第一个元素，之后最多再等 maxDelay 凑满 maxItems 个
+     *
+     * 凑满、超时、队列关闭或停止条件成立时立即返回已取出的元素。
+     *
+     * @param out 取出的元素追加到这里
+     * @param maxItems 最多取出的数量
+     * @param maxDelay 取到第一个元素后最多等待的时长，0表示不等待
+     * @param stop 停止条件，返回true时放弃等待；改变条件后需调用 wakeConsumers()
+     * @return size_t 取出的数量，0表示队列已关闭且为空或停止条件成立
+     */
+    template <typename Rep, typename Period, typename Stop>
+    size_t popBulkFor(std::vector<T>& out, size_t maxItems, const std::chrono::duration<Rep, Period>& maxDelay,
+                      Stop&& stop) {
+        size_t count = popBulk(out, maxItems, stop);
+        if (count == 0 || count >= maxItems || maxDelay <= maxDelay.zero()) {
+            return count;
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + maxDelay;
+        while (count < maxItems) {
+            count += tryPopBulk(out, maxItems - count);
+            if (count >= maxItems || !waitForItemsUntil(deadline, stop)) {
+                break;
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @brief 关闭队列
+     *
+     * 之后的入队都会失败，阻塞中的生产者和消费者被唤醒，消费者仍可取完剩余元素。
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_.store(true);
+        }
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+
+    /**
+     * @brief 唤醒所有休眠的消费者，让它们重新检查停止条件
+     */
+    void wakeConsumers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+        }
+        notEmpty_.notify_all();
+    }
+
+    /**
+     * @brief 唤醒所有阻塞的生产者，让它们重新检查停止条件
+     */
+    void wakeProducers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+        }
+        notFull_.notify_all();
+    }
+
+    bool isClosed() const {
+        return closed_.load();
+    }
+
+    /**
+     * @brief 获取元素数量（近似值）
+     */
+    size_t size() const {
+        size_t enqueued = enqueuePos_.value.load(std::memory_order_relaxed);
+        size_t dequeued = dequeuePos_.value.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+private:
+    /**
+     * @brief 槽位：序号等于位置时可写，等于位置+1时可读
+     */
+    struct Cell {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        T* item() { return std::launder(reinterpret_cast<T*>(&storage)); }
+    };
+
+    /**
+     * @brief 独占缓存行的位置计数，避免生产者和消费者之间的伪共享
+     */
+    struct alignas(64) Position {
+        std::atomic<size_t> value{0};
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    Position enqueuePos_;
+    Position dequeuePos_;
+
+    alignas(64) std::atomic<bool> closed_{false};
+    std::atomic<size_t> consumerWaiters_{0};
+    std::atomic<size_t> producerWaiters_{0};
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+
+    bool enqueue(T& item) {
+        size_t pos = enqueuePos_.value.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // 已满
+            } else {
+                pos = enqueuePos_.value.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (&cell->storage) T(std::move(item));
+        // seq_cst 与休眠方对等待者计数的 seq_cst 操作配对，见 waitForItems()
+        cell->sequence.store(pos + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    bool dequeue(T& item) {
+        size_t pos = dequeuePos_.value.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // 为空
+            } else {
+                pos = dequeuePos_.value.load(std::memory_order_relaxed);
+            }
+        }
+
+        T* stored = cell->item();
+        item = std::move(*stored);
+        stored->~T();
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    /**
+     * @brief 队首槽位是否可读
+     */
+    bool canPop() const {
+        size_t pos = dequeuePos_.value.load(std::memory_order_seq_cst);
+        return cells_[pos & mask_].sequence.load(std::memory_order_seq_cst) == pos + 1;
+    }
+
+    /**
+     * @brief 队尾槽位是否可写
+     */
+    bool canPush() const {
+        size_t pos = enqueuePos_.value.load(std::memory_order_seq_cst);
+        return cells_[pos & mask_].sequence.load(std::memory_order_seq_cst) == pos;
+    }
+
+    /**
+     * @brief 休眠直到可能有元素可读
+     *
+     * 先登记等待者再复查队列：生产者发布元素后读取等待者计数，
+     * 两边都是 seq_cst，要么生产者看到等待者并通知，要么这里看到新元素。
+     *
+     * @return true 应重试出队
+     * @return false 队列已关闭且为空，或停止条件成立
+     */
+    template <typename Stop>
+    bool waitForItems(Stop& stop) {
+        CancellationRegistration wake = wakeOnCancel(stop, notEmpty_);
+        std::unique_lock<std::mutex> lock(mutex_);
+        consumerWaiters_.fetch_add(1, std::memory_order_seq_cst);
+        waitWithStop(notEmpty_, lock, stop, [this, &stop]() {
+            return canPop() || closed_.load(std::memory_order_relaxed) || stop();
+        });
+        consumerWaiters_.fetch_sub(1, std::memory_order_relaxed);
+
+        // 元素可能已被其它消费者取走，此时继续重试
+        return canPop() || !(closed_.load(std::memory_order_relaxed) || stop());
+    }
+
+    /**
+     * @brief 最多休眠到 deadline，直到可能有元素可读
+     *
+     * @return true 应重试出队
+     * @return false 超时、队列已关闭且为空，或停止条件成立
+     */
+    template <typename Stop>
+    bool waitForItemsUntil(std::chrono::steady_clock::time_point deadline, Stop& stop) {
+        if constexpr (std::is_same<typename std::decay<Stop>::type, CancellationToken>::value) {
+            deadline = std::min(deadline, stop.getDeadline());
+        }
+        CancellationRegistration wake = wakeOnCancel(stop, notEmpty_);
+        std::unique_lock<std::mutex> lock(mutex_);
+        consumerWaiters_.fetch_add(1, std::memory_order_seq_cst);
+        bool ready = notEmpty_.wait_until(lock, deadline, [this, &stop]() {
+            return canPop() || closed_.load(std::memory_order_relaxed) || stop();
+        });
+        consumerWaiters_.fetch_sub(1, std::memory_order_relaxed);
+        return ready && canPop();
+    }
+
+    /**
+     * @brief 停止条件是取消令牌时，注册在取消时唤醒等待方的回调
+     *
+     * 必须在获取 mutex_ 之前调用：令牌已取消时回调立即执行。
+     */
+    template <typename Stop>
+    CancellationRegistration wakeOnCancel(Stop& stop, std::condition_variable& condition) {
+        if constexpr (std::is_same<typename std::decay<Stop>::type, CancellationToken>::value) {
+            return stop.onCancel([this, &condition]() {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                }
+                condition.notify_all();
+            });
+        } else {
+            (void)stop;
+            (void)condition;
+            return CancellationRegistration();
+        }
+    }
+
+    /**
+     * @brief 在条件变量上等待，停止条件是带截止时间的取消令牌时最多等到截止时间
+     */
+    template <typename Stop, typename Predicate>
+    static void waitWithStop(std::condition_variable& condition, std::unique_lock<std::mutex>& lock, Stop& stop,
+                             Predicate ready) {
+        if constexpr (std::is_same<typename std::decay<Stop>::type, CancellationToken>::value) {
+            if (stop.hasDeadline()) {
+                condition.wait_until(lock, stop.getDeadline(), ready);
+                return;
+            }
+        }
+        (void)stop;
+        condition.wait(lock, ready);
+    }
+
+    void notifyConsumers() {
+        if (consumerWaiters_.load(std::memory_order_seq_cst) > 0) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+            }
+            notEmpty_.notify_one();
+        }
+    }
+
+    void notifyProducers() {
+        if (producerWaiters_.load(std::memory_order_seq_cst) > 0) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+            }
+            notFull_.notify_one();
+        }
+    }
+};
+
+} // namespace thread_framework
+
+#endif // MPMC_QUEUE_H
@@ -0,0 +1,240 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include "ThreadPool.h"
+#include "Counters.h"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+/**
+ * @file ParallelFor.h
+ * @brief 并行循环和并行归约
+ *
+ * ThreadManager::parallelFor() 和 ThreadManager::parallelReduce() 的实现。
+ * 区间按需拆分：执行中的任务每处理完一个粒度，如果本地队列已经空了（任务被窃取走了），
+ * 就把剩余区间的后一半拆成新任务留给空闲线程；没有空闲线程时不会产生多余的任务。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+namespace detail {
+template <typename Body>
+class ParallelLoop;
+} // namespace detail
+
+/**
+ * @brief 并行循环的进度
+ *
+ * 可以在其它线程中随时读取，计数以块为单位更新。完成计数按线程分片，
+ * 各池线程更新进度时不争用同一缓存行，读取时求和。
+ */
+class ParallelProgress {
+public:
+    /**
+     * @brief 获取总迭代次数
+     */
+    size_t getTotal() const {
+        return total_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 获取已完成的迭代次数
+     */
+    size_t getCompleted() const {
+        return static_cast<size_t>(completed_.load());
+    }
+
+    /**
+     * @brief 获取完成比例
+     *
+     * @return double 0.0 到 1.0 之间的完成比例，空区间返回1.0
+     */
+    double getProgress() const {
+        size_t total = getTotal();
+        return total == 0 ? 1.0 : static_cast<double>(getCompleted()) / static_cast<double>(total);
+    }
+
+    /**
+     * @brief 是否已全部完成
+     */
+    bool isDone() const {
+        return getCompleted() >= getTotal();
+    }
+
+private:
+    template <typename>
+    friend class detail::ParallelLoop;
+
+    std::atomic<size_t> total_{0};
+    ShardedCounter completed_;
+
+    void reset(size_t total) {
+        completed_.reset();
+        total_.store(total, std::memory_order_relaxed);
+    }
+
+    void advance(size_t count) {
+        completed_.add(count);
+    }
+};
+
+namespace detail {
+
+/**
+ * @brief 一次并行循环的共享状态，存放在调用方的栈上
+ *
+ * 调用方在所有区间任务结束之前不会返回，任务可以安全地引用它。
+ *
+ * @tparam Body 块处理函数，参数为 (size_t begin, size_t end)
+ */
+template <typename Body>
+class ParallelLoop {
+public:
+    ParallelLoop(ThreadPool& pool, size_t grain, Body& body, ParallelProgress* progress)
+        : pool_(pool), grain_(grain), body_(body), progress_(progress) {}
+
+    ParallelLoop(const ParallelLoop&) = delete;
+    ParallelLoop& operator=(const ParallelLoop&) = delete;
+
+    /**
+     * @brief 执行区间 [begin, end)，等待期间帮助执行线程池中的任务
+     *
+     * 任何块抛出的第一个异常在所有任务结束后重新抛出。
+     */
+    void run(size_t begin, size_t end) {
+        if (progress_) {
+            progress_->reset(end - begin);
+        }
+        spawn(begin, end);
+
+        while (pending_.load(std::memory_order_acquire) != 0) {
+            if (pool_.runPendingTask()) {
+                continue;
+            }
+            // 剩余任务都在其它线程上执行，短暂等待后再尝试帮助
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait_for(lock, std::chrono::milliseconds(1), [this]() {
+                return pending_.load(std::memory_order_acquire) == 0;
+            });
+        }
+
+        // 等最后一个任务释放锁之后才能销毁共享状态
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+private:
+    /**
+     * @brief 区间任务
+     */
+    class RangeTask : public PoolTask {
+    public:
+        RangeTask(ParallelLoop* loop, size_t begin, size_t end) : loop_(loop), begin_(begin), end_(end) {}
+
+        void execute() override {
+            loop_->execute(begin_, end_);
+        }
+
+    private:
+        ParallelLoop* loop_;
+        size_t begin_;
+        size_t end_;
+    };
+
+    ThreadPool& pool_;
+    size_t grain_;
+    Body& body_;
+    ParallelProgress* progress_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<bool> failed_{false};
+    std::exception_ptr error_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+
+    void spawn(size_t begin, size_t end) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        pool_.submit(static_cast<PoolTask*>(new RangeTask(this, begin, end)));
+    }
+
+    void execute(size_t begin, size_t end) {
+        while (begin < end && !failed_.load(std::memory_order_relaxed)) {
+            // 本地队列为空说明拆出去的任务已被窃取，继续为空闲线程拆分
+            if (end - begin > 2 * grain_ && pool_.getLocalPendingCount() == 0) {
+                size_t middle = begin + (end - begin) / 2;
+                spawn(middle, end);
+                end = middle;
+                continue;
+            }
+
+            size_t chunkEnd = std::min(end, begin + grain_);
+            try {
+                body_(begin, chunkEnd);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                failed_.store(true, std::memory_order_relaxed);
+            }
+            if (progress_) {
+                progress_->advance(chunkEnd - begin);
+            }
+            begin = chunkEnd;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            condition_.notify_all();
+        }
+    }
+};
+
+/**
+ * @brief 根据区间大小和线程数选择默认粒度
+ */
+inline size_t defaultGrain(size_t count, size_t threadCount) {
+    size_t pieces = std::max<size_t>(1, threadCount) * 32;
+    return std::max<size_t>(1, count / pieces);
+}
+
+/**
+ * @brief 在线程池上执行并行循环
+ */
+template <typename Body>
+void runParallelLoop(ThreadPool& pool, size_t begin, size_t end, size_t grain, Body& body,
+                     ParallelProgress* progress) {
+    if (end < begin) {
+        end = begin;
+    }
+    if (grain == 0) {
+        grain = defaultGrain(end - begin, pool.getThreadCount());
+    }
+
+    ParallelLoop<Body> loop(pool, grain, body, progress);
+    loop.run(begin, end);
+}
+
+/**
+ * @brief 按池线程分开存放的部分归约结果，按缓存行对齐避免伪共享
+ */
+template <typename T>
+struct alignas(64) ReducePartial {
+    T value;
+};
+
+} // namespace detail
+
+} // namespace thread_framework
+
+#endif // PARALLEL_FOR_H
@@ -0,0 +1,846 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "ThreadManager.h"
+#include "MPMCQueue.h"
+#include "Logger.h"
+#include "Counters.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @file Pipeline.h
+ * @brief 多阶段流式处理管道
+ *
+ * 阶段之间用有界 MPMC 队列连接，每个阶段由若干个工作者线程组成，按微批（最多 K 个元素
+ * 或等待 T 微秒）从输入队列取元素。输出队列满时阶段阻塞在 emit() 上，背压一直传递到源头，
+ * 慢的下游会让上游减速而不是让内存增长。每个阶段统计吞吐、忙碌时间、被背压阻塞的时间和
+ * 输入队列占用，用来找出瓶颈阶段。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+class Pipeline;
+
+template <typename T>
+class PipelineBuilder;
+
+/**
+ * @brief 阶段选项
+ */
+struct StageOptions {
+    size_t parallelism = 1;                          ///< 阶段的工作者线程数
+    size_t batchSize = 1;                            ///< 每批最多处理的元素数（K）
+    std::chrono::microseconds maxBatchDelay{0};      ///< 取到第一个元素后最多等待多久凑满一批（T），0表示有多少取多少
+    size_t capacity = 1024;                          ///< 输出队列容量，源和普通阶段有效
+
+    StageOptions() = default;
+    StageOptions(size_t workers, size_t batch = 1, std::chrono::microseconds delay = std::chrono::microseconds(0),
+                 size_t queueCapacity = 1024)
+        : parallelism(workers), batchSize(batch), maxBatchDelay(delay), capacity(queueCapacity) {}
+};
+
+/**
+ * @brief 单个阶段的统计信息
+ *
+ * 计数按批更新，读取时不阻塞阶段。源阶段没有输入队列，queueDepth 和 queueCapacity 为0。
+ */
+struct PipelineStageStats {
+    std::string name;             ///< 阶段名称
+    size_t parallelism = 0;       ///< 工作者线程数
+    size_t activeWorkers = 0;     ///< 仍在运行的工作者数
+    uint64_t itemsIn = 0;         ///< 处理的输入元素数
+    uint64_t itemsOut = 0;        ///< 发出的元素数
+    uint64_t batches = 0;         ///< 处理的批次数
+    uint64_t errors = 0;          ///< 处理函数抛出异常的批次数
+    uint64_t busyNs = 0;          ///< 在处理函数中的总时长（纳秒，包含被背压阻塞的时间）
+    uint64_t blockedNs = 0;       ///< 输出队列满时阻塞在 emit() 上的总时长（纳秒）
+    size_t queueDepth = 0;        ///< 输入队列中的元素数（近似值）
+    size_t queueCapacity = 0;     ///< 输入队列容量
+    double itemsPerSecond = 0.0;  ///< 自启动以来的平均吞吐（源阶段按发出的元素计算）
+
+    /**
+     * @brief 获取平均批大小
+     */
+    double getAverageBatchSize() const {
+        return batches == 0 ? 0.0 : static_cast<double>(itemsIn) / static_cast<double>(batches);
+    }
+
+    /**
+     * @brief 获取输入队列占用比例
+     */
+    double getQueueOccupancy() const {
+        return queueCapacity == 0 ? 0.0 : static_cast<double>(queueDepth) / static_cast<double>(queueCapacity);
+    }
+};
+
+/**
+ * @brief 管道统计信息
+ */
+struct PipelineStats {
+    double elapsedSeconds = 0.0;              ///< 自启动以来的时长
+    std::vector<PipelineStageStats> stages;   ///< 按声明顺序排列的阶段统计
+
+    /**
+     * @brief 找出瓶颈阶段
+     *
+     * 按每个工作者的有效忙碌比例（忙碌时间减去被背压阻塞的时间）判断，
+     * 瓶颈阶段的输入队列通常接近满而输出队列接近空。
+     *
+     * @return size_t 瓶颈阶段的下标，没有阶段时返回 SIZE_MAX
+     */
+    size_t getBottleneck() const {
+        size_t bottleneck = SIZE_MAX;
+        double highest = -1.0;
+        for (size_t i = 0; i < stages.size(); ++i) {
+            const PipelineStageStats& stage = stages[i];
+            double work = static_cast<double>(stage.busyNs > stage.blockedNs ? stage.busyNs - stage.blockedNs : 0);
+            double utilization = work / static_cast<double>(std::max<size_t>(1, stage.parallelism));
+            if (utilization > highest) {
+                highest = utilization;
+                bottleneck = i;
+            }
+        }
+        return bottleneck;
+    }
+};
+
+namespace detail {
+
+/**
+ * @brief 管道的共享状态，工作者持有引用，管道对象销毁后仍然有效
+ */
+struct PipelineCore {
+    std::atomic<bool> stopping{false};
+    std::mutex mutex;
+    std::condition_variable condition;
+    size_t runningWorkers = 0;
+    std::chrono::steady_clock::time_point startTime;
+};
+
+/**
+ * @brief 与元素类型无关的阶段状态和计数
+ */
+class PipelineStageBase {
+public:
+    PipelineStageBase(std::string name, const StageOptions& options)
+        : name_(std::move(name)), options_(options) {
+        if (options_.parallelism == 0) {
+            options_.parallelism = 1;
+        }
+        if (options_.batchSize == 0) {
+            options_.batchSize = 1;
+        }
+        counters_.reset(new WorkerCounters[options_.parallelism]);
+    }
+
+    virtual ~PipelineStageBase() = default;
+
+    PipelineStageBase(const PipelineStageBase&) = delete;
+    PipelineStageBase& operator=(const PipelineStageBase&) = delete;
+
+    /**
+     * @brief 工作者的处理循环
+     *
+     * @param index 工作者在阶段内的序号
+     * @param proceed 返回 false 时工作者应退出（停止请求或管道停止）；会处理暂停请求
+     * @param stop 不阻塞的停止条件，用于队列等待
+     */
+    virtual void runWorker(size_t index, const std::function<bool()>& proceed,
+                           const std::function<bool()>& stop) = 0;
+
+    /**
+     * @brief 关闭输出队列，下游处理完剩余元素后结束
+     */
+    virtual void closeOutput() = 0;
+
+    /**
+     * @brief 唤醒阻塞在输入或输出队列上的工作者
+     */
+    virtual void wake() = 0;
+
+    virtual size_t inputDepth() const = 0;
+    virtual size_t inputCapacity() const = 0;
+
+    /**
+     * @brief 源阶段的吞吐按发出的元素计算
+     */
+    virtual bool isSource() const {
+        return false;
+    }
+
+    const std::string& getName() const {
+        return name_;
+    }
+
+    const StageOptions& getOptions() const {
+        return options_;
+    }
+
+    /**
+     * @brief 在创建工作者之前计入 count 个工作者
+     */
+    void workersStarting(size_t count) {
+        activeWorkers_.fetch_add(count);
+    }
+
+    /**
+     * @brief count 个工作者结束（或未能启动），最后一个结束的工作者关闭输出队列
+     */
+    void workersFinished(size_t count = 1) {
+        if (count > 0 && activeWorkers_.fetch_sub(count) == count) {
+            closeOutput();
+        }
+    }
+
+    /**
+     * @brief 记录一批的处理结果
+     *
+     * 每个工作者只写自己的计数槽，同一阶段的工作者之间不争用缓存行。
+     *
+     * @param index 工作者在阶段内的序号
+     */
+    void recordBatch(size_t index, size_t itemsIn, size_t itemsOut, uint64_t busyNs, uint64_t blockedNs,
+                     bool failed) {
+        WorkerCounters& counters = counters_[index];
+        counters.itemsIn.add(itemsIn);
+        counters.itemsOut.add(itemsOut);
+        counters.batches.add(1);
+        counters.busyNs.add(busyNs);
+        counters.blockedNs.add(blockedNs);
+        if (failed) {
+            counters.errors.add(1);
+        }
+    }
+
+    PipelineStageStats getStats(double elapsedSeconds) const {
+        PipelineStageStats stats;
+        stats.name = name_;
+        stats.parallelism = options_.parallelism;
+        stats.activeWorkers = activeWorkers_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < options_.parallelism; ++i) {
+            const WorkerCounters& counters = counters_[i];
+            stats.itemsIn += counters.itemsIn.load();
+            stats.itemsOut += counters.itemsOut.load();
+            stats.batches += counters.batches.load();
+            stats.errors += counters.errors.load();
+            stats.busyNs += counters.busyNs.load();
+            stats.blockedNs += counters.blockedNs.load();
+        }
+        stats.queueDepth = inputDepth();
+        stats.queueCapacity = inputCapacity();
+        uint64_t items = isSource() ? stats.itemsOut : stats.itemsIn;
+        stats.itemsPerSecond = elapsedSeconds > 0 ? static_cast<double>(items) / elapsedSeconds : 0.0;
+        return stats;
+    }
+
+private:
+    std::string name_;
+    StageOptions options_;
+    std::atomic<size_t> activeWorkers_{0};
+
+    /**
+     * @brief 单个工作者的计数，独占缓存行
+     */
+    struct alignas(64) WorkerCounters {
+        OwnedCounter<uint64_t> itemsIn;
+        OwnedCounter<uint64_t> itemsOut;
+        OwnedCounter<uint64_t> batches;
+        OwnedCounter<uint64_t> errors;
+        OwnedCounter<uint64_t> busyNs;
+        OwnedCounter<uint64_t> blockedNs;
+    };
+
+    std::unique_ptr<WorkerCounters[]> counters_; ///< 按工作者序号索引
+};
+
+inline uint64_t elapsedNs(std::chrono::steady_clock::time_point since) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since).count());
+}
+
+} // namespace detail
+
+/**
+ * @brief 阶段的输出端
+ *
+ * emit() 把元素放入下游队列，队列满时阻塞（背压），管道停止时返回 false。
+ * 只在处理函数内使用，不能跨线程共享。
+ *
+ * @tparam T 输出元素类型
+ */
+template <typename T>
+class StageOutput {
+public:
+    StageOutput(MPMCQueue<T>& channel, const std::function<bool()>& stop, size_t workerIndex)
+        : channel_(channel), stop_(stop), workerIndex_(workerIndex) {}
+
+    StageOutput(const StageOutput&) = delete;
+    StageOutput& operator=(const StageOutput&) = delete;
+
+    /**
+     * @brief 发出一个元素
+     *
+     * @param item 元素
+     * @return true 已放入下游队列
+     * @return false 管道正在停止或下游已关闭，应尽快返回
+     */
+    bool emit(T item) {
+        if (channel_.tryPush(std::move(item))) {
+            emitted_++;
+            return true;
+        }
+        // tryPush 失败时 item 保持不变，阻塞等待下游腾出空间
+        auto start = std::chrono::steady_clock::now();
+        bool pushed = channel_.push(std::move(item), stop_);
+        blockedNs_ += detail::elapsedNs(start);
+        if (pushed) {
+            emitted_++;
+        }
+        return pushed;
+    }
+
+    /**
+     * @brief 管道是否正在停止
+     */
+    bool isStopping() const {
+        return stop_();
+    }
+
+    /**
+     * @brief 获取工作者在阶段内的序号，可用于划分源的数据
+     */
+    size_t getWorkerIndex() const {
+        return workerIndex_;
+    }
+
+    /**
+     * @brief 取出本批次的计数并清零
+     */
+    void takeCounts(size_t& emitted, uint64_t& blockedNs) {
+        emitted = emitted_;
+        blockedNs = blockedNs_;
+        emitted_ = 0;
+        blockedNs_ = 0;
+    }
+
+private:
+    MPMCQueue<T>& channel_;
+    const std::function<bool()>& stop_;
+    size_t workerIndex_;
+    size_t emitted_ = 0;
+    uint64_t blockedNs_ = 0;
+};
+
+namespace detail {
+
+/**
+ * @brief 源阶段：每个工作者调用一次生产函数，全部返回后关闭输出队列
+ */
+template <typename Out>
+class SourceStage : public PipelineStageBase {
+public:
+    using Function = std::function<void(StageOutput<Out>&)>;
+
+    SourceStage(std::string name, const StageOptions& options, Function function,
+                std::shared_ptr<MPMCQueue<Out>> output)
+        : PipelineStageBase(std::move(name), options), function_(std::move(function)), output_(std::move(output)) {}
+
+    void runWorker(size_t index, const std::function<bool()>& proceed, const std::function<bool()>& stop) override {
+        if (!proceed()) {
+            return;
+        }
+        StageOutput<Out> out(*output_, stop, index);
+        auto start = std::chrono::steady_clock::now();
+        bool failed = false;
+        try {
+            function_(out);
+        } catch (const std::exception& e) {
+            TF_LOG_ERROR("[Pipeline] Source '", getName(), "' failed: ", e.what());
+            failed = true;
+        }
+        size_t emitted = 0;
+        uint64_t blocked = 0;
+        out.takeCounts(emitted, blocked);
+        recordBatch(index, 0, emitted, elapsedNs(start), blocked, failed);
+    }
+
+    void closeOutput() override {
+        output_->close();
+    }
+
+    void wake() override {
+        output_->wakeProducers();
+    }
+
+    size_t inputDepth() const override {
+        return 0;
+    }
+
+    size_t inputCapacity() const override {
+        return 0;
+    }
+
+    bool isSource() const override {
+        return true;
+    }
+
+private:
+    Function function_;
+    std::shared_ptr<MPMCQueue<Out>> output_;
+};
+
+/**
+ * @brief 处理阶段的函数类型和输出队列类型
+ */
+template <typename In, typename Out>
+struct StageFunction {
+    using type = std::function<void(std::vector<In>&, StageOutput<Out>&)>;
+    using Queue = MPMCQueue<Out>;
+};
+
+template <typename In>
+struct StageFunction<In, void> {
+    using type = std::function<void(std::vector<In>&)>;
+    using Queue = MPMCQueue<char>; ///< 汇阶段没有输出队列，只占位
+};
+
+/**
+ * @brief 处理阶段：按微批从输入队列取元素，处理结果发往输出队列
+ *
+ * Out 为 void 时是汇（sink），没有输出队列。
+ */
+template <typename In, typename Out>
+class ProcessStage : public PipelineStageBase {
+public:
+    using Function = typename StageFunction<In, Out>::type;
+    using OutQueue = typename StageFunction<In, Out>::Queue;
+
+    ProcessStage(std::string name, const StageOptions& options, Function function,
+                 std::shared_ptr<MPMCQueue<In>> input, std::shared_ptr<OutQueue> output)
+        : PipelineStageBase(std::move(name), options), function_(std::move(function)), input_(std::move(input)),
+          output_(std::move(output)) {}
+
+    void runWorker(size_t index, const std::function<bool()>& proceed, const std::function<bool()>& stop) override {
+        const StageOptions& options = getOptions();
+        std::vector<In> batch;
+        batch.reserve(options.batchSize);
+
+        if constexpr (std::is_void<Out>::value) {
+            while (proceed()) {
+                batch.clear();
+                size_t count = input_->popBulkFor(batch, options.batchSize, options.maxBatchDelay, stop);
+                if (count == 0) {
+                    if (input_->isClosed() && input_->empty()) {
+                        break;
+                    }
+                    continue;
+                }
+                auto start = std::chrono::steady_clock::now();
+                bool failed = invoke([&]() { function_(batch); });
+                recordBatch(index, count, 0, elapsedNs(start), 0, failed);
+            }
+        } else {
+            StageOutput<Out> out(*output_, stop, index);
+            while (proceed()) {
+                batch.clear();
+                size_t count = input_->popBulkFor(batch, options.batchSize, options.maxBatchDelay, stop);
+                if (count == 0) {
+                    if (input_->isClosed() && input_->empty()) {
+                        break;
+                    }
+                    continue;
+                }
+                auto start = std::chrono::steady_clock::now();
+                bool failed = invoke([&]() { function_(batch, out); });
+                size_t emitted = 0;
+                uint64_t blocked = 0;
+                out.takeCounts(emitted, blocked);
+                recordBatch(index, count, emitted, elapsedNs(start), blocked, failed);
+            }
+        }
+    }
+
+    void closeOutput() override {
+        if constexpr (!std::is_void<Out>::value) {
+            output_->close();
+        }
+    }
+
+    void wake() override {
+        input_->wakeConsumers();
+        if constexpr (!std::is_void<Out>::value) {
+            output_->wakeProducers();
+        }
+    }
+
+    size_t inputDepth() const override {
+        return input_->size();
+    }
+
+    size_t inputCapacity() const override {
+        return input_->capacity();
+    }
+
+private:
+    Function function_;
+    std::shared_ptr<MPMCQueue<In>> input_;
+    std::shared_ptr<OutQueue> output_;
+
+    /**
+     * @brief 调用处理函数，异常记入错误计数，本批剩余元素丢弃
+     */
+    template <typename F>
+    bool invoke(F&& call) {
+        try {
+            call();
+            return false;
+        } catch (const std::exception& e) {
+            TF_LOG_ERROR("[Pipeline] Stage '", getName(), "' failed: ", e.what());
+            return true;
+        }
+    }
+};
+
+/**
+ * @brief 运行一个阶段工作者的线程工作者
+ */
+class PipelineStageWorker : public IThreadWorker {
+public:
+    PipelineStageWorker(std::shared_ptr<PipelineCore> core, std::shared_ptr<PipelineStageBase> stage, size_t index)
+        : core_(std::move(core)), stage_(std::move(stage)), index_(index) {}
+
+    void run() override {
+        setState(ThreadState::RUNNING);
+
+        std::function<bool()> stop = [this]() {
+            return isStopRequested() || core_->stopping.load(std::memory_order_relaxed);
+        };
+        std::function<bool()> proceed = [this]() {
+            return shouldContinue() && !core_->stopping.load(std::memory_order_relaxed);
+        };
+        stage_->runWorker(index_, proceed, stop);
+
+        stage_->workersFinished();
+        {
+            std::lock_guard<std::mutex> lock(core_->mutex);
+            core_->runningWorkers--;
+        }
+        core_->condition.notify_all();
+        setState(ThreadState::FINISHED);
+    }
+
+    /**
+     * @brief 停止时唤醒阻塞在队列上的工作者
+     */
+    void onStop() override {
+        stage_->wake();
+    }
+
+    std::string getType() const override {
+        return "PipelineStage";
+    }
+
+    std::string getDescription() const override {
+        return "Pipeline stage '" + stage_->getName() + "' worker " + std::to_string(index_);
+    }
+
+private:
+    std::shared_ptr<PipelineCore> core_;
+    std::shared_ptr<PipelineStageBase> stage_;
+    size_t index_;
+};
+
+} // namespace detail
+
+/**
+ * @brief 多阶段流式处理管道
+ *
+ * 用 source() 或 from() 开始，依次添加 map()/stage()，以 sink() 结束，然后 start()。
+ * 源全部返回（或 from() 的外部队列关闭）后，各阶段处理完剩余元素依次结束；stop() 立即停止所有阶段，
+ * 队列中剩余的元素被丢弃。阶段工作者运行在线程管理器的独占线程上。
+ *
+ * @code
+ * Pipeline pipeline("ingest");
+ * pipeline.source<std::string>("read", [&](StageOutput<std::string>& out) {
+ *         std::string line;
+ *         while (std::getline(input, line) && out.emit(line)) {}
+ *     })
+ *     .map<Record>("parse", [](std::string& line) { return parse(line); }, StageOptions(4))
+ *     .sink("store", [&](std::vector<Record>& batch) { db.insert(batch); },
+ *           StageOptions(1, 256, std::chrono::microseconds(500)));
+ * pipeline.start(manager);
+ * pipeline.wait();
+ * @endcode
+ */
+class Pipeline {
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param name 管道名称，用作工作者名称的前缀
+     */
+    explicit Pipeline(std::string name = "pipeline")
+        : name_(std::move(name)), core_(std::make_shared<detail::PipelineCore>()) {}
+
+    /**
+     * @brief 析构函数，停止并等待所有阶段工作者结束
+     */
+    ~Pipeline() {
+        if (started_) {
+            stop();
+            wait();
+        }
+    }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    /**
+     * @brief 添加源阶段
+     *
+     * @tparam T 输出元素类型
+     * @param name 阶段名称
+     * @param produce 生产函数，每个工作者调用一次，通过 emit() 发出元素，返回表示该工作者的数据已发完
+     * @param options 阶段选项，batchSize 和 maxBatchDelay 不适用
+     * @return PipelineBuilder<T> 用于添加下一个阶段
+     */
+    template <typename T, typename F>
+    PipelineBuilder<T> source(const std::string& name, F&& produce, const StageOptions& options = StageOptions()) {
+        auto output = std::make_shared<MPMCQueue<T>>(std::max<size_t>(1, options.capacity));
+        addStage(std::make_shared<detail::SourceStage<T>>(name, options, std::forward<F>(produce), output));
+        return PipelineBuilder<T>(*this, std::move(output));
+    }
+
+    /**
+     * @brief 从外部队列开始
+     *
+     * 外部生产者向队列写入元素，关闭队列表示数据结束。
+     *
+     * @param channel 输入队列
+     * @return PipelineBuilder<T> 用于添加第一个阶段
+     */
+    template <typename T>
+    PipelineBuilder<T> from(std::shared_ptr<MPMCQueue<T>> channel) {
+        return PipelineBuilder<T>(*this, std::move(channel));
+    }
+
+    /**
+     * @brief 启动所有阶段的工作者
+     *
+     * @param manager 线程管理器，必须比管道活得更久
+     * @return true 启动成功
+     * @return false 已经启动过、没有阶段、最后一个阶段不是 sink()，或创建工作者失败（已启动的工作者会被停止）
+     */
+    bool start(ThreadManager& manager) {
+        if (started_ || stages_.empty() || !terminated_) {
+            TF_LOG_ERROR("[Pipeline] '", name_, "' cannot start: already started, empty or missing sink");
+            return false;
+        }
+        started_ = true;
+        core_->startTime = std::chrono::steady_clock::now();
+
+        // 先计入所有阶段的全部工作者再逐个创建：先启动的工作者很快结束时，
+        // 不会在同阶段的其它工作者计入之前把计数减到0并关闭下游队列
+        size_t total = 0;
+        for (const auto& stage : stages_) {
+            stage->workersStarting(stage->getOptions().parallelism);
+            total += stage->getOptions().parallelism;
+        }
+        {
+            std::lock_guard<std::mutex> lock(core_->mutex);
+            core_->runningWorkers += total;
+        }
+
+        for (size_t s = 0; s < stages_.size(); ++s) {
+            const auto& stage = stages_[s];
+            for (size_t i = 0; i < stage->getOptions().parallelism; ++i) {
+                auto worker = std::make_unique<detail::PipelineStageWorker>(core_, stage, i);
+                std::string workerName = name_ + "/" + stage->getName() + "#" + std::to_string(i);
+                if (manager.createThreadWithWorker(std::move(worker), workerName) == SIZE_MAX) {
+                    // 撤销从未启动的工作者的计数：本阶段从 i 开始的工作者和之后各阶段的全部工作者
+                    stop();
+                    size_t unstarted = stage->getOptions().parallelism - i;
+                    stage->workersFinished(unstarted);
+                    for (size_t rest = s + 1; rest < stages_.size(); ++rest) {
+                        size_t count = stages_[rest]->getOptions().parallelism;
+                        stages_[rest]->workersFinished(count);
+                        unstarted += count;
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(core_->mutex);
+                        core_->runningWorkers -= unstarted;
+                    }
+                    core_->condition.notify_all();
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief 立即停止所有阶段，队列中剩余的元素被丢弃
+     */
+    void stop() {
+        core_->stopping.store(true);
+        for (const auto& stage : stages_) {
+            stage->wake();
+        }
+    }
+
+    /**
+     * @brief 等待所有阶段工作者结束
+     */
+    void wait() {
+        std::unique_lock<std::mutex> lock(core_->mutex);
+        core_->condition.wait(lock, [this]() { return core_->runningWorkers == 0; });
+    }
+
+    /**
+     * @brief 等待所有阶段工作者结束，最多等待指定时长
+     *
+     * @return true 已全部结束
+     * @return false 超时
+     */
+    template <typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& timeout) {
+        std::unique_lock<std::mutex> lock(core_->mutex);
+        return core_->condition.wait_for(lock, timeout, [this]() { return core_->runningWorkers == 0; });
+    }
+
+    /**
+     * @brief 是否所有阶段工作者都已结束
+     */
+    bool isFinished() const {
+        std::lock_guard<std::mutex> lock(core_->mutex);
+        return started_ && core_->runningWorkers == 0;
+    }
+
+    /**
+     * @brief 获取各阶段的统计信息
+     */
+    PipelineStats getStats() const {
+        PipelineStats stats;
+        if (started_) {
+            stats.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                                 core_->startTime).count();
+        }
+        stats.stages.reserve(stages_.size());
+        for (const auto& stage : stages_) {
+            stats.stages.push_back(stage->getStats(stats.elapsedSeconds));
+        }
+        return stats;
+    }
+
+    const std::string& getName() const {
+        return name_;
+    }
+
+private:
+    template <typename>
+    friend class PipelineBuilder;
+
+    std::string name_;
+    std::shared_ptr<detail::PipelineCore> core_;
+    std::vector<std::shared_ptr<detail::PipelineStageBase>> stages_;
+    bool started_ = false;
+    bool terminated_ = false; ///< 是否已添加 sink
+
+    void addStage(std::shared_ptr<detail::PipelineStageBase> stage) {
+        stages_.push_back(std::move(stage));
+        terminated_ = false;
+    }
+};
+
+/**
+ * @brief 管道构建器，表示类型为 T 的阶段输出
+ *
+ * @tparam T 上一个阶段的输出元素类型
+ */
+template <typename T>
+class PipelineBuilder {
+public:
+    PipelineBuilder(Pipeline& pipeline, std::shared_ptr<MPMCQueue<T>> channel)
+        : pipeline_(&pipeline), channel_(std::move(channel)) {}
+
+    /**
+     * @brief 添加批处理阶段
+     *
+     * @tparam Out 输出元素类型
+     * @param name 阶段名称
+     * @param process 处理函数，参数为 (std::vector<T>& batch, StageOutput<Out>& out)，可以发出任意数量的元素
+     * @param options 阶段选项
+     * @return PipelineBuilder<Out> 用于添加下一个阶段
+     */
+    template <typename Out, typename F>
+    PipelineBuilder<Out> stage(const std::string& name, F&& process, const StageOptions& options = StageOptions()) {
+        auto output = std::make_shared<MPMCQueue<Out>>(std::max<size_t>(1, options.capacity));
+        pipeline_->addStage(std::make_shared<detail::ProcessStage<T, Out>>(name, options, std::forward<F>(process),
+                                                                           channel_, output));
+        return PipelineBuilder<Out>(*pipeline_, std::move(output));
+    }
+
+    /**
+     * @brief 添加逐元素转换阶段
+     *
+     * @tparam Out 输出元素类型
+     * @param name 阶段名称
+     * @param transform 转换函数，参数为 T&，返回 Out
+     * @param options 阶段选项
+     * @return PipelineBuilder<Out> 用于添加下一个阶段
+     */
+    template <typename Out, typename F>
+    PipelineBuilder<Out> map(const std::string& name, F&& transform, const StageOptions& options = StageOptions()) {
+        return stage<Out>(name,
+                          [transform = std::forward<F>(transform)](std::vector<T>& batch, StageOutput<Out>& out) {
+                              for (T& item : batch) {
+                                  if (!out.emit(transform(item))) {
+                                      return;
+                                  }
+                              }
+                          },
+                          options);
+    }
+
+    /**
+     * @brief 添加汇阶段，结束管道
+     *
+     * @param name 阶段名称
+     * @param consume 处理函数，参数为 std::vector<T>& batch
+     * @param options 阶段选项，capacity 不适用
+     */
+    template <typename F>
+    void sink(const std::string& name, F&& consume, const StageOptions& options = StageOptions()) {
+        pipeline_->addStage(std::make_shared<detail::ProcessStage<T, void>>(name, options, std::forward<F>(consume),
+                                                                            channel_, nullptr));
+        pipeline_->terminated_ = true;
+    }
+
+    /**
+     * @brief 获取输出队列
+     */
+    const std::shared_ptr<MPMCQueue<T>>& getChannel() const {
+        return channel_;
+    }
+
+private:
+    Pipeline* pipeline_;
+    std::shared_ptr<MPMCQueue<T>> channel_;
+};
+
+} // namespace thread_framework
+
+#endif // PIPELINE_H
@@ -0,0 +1,329 @@
+#ifndef SCRATCH_ARENA_H
+#define SCRATCH_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <vector>
+
+/**
+ * @file ScratchArena.h
+ * @brief 线程私有的临时内存（bump 分配器）
+ *
+ * 任务中的临时向量、缓冲区从当前线程的 ScratchArena 顺序分配，不进入通用分配器，也不需要逐个释放。
+ * 线程池在每个任务（以及共享定时服务的每次触发）前后建立 ScratchScope，任务结束时分配位置回退，
+ * 内存留给同一线程上的下一个任务复用，保留的容量超过上限时才归还。
+ *
+ * @code
+ * manager.submit([&input]() {
+ *     ScratchVector<int> tokens;          // 从当前线程的临时内存分配
+ *     tokens.reserve(input.size());
+ *     ...
+ * });                                     // 任务结束后内存自动回收
+ * @endcode
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief 按块增长的 bump 分配器
+ *
+ * 只能由一个线程使用。分配只移动当前块中的位置，内存按 mark()/rewind() 成批回收；
+ * 已申请的块在回退后保留，之后的分配按顺序复用。在其中构造的对象不会被析构，
+ * 需要析构的对象应在回退前自行销毁（ScratchVector 等容器在离开作用域时析构即可）。
+ */
+class ScratchArena {
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;         ///< 第一个块的大小
+    static constexpr size_t MAX_CHUNK_SIZE = 4 * 1024 * 1024;       ///< 块按倍数增长的上限，更大的请求单独成块
+    static constexpr size_t DEFAULT_RETAIN_BYTES = 1024 * 1024;     ///< 最外层作用域结束后保留的容量上限
+
+    /**
+     * @brief 分配位置，用于成批回退
+     */
+    struct Marker {
+        size_t chunk = 0;
+        size_t offset = 0;
+    };
+
+    /**
+     * @brief 构造函数
+     *
+     * @param retainBytes 最外层 ScratchScope 结束时保留的容量，超过时从最后一个块开始归还
+     */
+    explicit ScratchArena(size_t retainBytes = DEFAULT_RETAIN_BYTES) : retainBytes_(retainBytes) {}
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    /**
+     * @brief 当前线程的临时内存，线程退出时释放
+     */
+    static ScratchArena& local() {
+        thread_local ScratchArena arena;
+        return arena;
+    }
+
+    /**
+     * @brief 分配内存
+     *
+     * @param bytes 字节数
+     * @param alignment 对齐，必须是2的幂
+     * @return void* 内存地址，在回退到更早的位置之前有效
+     * @throws std::bad_alloc 无法申请新的块
+     */
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        if (current_ < chunks_.size()) {
+            void* result = bump(chunks_[current_], bytes, alignment);
+            if (result) {
+                return result;
+            }
+        }
+        return allocateSlow(bytes, alignment);
+    }
+
+    /**
+     * @brief 为 count 个 T 分配未初始化的内存
+     */
+    template <typename T>
+    T* allocateArray(size_t count) {
+        if (count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * @brief 获取当前分配位置
+     */
+    Marker mark() const {
+        return Marker{current_, offset_};
+    }
+
+    /**
+     * @brief 回退到之前的分配位置，之后分配的内存全部失效
+     */
+    void rewind(const Marker& marker) {
+        current_ = marker.chunk;
+        offset_ = marker.offset;
+    }
+
+    /**
+     * @brief 回退到起点，并把容量收缩到保留上限以内
+     *
+     * 不能在 ScratchScope 内调用。
+     */
+    void reset() {
+        rewind(Marker{});
+        trim(retainBytes_);
+    }
+
+    /**
+     * @brief 从最后一个块开始归还，直到容量不超过 bytes
+     *
+     * 只归还当前分配位置之后的块。
+     */
+    void trim(size_t bytes) {
+        while (capacity_ > bytes && !chunks_.empty() && chunks_.size() - 1 > current_) {
+            releaseLast();
+        }
+        if (capacity_ > bytes && chunks_.size() == 1 && current_ == 0 && offset_ == 0) {
+            releaseLast();
+        }
+    }
+
+    /**
+     * @brief 已申请的总容量（字节）
+     */
+    size_t getCapacity() const {
+        return capacity_;
+    }
+
+    /**
+     * @brief 已申请的块数
+     */
+    size_t getChunkCount() const {
+        return chunks_.size();
+    }
+
+    /**
+     * @brief 最外层作用域结束后保留的容量上限
+     */
+    size_t getRetainBytes() const {
+        return retainBytes_;
+    }
+
+    void setRetainBytes(size_t bytes) {
+        retainBytes_ = bytes;
+    }
+
+    /**
+     * @brief 当前嵌套的 ScratchScope 层数
+     */
+    size_t getScopeDepth() const {
+        return depth_;
+    }
+
+private:
+    friend class ScratchScope;
+
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    std::vector<Chunk> chunks_;
+    size_t current_ = 0;   ///< 正在分配的块，没有块时为0
+    size_t offset_ = 0;    ///< 当前块中已分配的字节数
+    size_t capacity_ = 0;
+    size_t retainBytes_;
+    size_t depth_ = 0;
+
+    /**
+     * @brief 在块中顺序分配，放不下时返回 nullptr
+     */
+    void* bump(const Chunk& chunk, size_t bytes, size_t alignment) {
+        uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data.get());
+        uintptr_t aligned = (base + offset_ + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        size_t end = static_cast<size_t>(aligned - base);
+        if (end > chunk.size || bytes > chunk.size - end) {
+            return nullptr;
+        }
+        offset_ = end + bytes;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    /**
+     * @brief 当前块放不下时移到下一个块，下一个块不够大或不存在时申请新块
+     */
+    void* allocateSlow(size_t bytes, size_t alignment) {
+        if (bytes > std::numeric_limits<size_t>::max() - alignment) {
+            throw std::bad_alloc();
+        }
+        size_t needed = bytes + alignment;
+        size_t next = chunks_.empty() ? 0 : current_ + 1;
+
+        if (next < chunks_.size() && chunks_[next].size < needed) {
+            capacity_ -= chunks_[next].size;
+            chunks_[next] = newChunk(growSize(needed));
+            capacity_ += chunks_[next].size;
+        } else if (next == chunks_.size()) {
+            chunks_.push_back(newChunk(growSize(needed)));
+            capacity_ += chunks_.back().size;
+        }
+
+        current_ = next;
+        offset_ = 0;
+        return bump(chunks_[current_], bytes, alignment);
+    }
+
+    /**
+     * @brief 新块的大小：上一个块的两倍，不超过 MAX_CHUNK_SIZE，至少容纳本次请求
+     */
+    size_t growSize(size_t needed) const {
+        size_t size = chunks_.empty() ? DEFAULT_CHUNK_SIZE : chunks_.back().size * 2;
+        if (size > MAX_CHUNK_SIZE) {
+            size = MAX_CHUNK_SIZE;
+        }
+        return size < needed ? needed : size;
+    }
+
+    static Chunk newChunk(size_t size) {
+        return Chunk{std::unique_ptr<char[]>(new char[size]), size};
+    }
+
+    void releaseLast() {
+        capacity_ -= chunks_.back().size;
+        chunks_.pop_back();
+    }
+};
+
+/**
+ * @brief 临时内存的作用域
+ *
+ * 构造时记录分配位置，析构时回退；最外层的作用域结束时把容量收缩到保留上限以内。
+ * 作用域可以嵌套，必须按构造的相反顺序销毁。线程池在执行每个任务时建立一层作用域。
+ */
+class ScratchScope {
+public:
+    explicit ScratchScope(ScratchArena& arena = ScratchArena::local()) : arena_(arena), marker_(arena.mark()) {
+        arena_.depth_++;
+    }
+
+    ~ScratchScope() {
+        arena_.rewind(marker_);
+        if (--arena_.depth_ == 0 && arena_.capacity_ > arena_.retainBytes_) {
+            arena_.trim(arena_.retainBytes_);
+        }
+    }
+
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+
+    ScratchArena& arena() const {
+        return arena_;
+    }
+
+private:
+    ScratchArena& arena_;
+    ScratchArena::Marker marker_;
+};
+
+/**
+ * @brief 从 ScratchArena 分配的标准库分配器
+ *
+ * 默认使用构造时所在线程的临时内存。deallocate() 不做任何事，内存在作用域回退时整体回收，
+ * 因此使用它的容器不能比创建它时所在的作用域（线程池中即当前任务）活得更久，也不能交给其它线程扩容。
+ *
+ * @tparam T 元素类型
+ */
+template <typename T>
+class ScratchAllocator {
+public:
+    using value_type = T;
+
+    ScratchAllocator() noexcept : arena_(&ScratchArena::local()) {}
+    explicit ScratchAllocator(ScratchArena& arena) noexcept : arena_(&arena) {}
+
+    template <typename U>
+    ScratchAllocator(const ScratchAllocator<U>& other) noexcept : arena_(other.getArena()) {}
+
+    T* allocate(size_t count) {
+        return arena_->allocateArray<T>(count);
+    }
+
+    void deallocate(T*, size_t) noexcept {}
+
+    ScratchArena* getArena() const noexcept {
+        return arena_;
+    }
+
+private:
+    ScratchArena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ScratchAllocator<T>& a, const ScratchAllocator<U>& b) noexcept {
+    return a.getArena() == b.getArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ScratchAllocator<T>& a, const ScratchAllocator<U>& b) noexcept {
+    return a.getArena() != b.getArena();
+}
+
+/**
+ * @brief 使用当前线程临时内存的向量
+ */
+template <typename T>
+using ScratchVector = std::vector<T, ScratchAllocator<T>>;
+
+} // namespace thread_framework
+
+#endif // SCRATCH_ARENA_H
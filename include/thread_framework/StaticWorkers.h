@@ -0,0 +1,266 @@
+#ifndef STATIC_WORKERS_H
+#define STATIC_WORKERS_H
+
+#include "BaseWorkers.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @file StaticWorkers.h
+ * @brief 编译期确定回调类型的工作者
+ *
+ * BaseWorkers.h 中的工作者通过 std::function 调用回调，编译器无法内联。
+ * 这里的工作者按类型保存可调用对象（LoopWorkerT、TimerWorkerT），
+ * 或者通过 CRTP 在编译期调用派生类的方法（StaticLoopWorker），
+ * 循环体可以被内联和向量化；与 ThreadManager 交互的部分仍然是 IThreadWorker 的虚函数，
+ * 每个工作者只在启动、停止和检查点上付出虚调用的开销。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief 固定次数循环的 CRTP 基类
+ *
+ * 派生类提供 void iterate(int i)，i 从1开始；可以隐藏 onLoopBegin()/onLoopEnd()
+ * 在循环开始前和结束后执行额外工作。每 checkInterval 次迭代为一块：
+ * 块内直接调用 iterate()，不检查停止和暂停请求，也不计时，编译器可以把整块内联并向量化；
+ * 块之间检查一次 shouldContinue()，并把整块记为一次回调延迟。
+ * iterate() 抛出异常时报告错误并跳过该块剩余的迭代，然后继续下一块。
+ *
+ * @code
+ * class Scale : public StaticLoopWorker<Scale> {
+ * public:
+ *     Scale(std::vector<float>& data) : StaticLoopWorker(static_cast<int>(data.size()), 4096), data_(data) {}
+ *     void iterate(int i) { data_[i - 1] *= 2.0f; }
+ * private:
+ *     std::vector<float>& data_;
+ * };
+ * @endcode
+ *
+ * @tparam Derived 派生类
+ */
+template <typename Derived>
+class StaticLoopWorker : public IThreadWorker {
+private:
+    int loopCount_;
+    int checkInterval_;
+    OwnedCounter<int> currentLoop_; ///< 已完成的迭代数，按块更新，只由工作者线程写入
+
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param loopCount 循环次数
+     * @param checkInterval 两次停止/暂停检查之间的迭代数，小于1时按1处理
+     */
+    explicit StaticLoopWorker(int loopCount, int checkInterval = 1)
+        : loopCount_(loopCount), checkInterval_(std::max(1, checkInterval)) {}
+
+    /**
+     * @brief 执行循环逻辑
+     */
+    void run() override {
+        setState(ThreadState::RUNNING);
+        Derived& self = static_cast<Derived&>(*this);
+
+        self.onLoopBegin();
+
+        for (int begin = 1; begin <= loopCount_ && shouldContinue(); begin = nextBlock(begin)) {
+            int end = nextBlock(begin);
+            try {
+                timeCallback([&self, begin, end]() {
+                    for (int i = begin; i < end; ++i) {
+                        self.iterate(i);
+                    }
+                });
+            } catch (const std::exception& e) {
+                reportError(std::string("Loop callback failed: ") + e.what());
+            }
+            currentLoop_.store(end - 1);
+        }
+
+        self.onLoopEnd();
+
+        setState(ThreadState::FINISHED);
+    }
+
+    /**
+     * @brief 循环开始前调用，派生类可以隐藏
+     */
+    void onLoopBegin() {}
+
+    /**
+     * @brief 循环结束后调用（包括被停止时），派生类可以隐藏
+     */
+    void onLoopEnd() {}
+
+    /**
+     * @brief 获取工作者类型
+     */
+    std::string getType() const override {
+        return "StaticLoopWorker";
+    }
+
+    /**
+     * @brief 获取工作者描述
+     */
+    std::string getDescription() const override {
+        return "Loop worker with " + std::to_string(loopCount_) + " iterations (check every " +
+               std::to_string(checkInterval_) + ")";
+    }
+
+    /**
+     * @brief 获取已完成的迭代数
+     */
+    int getCurrentLoop() const {
+        return currentLoop_.load();
+    }
+
+    /**
+     * @brief 获取总循环次数
+     */
+    int getLoopCount() const {
+        return loopCount_;
+    }
+
+    /**
+     * @brief 获取两次检查之间的迭代数
+     */
+    int getCheckInterval() const {
+        return checkInterval_;
+    }
+
+    /**
+     * @brief 获取进度百分比
+     */
+    double getProgress() const {
+        return loopCount_ > 0 ? static_cast<double>(getCurrentLoop()) / loopCount_ * 100.0 : 100.0;
+    }
+
+    /**
+     * @brief 固定次数的循环可以在线程池中执行
+     */
+    bool isPoolable() const override {
+        return true;
+    }
+
+private:
+    /**
+     * @brief 下一块的起点，不超过 loopCount_ + 1
+     */
+    int nextBlock(int begin) const {
+        return begin + std::min(checkInterval_, loopCount_ - begin + 1);
+    }
+};
+
+/**
+ * @brief 按类型保存循环回调的循环工作者
+ *
+ * 与 LoopWorker 相同，但回调以 F 类型保存，每次迭代的调用可以被内联。
+ *
+ * @code
+ * auto worker = makeLoopWorker(1000000, [&](int i) { sum[i % 8] += i; }, 4096);
+ * manager.createThreadWithWorker(std::move(worker), "sum");
+ * @endcode
+ *
+ * @tparam F 可调用对象类型，签名 void(int)
+ */
+template <typename F>
+class LoopWorkerT : public StaticLoopWorker<LoopWorkerT<F>> {
+private:
+    F callback_;
+
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param loopCount 循环次数
+     * @param callback 循环回调，参数为当前循环次数（从1开始）
+     * @param checkInterval 两次停止/暂停检查之间的迭代数
+     */
+    LoopWorkerT(int loopCount, F callback, int checkInterval = 1)
+        : StaticLoopWorker<LoopWorkerT<F>>(loopCount, checkInterval), callback_(std::move(callback)) {}
+
+    void iterate(int i) {
+        callback_(i);
+    }
+
+    /**
+     * @brief 获取工作者类型
+     */
+    std::string getType() const override {
+        return "LoopWorkerT";
+    }
+};
+
+/**
+ * @brief 按类型保存回调的定时器工作者
+ *
+ * 行为与 TimerWorker 相同（绝对截止时间、跳过落后的周期、最大触发次数、独占线程或共享定时服务），
+ * 两者共用 BasicTimerWorker 的实现，这里的回调以 F 类型保存，不经过 std::function。
+ *
+ * @tparam F 可调用对象类型，签名 void()
+ */
+template <typename F>
+class TimerWorkerT : public BasicTimerWorker<F> {
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param interval 触发间隔
+     * @param callback 回调函数
+     * @param maxTriggers 最大触发次数，-1表示无限次
+     * @param mode 驱动方式，默认独占线程
+     */
+    TimerWorkerT(std::chrono::milliseconds interval, F callback, int maxTriggers = -1,
+                 TimerMode mode = TimerMode::DEDICATED_THREAD)
+        : BasicTimerWorker<F>(interval, std::move(callback), maxTriggers, mode) {}
+
+    /**
+     * @brief 获取工作者类型
+     */
+    std::string getType() const override {
+        return "TimerWorkerT";
+    }
+};
+
+/**
+ * @brief 创建按类型保存回调的循环工作者
+ *
+ * @param loopCount 循环次数
+ * @param callback 循环回调，签名 void(int)
+ * @param checkInterval 两次停止/暂停检查之间的迭代数
+ * @return std::unique_ptr<LoopWorkerT<F>> 工作者，可以传给 createThreadWithWorker()
+ */
+template <typename F>
+std::unique_ptr<LoopWorkerT<std::decay_t<F>>> makeLoopWorker(int loopCount, F&& callback, int checkInterval = 1) {
+    return std::make_unique<LoopWorkerT<std::decay_t<F>>>(loopCount, std::forward<F>(callback), checkInterval);
+}
+
+/**
+ * @brief 创建按类型保存回调的定时器工作者
+ *
+ * @param interval 触发间隔
+ * @param callback 回调函数，签名 void()
+ * @param maxTriggers 最大触发次数，-1表示无限次
+ * @param mode 驱动方式
+ * @return std::unique_ptr<TimerWorkerT<F>> 工作者，可以传给 createThreadWithWorker()
+ */
+template <typename F>
+std::unique_ptr<TimerWorkerT<std::decay_t<F>>> makeTimerWorker(std::chrono::milliseconds interval, F&& callback,
+                                                              int maxTriggers = -1,
+                                                              TimerMode mode = TimerMode::DEDICATED_THREAD) {
+    return std::make_unique<TimerWorkerT<std::decay_t<F>>>(interval, std::forward<F>(callback), maxTriggers, mode);
+}
+
+} // namespace thread_framework
+
+#endif // STATIC_WORKERS_H
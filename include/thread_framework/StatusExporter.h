@@ -0,0 +1,474 @@
+#ifndef STATUS_EXPORTER_H
+#define STATUS_EXPORTER_H
+
+#include "ThreadManager.h"
+#include "WorkerStatus.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+/**
+ * @file StatusExporter.h
+ * @brief 工作者状态的导出
+ *
+ * PrometheusStatusExporter 把 captureStatus() 的结果格式化为 Prometheus 文本格式，
+ * 记录数组和输出缓冲区在两次导出之间复用，稳定状态下不分配内存。
+ * SharedStatusExporter 把记录直接写入 POSIX 共享内存段，外部进程用 SharedStatusReader
+ * （或按 SharedStatusHeader 的布局自行解析）读取，不需要调用被监控的进程。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief 导出为 Prometheus 文本格式
+ *
+ * 汇总指标按状态统计工作者数量；开启 perWorker 时每个工作者输出一组带 id/name/type 标签的指标。
+ * 不是线程安全的，同一个导出器只能由一个线程使用。
+ *
+ * @code
+ * PrometheusStatusExporter exporter(manager);
+ * httpServer.on("/metrics", [&]() { return exporter.render(); });
+ * @endcode
+ */
+class PrometheusStatusExporter {
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param manager 线程管理器，必须比导出器活得更久
+     * @param prefix 指标名称前缀
+     * @param perWorker 是否输出每个工作者的指标
+     */
+    explicit PrometheusStatusExporter(const ThreadManager& manager, std::string prefix = "thread_framework",
+                                      bool perWorker = true)
+        : manager_(manager), prefix_(std::move(prefix)), perWorker_(perWorker) {}
+
+    /**
+     * @brief 采集并格式化
+     *
+     * @return const std::string& 文本，下一次调用 render() 前有效
+     */
+    const std::string& render() {
+        manager_.captureStatus(records_);
+        text_.clear();
+
+        uint64_t byState[4] = {};
+        for (const ThreadStatusRecord& record : records_) {
+            if (record.state < 4) {
+                byState[record.state]++;
+            }
+        }
+        writeHeader("workers", "gauge", "Number of registered workers by state");
+        for (ThreadState state : {ThreadState::STOPPED, ThreadState::RUNNING, ThreadState::PAUSED,
+                                  ThreadState::FINISHED}) {
+            beginSample("workers");
+            text_ += "{state=\"";
+            text_ += getStateName(state);
+            text_ += "\"} ";
+            appendNumber(byState[static_cast<uint8_t>(state)]);
+            text_ += '\n';
+        }
+
+        if (!perWorker_) {
+            return text_;
+        }
+
+        writeHeader("worker_info", "gauge", "Worker identity and current state, always 1");
+        for (const ThreadStatusRecord& record : records_) {
+            beginSample("worker_info");
+            appendLabels(record, true);
+            text_ += " 1\n";
+        }
+        writeCounter("worker_run_seconds_total", "Accumulated run time", &ThreadStatusRecord::runTimeNs, true);
+        writeCounter("worker_pause_seconds_total", "Accumulated pause time", &ThreadStatusRecord::pauseTimeNs,
+                     true);
+        writeCounter("worker_queue_wait_seconds_total", "Time from registration to first run",
+                     &ThreadStatusRecord::queueWaitNs, true);
+        writeCounter("worker_errors_total", "Reported errors", &ThreadStatusRecord::errorCount, false);
+        writeCounter("worker_callbacks_total", "Timed callback invocations", &ThreadStatusRecord::callbackCount,
+                     false);
+        return text_;
+    }
+
+    /**
+     * @brief 获取最近一次采集的记录
+     */
+    const std::vector<ThreadStatusRecord>& getRecords() const {
+        return records_;
+    }
+
+private:
+    const ThreadManager& manager_;
+    std::string prefix_;
+    bool perWorker_;
+    std::vector<ThreadStatusRecord> records_;
+    std::string text_;
+
+    void writeHeader(const char* metric, const char* type, const char* help) {
+        text_ += "# HELP ";
+        text_ += prefix_;
+        text_ += '_';
+        text_ += metric;
+        text_ += ' ';
+        text_ += help;
+        text_ += "\n# TYPE ";
+        text_ += prefix_;
+        text_ += '_';
+        text_ += metric;
+        text_ += ' ';
+        text_ += type;
+        text_ += '\n';
+    }
+
+    void beginSample(const char* metric) {
+        text_ += prefix_;
+        text_ += '_';
+        text_ += metric;
+    }
+
+    void writeCounter(const char* metric, const char* help, uint64_t ThreadStatusRecord::*field, bool seconds) {
+        writeHeader(metric, "counter", help);
+        for (const ThreadStatusRecord& record : records_) {
+            beginSample(metric);
+            appendLabels(record, false);
+            text_ += ' ';
+            if (seconds) {
+                appendNumber(static_cast<double>(record.*field) / 1e9);
+            } else {
+                appendNumber(record.*field);
+            }
+            text_ += '\n';
+        }
+    }
+
+    void appendLabels(const ThreadStatusRecord& record, bool full) {
+        text_ += "{id=\"";
+        appendNumber(record.threadId);
+        text_ += '"';
+        if (full) {
+            text_ += ",name=\"";
+            appendEscaped(record.name);
+            text_ += "\",type=\"";
+            appendEscaped(WorkerTypeTable::getName(record.typeId).c_str());
+            text_ += "\",state=\"";
+            text_ += getStateName(record.getState());
+            text_ += '"';
+        }
+        text_ += '}';
+    }
+
+    /**
+     * @brief 按 Prometheus 标签值的规则转义反斜杠、引号和换行
+     */
+    void appendEscaped(const char* value) {
+        for (const char* c = value; *c; ++c) {
+            if (*c == '\\' || *c == '"') {
+                text_ += '\\';
+                text_ += *c;
+            } else if (*c == '\n') {
+                text_ += "\\n";
+            } else {
+                text_ += *c;
+            }
+        }
+    }
+
+    template <typename T>
+    void appendNumber(T value) {
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        text_.append(buffer, result.ptr);
+    }
+};
+
+/**
+ * @brief 共享内存段的头部
+ *
+ * 段的布局：头部（128字节），capacity 条 ThreadStatusRecord，然后是 typeCapacity 个
+ * TYPE_NAME_SIZE 字节、以 '\0' 结尾的类型名称（第 i 个对应类型ID i + 1）。
+ * 写入方用 sequence 实现顺序锁：写入前后各加一，奇数表示正在写入；读取方在复制前后读取
+ * sequence，两次相同且为偶数时复制的内容有效。
+ */
+struct SharedStatusHeader {
+    static constexpr uint32_t MAGIC = 0x54465354;  ///< "TFST"
+    static constexpr uint32_t TYPE_NAME_SIZE = 64; ///< 每个类型名称占用的字节数
+
+    uint32_t magic;                     ///< 固定为 MAGIC
+    uint32_t layoutVersion;             ///< STATUS_LAYOUT_VERSION
+    uint32_t recordSize;                ///< sizeof(ThreadStatusRecord)
+    uint32_t typeCapacity;              ///< 类型名称表的条目数
+    uint64_t capacity;                  ///< 记录容量
+    uint64_t pid;                       ///< 写入方进程ID
+    std::atomic<uint64_t> sequence;     ///< 顺序锁计数，奇数表示正在写入
+    uint64_t count;                     ///< 有效记录数
+    uint64_t totalThreads;              ///< 采集时的线程总数，大于 capacity 时记录被截断
+    uint64_t updatedUnixNs;             ///< 最近一次更新的时间（Unix 纪元起的纳秒）
+    uint32_t typeCount;                 ///< 有效的类型名称数
+    uint32_t reserved0;
+    uint64_t reserved[7];
+};
+
+static_assert(sizeof(SharedStatusHeader) == 128, "SharedStatusHeader layout changed; bump STATUS_LAYOUT_VERSION");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "SharedStatusHeader requires lock-free 64-bit atomics");
+
+namespace detail {
+
+inline size_t sharedStatusSize(size_t capacity, size_t typeCapacity) {
+    return sizeof(SharedStatusHeader) + capacity * sizeof(ThreadStatusRecord) +
+           typeCapacity * SharedStatusHeader::TYPE_NAME_SIZE;
+}
+
+} // namespace detail
+
+/**
+ * @brief 把工作者状态发布到 POSIX 共享内存段
+ *
+ * update() 无锁采集并直接写入共享内存，不分配内存，可以由 TimerWorker 周期性调用：
+ *
+ * @code
+ * SharedStatusExporter exporter(manager, "/myservice-workers", 16384);
+ * manager.createThreadWithWorker(std::make_unique<TimerWorker>(std::chrono::seconds(1),
+ *     [&]() { exporter.update(); }, -1, TimerMode::SHARED_SERVICE), "status-export");
+ * @endcode
+ *
+ * update() 不能并发调用。导出器析构时删除共享内存段。
+ */
+class SharedStatusExporter {
+public:
+    /**
+     * @brief 创建（或覆盖）共享内存段
+     *
+     * @param manager 线程管理器，必须比导出器活得更久
+     * @param name 段名称，以 '/' 开头，例如 "/myservice-workers"
+     * @param capacity 记录容量，超过的线程不导出（totalThreads 仍然反映总数）
+     * @throws std::system_error 创建或映射共享内存失败
+     */
+    SharedStatusExporter(const ThreadManager& manager, const std::string& name, size_t capacity)
+        : manager_(manager), name_(name), capacity_(capacity),
+          size_(detail::sharedStatusSize(capacity, WorkerTypeTable::MAX_TYPES)) {
+        int fd = ::shm_open(name_.c_str(), O_CREAT | O_RDWR, 0644);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open failed");
+        }
+        if (::ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+            int error = errno;
+            ::close(fd);
+            ::shm_unlink(name_.c_str());
+            throw std::system_error(error, std::generic_category(), "ftruncate failed");
+        }
+        void* mapping = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        int error = errno;
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            ::shm_unlink(name_.c_str());
+            throw std::system_error(error, std::generic_category(), "mmap failed");
+        }
+
+        base_ = static_cast<unsigned char*>(mapping);
+        std::memset(base_, 0, size_);
+        header_ = new (base_) SharedStatusHeader();
+        header_->recordSize = sizeof(ThreadStatusRecord);
+        header_->typeCapacity = WorkerTypeTable::MAX_TYPES;
+        header_->capacity = capacity_;
+        header_->pid = static_cast<uint64_t>(::getpid());
+        header_->layoutVersion = STATUS_LAYOUT_VERSION;
+        header_->sequence.store(0, std::memory_order_relaxed);
+        // magic 最后写入，读取方看到 magic 时其余字段已经初始化
+        std::atomic_thread_fence(std::memory_order_release);
+        header_->magic = SharedStatusHeader::MAGIC;
+    }
+
+    ~SharedStatusExporter() {
+        ::munmap(base_, size_);
+        ::shm_unlink(name_.c_str());
+    }
+
+    SharedStatusExporter(const SharedStatusExporter&) = delete;
+    SharedStatusExporter& operator=(const SharedStatusExporter&) = delete;
+
+    /**
+     * @brief 采集并发布一次
+     *
+     * @return size_t 采集到的线程总数
+     */
+    size_t update() {
+        uint64_t sequence = header_->sequence.load(std::memory_order_relaxed);
+        header_->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        size_t total = manager_.captureStatus(records(), capacity_);
+        header_->count = std::min(total, capacity_);
+        header_->totalThreads = total;
+        header_->updatedUnixNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+
+        uint32_t types = WorkerTypeTable::getCount();
+        for (uint32_t id = publishedTypes_ + 1; id <= types; ++id) {
+            char* slot = typeNames() + (id - 1) * SharedStatusHeader::TYPE_NAME_SIZE;
+            const std::string& type = WorkerTypeTable::getName(id);
+            size_t length = std::min<size_t>(type.size(), SharedStatusHeader::TYPE_NAME_SIZE - 1);
+            std::memcpy(slot, type.data(), length);
+            slot[length] = '\0';
+        }
+        publishedTypes_ = types;
+        header_->typeCount = types;
+
+        header_->sequence.store(sequence + 2, std::memory_order_release);
+        return total;
+    }
+
+    const std::string& getName() const {
+        return name_;
+    }
+
+    size_t getCapacity() const {
+        return capacity_;
+    }
+
+private:
+    const ThreadManager& manager_;
+    std::string name_;
+    size_t capacity_;
+    size_t size_;
+    unsigned char* base_ = nullptr;
+    SharedStatusHeader* header_ = nullptr;
+    uint32_t publishedTypes_ = 0;
+
+    ThreadStatusRecord* records() {
+        return reinterpret_cast<ThreadStatusRecord*>(base_ + sizeof(SharedStatusHeader));
+    }
+
+    char* typeNames() {
+        return reinterpret_cast<char*>(base_ + sizeof(SharedStatusHeader) +
+                                       capacity_ * sizeof(ThreadStatusRecord));
+    }
+};
+
+/**
+ * @brief 读取其它进程发布的共享内存段
+ *
+ * 只读映射，不影响写入方。
+ */
+class SharedStatusReader {
+public:
+    /**
+     * @brief 打开共享内存段
+     *
+     * @param name 段名称
+     * @throws std::system_error 打开或映射失败
+     * @throws std::runtime_error 段的格式或版本不匹配
+     */
+    explicit SharedStatusReader(const std::string& name) {
+        int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open failed");
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "fstat failed");
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        void* mapping = size_ >= sizeof(SharedStatusHeader)
+                            ? ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0)
+                            : MAP_FAILED;
+        int error = size_ >= sizeof(SharedStatusHeader) ? errno : EINVAL;
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::system_error(error, std::generic_category(), "mmap failed");
+        }
+
+        base_ = static_cast<const unsigned char*>(mapping);
+        header_ = reinterpret_cast<const SharedStatusHeader*>(base_);
+        if (header_->magic != SharedStatusHeader::MAGIC || header_->layoutVersion != STATUS_LAYOUT_VERSION ||
+            header_->recordSize != sizeof(ThreadStatusRecord) ||
+            size_ < detail::sharedStatusSize(header_->capacity, header_->typeCapacity)) {
+            ::munmap(const_cast<unsigned char*>(base_), size_);
+            throw std::runtime_error("Shared status segment has an unexpected layout");
+        }
+    }
+
+    ~SharedStatusReader() {
+        ::munmap(const_cast<unsigned char*>(base_), size_);
+    }
+
+    SharedStatusReader(const SharedStatusReader&) = delete;
+    SharedStatusReader& operator=(const SharedStatusReader&) = delete;
+
+    /**
+     * @brief 读取一致的快照
+     *
+     * @param records 输出记录
+     * @param typeNames 不为空时输出类型名称表，下标为类型ID减一
+     * @param attempts 写入方持续更新时的最大重试次数
+     * @return true 读取成功
+     * @return false 重试次数内没有读到一致的快照，或者写入方还没有发布过
+     */
+    bool read(std::vector<ThreadStatusRecord>& records, std::vector<std::string>* typeNames = nullptr,
+              int attempts = 100) const {
+        for (int attempt = 0; attempt < attempts; ++attempt) {
+            uint64_t before = header_->sequence.load(std::memory_order_acquire);
+            if (before == 0) {
+                return false;
+            }
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            size_t count = static_cast<size_t>(std::min<uint64_t>(header_->count, header_->capacity));
+            uint32_t types = std::min(header_->typeCount, header_->typeCapacity);
+            records.resize(count);
+            std::memcpy(records.data(), base_ + sizeof(SharedStatusHeader), count * sizeof(ThreadStatusRecord));
+            if (typeNames) {
+                const char* names = reinterpret_cast<const char*>(
+                    base_ + sizeof(SharedStatusHeader) + header_->capacity * sizeof(ThreadStatusRecord));
+                typeNames->resize(types);
+                for (uint32_t i = 0; i < types; ++i) {
+                    const char* slot = names + i * SharedStatusHeader::TYPE_NAME_SIZE;
+                    (*typeNames)[i].assign(slot, strnlen(slot, SharedStatusHeader::TYPE_NAME_SIZE));
+                }
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header_->sequence.load(std::memory_order_relaxed) == before) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 获取头部（字段可能正在被写入方更新）
+     */
+    const SharedStatusHeader& getHeader() const {
+        return *header_;
+    }
+
+private:
+    const unsigned char* base_ = nullptr;
+    size_t size_ = 0;
+    const SharedStatusHeader* header_ = nullptr;
+};
+
+} // namespace thread_framework
+
+#endif // STATUS_EXPORTER_H
@@ -0,0 +1,387 @@
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include "ThreadPool.h"
+#include "Future.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <chrono>
+
+/**
+ * @file TaskGraph.h
+ * @brief 任务依赖图
+ *
+ * 节点和边声明一次，之后可以在线程池上反复执行。每个节点有一个依赖计数，
+ * 前驱全部完成时由最后完成的前驱释放，不需要按阶段设置屏障。
+ * 节点的任务对象嵌入在节点中，重复执行不分配内存。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief 可重复执行的任务依赖图（DAG）
+ *
+ * 执行期间不能修改图，也不能同时启动第二次执行。某个节点抛出异常后，尚未开始的节点
+ * 不再执行（仍按依赖顺序跳过），第一个异常在 run() 中重新抛出或传递到 submit() 返回的 Future。
+ *
+ * @code
+ * TaskGraph graph;
+ * size_t load = graph.addNode([&]() { loadInput(); }, "load");
+ * size_t merge = graph.addNode([&]() { mergeParts(); }, "merge");
+ * for (size_t i = 0; i < parts; ++i) {
+ *     size_t parse = graph.addNode([&, i]() { parsePart(i); });
+ *     graph.addEdge(load, parse);
+ *     graph.addEdge(parse, merge);
+ * }
+ * manager.runGraph(graph);
+ * @endcode
+ */
+class TaskGraph {
+public:
+    TaskGraph() = default;
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    /**
+     * @brief 析构函数
+     *
+     * 图必须比正在进行的执行活得更久，析构前应等待 run() 返回或 Future 就绪。
+     */
+    ~TaskGraph() = default;
+
+    /**
+     * @brief 添加节点
+     *
+     * @param work 节点的工作
+     * @param name 节点名称，用于诊断
+     * @return size_t 节点ID，从0开始连续编号
+     * @throws std::logic_error 图正在执行
+     */
+    size_t addNode(std::function<void()> work, const std::string& name = "") {
+        checkIdle();
+        nodes_.push_back(std::make_unique<Node>(this, nodes_.size(), std::move(work), name));
+        validated_ = false;
+        return nodes_.size() - 1;
+    }
+
+    /**
+     * @brief 添加依赖边：from 完成后才执行 to
+     *
+     * @param from 前驱节点ID
+     * @param to 后继节点ID
+     * @return true 添加成功
+     * @return false 节点ID无效或 from 等于 to
+     * @throws std::logic_error 图正在执行
+     */
+    bool addEdge(size_t from, size_t to) {
+        checkIdle();
+        if (from >= nodes_.size() || to >= nodes_.size() || from == to) {
+            return false;
+        }
+        nodes_[from]->successors.push_back(nodes_[to].get());
+        nodes_[to]->predecessorCount++;
+        edgeCount_++;
+        validated_ = false;
+        return true;
+    }
+
+    /**
+     * @brief 获取节点数量
+     */
+    size_t getNodeCount() const {
+        return nodes_.size();
+    }
+
+    /**
+     * @brief 获取边数量
+     */
+    size_t getEdgeCount() const {
+        return edgeCount_;
+    }
+
+    /**
+     * @brief 获取节点名称
+     *
+     * @param node 节点ID
+     * @return std::string 节点名称，ID无效时为空字符串
+     */
+    std::string getNodeName(size_t node) const {
+        return node < nodes_.size() ? nodes_[node]->name : std::string();
+    }
+
+    /**
+     * @brief 是否正在执行
+     */
+    bool isRunning() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return running_;
+    }
+
+    /**
+     * @brief 获取已完成的执行次数
+     */
+    size_t getRunCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return runCount_;
+    }
+
+    /**
+     * @brief 在线程池上执行并等待完成
+     *
+     * 等待期间帮助执行线程池中的任务，因此可以在池线程中调用。
+     *
+     * @param pool 线程池
+     * @throws std::logic_error 图包含环或正在执行
+     * @throws 第一个失败节点抛出的异常
+     */
+    void run(ThreadPool& pool) {
+        start(pool, Promise<void>());
+
+        while (isRunning()) {
+            if (pool.runPendingTask()) {
+                continue;
+            }
+            // 剩余节点都在其它线程上执行，短暂等待后再尝试帮助
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait_for(lock, std::chrono::milliseconds(1), [this]() { return !running_; });
+        }
+
+        // 完成方在锁内通知，拿到锁之后它已不再访问图
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            error = error_;
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    /**
+     * @brief 在线程池上启动执行，不等待
+     *
+     * @param pool 线程池
+     * @return Future<void> 执行完成时就绪，携带第一个失败节点的异常
+     * @throws std::logic_error 图包含环或正在执行
+     */
+    Future<void> submit(ThreadPool& pool) {
+        Promise<void> promise(pool);
+        Future<void> future = promise.getFuture();
+        start(pool, std::move(promise));
+        return future;
+    }
+
+private:
+    /**
+     * @brief 节点，按缓存行对齐避免依赖计数之间的伪共享
+     */
+    struct alignas(64) Node {
+        /**
+         * @brief 嵌入在节点中的线程池任务，生命周期由图管理
+         *
+         * 线程池在 execute() 之后还会调用 release()，因此完成计数在 release() 中递减：
+         * 最后一个节点完成后图可能立即被销毁，递减之后不能再访问任务对象。
+         */
+        class NodeTask : public PoolTask {
+        public:
+            explicit NodeTask(Node* owner) : node(owner) {}
+
+            void execute() override {
+                finished = node->graph->runFrom(node);
+            }
+
+            void release() override {
+                node->graph->finishNodes(finished);
+            }
+
+        private:
+            Node* node;
+            size_t finished = 0; ///< 本次 execute() 完成的节点数
+        };
+
+        TaskGraph* graph;
+        size_t index;
+        std::function<void()> work;
+        std::string name;
+        std::vector<Node*> successors;
+        size_t predecessorCount = 0;
+        std::atomic<size_t> pending{0}; ///< 本次执行中尚未完成的前驱数
+        NodeTask task;
+
+        Node(TaskGraph* owner, size_t id, std::function<void()> function, const std::string& nodeName)
+            : graph(owner), index(id), work(std::move(function)), name(nodeName), task(this) {}
+    };
+
+    std::vector<std::unique_ptr<Node>> nodes_;
+    std::vector<PoolTask*> roots_;   ///< 没有前驱的节点，校验时计算
+    size_t edgeCount_ = 0;
+    bool validated_ = false;
+
+    ThreadPool* pool_ = nullptr;
+    std::atomic<size_t> remaining_{0};  ///< 本次执行中尚未完成的节点数
+    std::atomic<bool> failed_{false};
+
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    bool running_ = false;
+    size_t runCount_ = 0;
+    std::exception_ptr error_;
+    Promise<void> promise_;
+
+    void checkIdle() const {
+        if (isRunning()) {
+            throw std::logic_error("TaskGraph cannot be modified while running");
+        }
+    }
+
+    /**
+     * @brief 检查是否有环并计算根节点（Kahn 算法）
+     */
+    void validate() {
+        if (validated_) {
+            return;
+        }
+        std::vector<size_t> indegree(nodes_.size());
+        std::vector<Node*> ready;
+        roots_.clear();
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            indegree[i] = nodes_[i]->predecessorCount;
+            if (indegree[i] == 0) {
+                ready.push_back(nodes_[i].get());
+                roots_.push_back(&nodes_[i]->task);
+            }
+        }
+
+        size_t visited = 0;
+        while (!ready.empty()) {
+            Node* node = ready.back();
+            ready.pop_back();
+            visited++;
+            for (Node* successor : node->successors) {
+                if (--indegree[successor->index] == 0) {
+                    ready.push_back(successor);
+                }
+            }
+        }
+        if (visited != nodes_.size()) {
+            throw std::logic_error("TaskGraph contains a cycle");
+        }
+        validated_ = true;
+    }
+
+    /**
+     * @brief 重置计数并提交根节点
+     */
+    void start(ThreadPool& pool, Promise<void> promise) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (running_) {
+                throw std::logic_error("TaskGraph is already running");
+            }
+            validate();
+            running_ = true;
+            error_ = nullptr;
+            promise_ = std::move(promise);
+        }
+
+        pool_ = &pool;
+        failed_.store(false, std::memory_order_relaxed);
+        for (auto& node : nodes_) {
+            node->pending.store(node->predecessorCount, std::memory_order_relaxed);
+        }
+        remaining_.store(nodes_.size(), std::memory_order_release);
+
+        if (nodes_.empty()) {
+            complete();
+            return;
+        }
+        pool.submitBatch(roots_.data(), roots_.size());
+    }
+
+    /**
+     * @brief 执行节点，并沿着最后一个就绪的后继继续执行
+     *
+     * 其它就绪的后继提交到线程池；在池线程中它们进入本地队列，空闲线程可以窃取。
+     *
+     * @return size_t 执行（或因失败跳过）的节点数
+     */
+    size_t runFrom(Node* node) {
+        size_t finished = 0;
+        while (node) {
+            if (!failed_.load(std::memory_order_relaxed)) {
+                try {
+                    node->work();
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!error_) {
+                        error_ = std::current_exception();
+                    }
+                    failed_.store(true, std::memory_order_relaxed);
+                }
+            }
+
+            Node* next = nullptr;
+            for (Node* successor : node->successors) {
+                if (successor->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    if (next) {
+                        pool_->submit(static_cast<PoolTask*>(&next->task));
+                    }
+                    next = successor;
+                }
+            }
+
+            finished++;
+            node = next;
+        }
+        return finished;
+    }
+
+    /**
+     * @brief 记录完成的节点，最后一个节点完成时结束本次执行
+     */
+    void finishNodes(size_t count) {
+        if (remaining_.fetch_sub(count, std::memory_order_acq_rel) == count) {
+            complete();
+        }
+    }
+
+    /**
+     * @brief 结束本次执行，唤醒等待方并设置 Future
+     */
+    void complete() {
+        Promise<void> promise;
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+            runCount_++;
+            error = error_;
+            promise = std::move(promise_);
+            condition_.notify_all();
+        }
+
+        if (promise.valid()) {
+            if (error) {
+                promise.setException(error);
+            } else {
+                promise.setValue();
+            }
+        }
+    }
+};
+
+} // namespace thread_framework
+
+#endif // TASK_GRAPH_H
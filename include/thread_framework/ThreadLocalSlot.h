@@ -0,0 +1,265 @@
+#ifndef THREAD_LOCAL_SLOT_H
+#define THREAD_LOCAL_SLOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @file ThreadLocalSlot.h
+ * @brief 按对象区分的线程私有存储
+ *
+ * thread_local 只能声明在命名空间或静态作用域中，每个声明在每个线程上只有一份。
+ * ThreadLocalSlot 是普通对象，可以作为成员或局部静态变量，每个对象在每个线程上各有一个值，
+ * 首次访问时创建，在同一线程上执行的后续任务中一直保留，线程退出时销毁。
+ * 用来保存解析器、缓冲区等每个池线程只需构建一次的缓存。
+ *
+ * @code
+ * static ThreadLocalSlot<Parser> parser;        // 每个池线程一个 Parser
+ * manager.submit([&line]() { return parser->parse(line); });
+ * @endcode
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+namespace detail {
+
+/**
+ * @brief 当前线程上所有 ThreadLocalSlot 的值，按槽位序号索引
+ */
+class ThreadSlotTable {
+public:
+    struct Entry {
+        void* value = nullptr;
+        void (*destroy)(void*) = nullptr;
+        uint64_t generation = 0; ///< 创建该值的槽位对象，序号被复用后旧值不再匹配
+    };
+
+    /**
+     * @brief 获取当前线程的表
+     *
+     * @return ThreadSlotTable* 线程正在退出、表已析构时为 nullptr
+     */
+    static ThreadSlotTable* local() {
+        if (threadExited()) {
+            return nullptr;
+        }
+        thread_local ThreadSlotTable table;
+        return &table;
+    }
+
+    /**
+     * @brief 查找槽位的值
+     *
+     * @return void* 当前线程还没有创建该值时为 nullptr
+     */
+    void* find(size_t index, uint64_t generation) const {
+        if (index < entries_.size() && entries_[index].generation == generation) {
+            return entries_[index].value;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief 保存槽位的值，替换该序号上已有的值
+     */
+    void store(size_t index, uint64_t generation, void* value, void (*destroy)(void*)) {
+        if (index >= entries_.size()) {
+            entries_.resize(index + 1);
+        }
+        Entry old = entries_[index];
+        entries_[index] = Entry{value, destroy, generation};
+        if (old.value) {
+            old.destroy(old.value);
+        }
+    }
+
+    /**
+     * @brief 销毁槽位的值
+     */
+    void erase(size_t index, uint64_t generation) {
+        if (index < entries_.size() && entries_[index].generation == generation && entries_[index].value) {
+            Entry old = entries_[index];
+            entries_[index] = Entry{};
+            old.destroy(old.value);
+        }
+    }
+
+    ~ThreadSlotTable() {
+        threadExited() = true;
+        std::vector<Entry> entries;
+        entries.swap(entries_);
+        for (Entry& entry : entries) {
+            if (entry.value) {
+                entry.destroy(entry.value);
+            }
+        }
+    }
+
+private:
+    std::vector<Entry> entries_;
+
+    ThreadSlotTable() = default;
+
+    /**
+     * @brief 当前线程的表是否已析构，析构期间和之后的访问不再创建值
+     */
+    static bool& threadExited() {
+        thread_local bool exited = false;
+        return exited;
+    }
+};
+
+/**
+ * @brief 分配槽位序号，已销毁槽位的序号被复用，复用时换用新的代数
+ */
+class ThreadSlotIds {
+public:
+    static void acquire(size_t& index, uint64_t& generation) {
+        ThreadSlotIds& ids = instance();
+        std::lock_guard<std::mutex> lock(ids.mutex_);
+        if (!ids.free_.empty()) {
+            index = ids.free_.back();
+            ids.free_.pop_back();
+        } else {
+            index = ids.next_++;
+        }
+        generation = ++ids.generation_;
+    }
+
+    static void release(size_t index) {
+        ThreadSlotIds& ids = instance();
+        std::lock_guard<std::mutex> lock(ids.mutex_);
+        ids.free_.push_back(index);
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<size_t> free_;
+    size_t next_ = 0;
+    uint64_t generation_ = 0;
+
+    static ThreadSlotIds& instance() {
+        // 有意不释放，静态的 ThreadLocalSlot 在退出时析构仍然可以归还序号
+        static ThreadSlotIds* ids = new ThreadSlotIds();
+        return *ids;
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief 按对象区分的线程私有值
+ *
+ * get() 在当前线程第一次访问时用工厂函数创建值，之后返回同一个对象，访问不加锁。
+ * 值只被创建它的线程访问，不需要同步；线程退出时销毁该线程上的所有值。
+ * 槽位对象先于线程销毁时，已创建的值保留到对应线程退出或序号被复用时才销毁，
+ * 因此长期运行的池中应当让槽位对象长期存在（静态变量或长期存在的对象的成员）。
+ *
+ * @tparam T 值类型
+ */
+template <typename T>
+class ThreadLocalSlot {
+public:
+    using Factory = std::function<std::unique_ptr<T>()>;
+
+    /**
+     * @brief 构造函数，值用默认构造函数创建
+     */
+    ThreadLocalSlot() : ThreadLocalSlot(Factory()) {}
+
+    /**
+     * @brief 构造函数
+     *
+     * @param factory 在每个线程上创建值的函数，为空时使用 T 的默认构造函数（T 不能默认构造时必须提供）
+     */
+    explicit ThreadLocalSlot(Factory factory) : factory_(std::move(factory)) {
+        detail::ThreadSlotIds::acquire(index_, generation_);
+    }
+
+    ~ThreadLocalSlot() {
+        detail::ThreadSlotIds::release(index_);
+    }
+
+    ThreadLocalSlot(const ThreadLocalSlot&) = delete;
+    ThreadLocalSlot& operator=(const ThreadLocalSlot&) = delete;
+
+    /**
+     * @brief 获取当前线程的值，第一次访问时创建
+     *
+     * @throws std::logic_error 在线程退出、线程私有存储已销毁后访问
+     */
+    T& get() {
+        detail::ThreadSlotTable* table = detail::ThreadSlotTable::local();
+        if (!table) {
+            throw std::logic_error("ThreadLocalSlot accessed after thread-local storage was destroyed");
+        }
+        void* value = table->find(index_, generation_);
+        if (value) {
+            return *static_cast<T*>(value);
+        }
+        return create(*table);
+    }
+
+    T& operator*() {
+        return get();
+    }
+
+    T* operator->() {
+        return &get();
+    }
+
+    /**
+     * @brief 获取当前线程的值，不创建
+     *
+     * @return T* 当前线程还没有创建该值时为 nullptr
+     */
+    T* tryGet() const {
+        detail::ThreadSlotTable* table = detail::ThreadSlotTable::local();
+        return table ? static_cast<T*>(table->find(index_, generation_)) : nullptr;
+    }
+
+    /**
+     * @brief 销毁当前线程的值，下次访问时重新创建
+     */
+    void reset() {
+        detail::ThreadSlotTable* table = detail::ThreadSlotTable::local();
+        if (table) {
+            table->erase(index_, generation_);
+        }
+    }
+
+private:
+    Factory factory_;
+    size_t index_ = 0;
+    uint64_t generation_ = 0;
+
+    T& create(detail::ThreadSlotTable& table) {
+        std::unique_ptr<T> value;
+        if (factory_) {
+            value = factory_();
+        } else if constexpr (std::is_default_constructible<T>::value) {
+            value = std::make_unique<T>();
+        }
+        if (!value) {
+            throw std::logic_error("ThreadLocalSlot factory returned null");
+        }
+        T* raw = value.get();
+        table.store(index_, generation_, raw, [](void* p) { delete static_cast<T*>(p); });
+        value.release();
+        return *raw;
+    }
+};
+
+} // namespace thread_framework
+
+#endif // THREAD_LOCAL_SLOT_H
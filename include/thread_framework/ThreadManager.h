@@ -2,27 +2,237 @@
 #define THREAD_MANAGER_H
 
 #include "IThreadWorker.h"
+#include "ThreadPool.h"
+#include "Future.h"
+#include "ParallelFor.h"
+#include "TaskGraph.h"
+#include "TimerService.h"
+#include "ThreadRegistry.h"
+#include "CountDownLatch.h"
+#include "ThreadOptions.h"
+#include "EventLoop.h"
+#include "Tracing.h"
+#include "WorkerArena.h"
+#include "WorkerStatus.h"
+#include "ScratchArena.h"
+#include "ThreadLocalSlot.h"
 #include <thread>
 #include <vector>
 #include <memory>
 #include <unordered_map>
 #include <mutex>
 #include <condition_variable>
+#include <utility>
+#include <algorithm>
+#include <cstring>
 
 namespace thread_framework {
 
+class ThreadManager;
+
+/**
+ * @brief 执行模式枚举
+ */
+enum class ExecutionMode {
+    DEDICATED_THREAD,   ///< 每个工作者独占一个新线程
+    POOLED              ///< 可池化的工作者在固定大小的线程池中执行
+};
+
+/**
+ * @brief 线程组
+ *
+ * 批量创建的工作者属于同一个线程组，最后一个成员完成时门闩归零。
+ */
+struct ThreadGroup {
+    std::vector<size_t> threadIds;   ///< 成员线程ID
+    CountDownLatch latch;            ///< 尚未完成的成员计数
+
+    explicit ThreadGroup(size_t count) : latch(count) {}
+};
+
+/**
+ * @brief 按工厂类型统计的工作者回收情况
+ */
+struct RecycleStats {
+    uint64_t hits = 0;       ///< createThread() 复用空闲工作者的次数
+    uint64_t misses = 0;     ///< 没有空闲工作者、调用工厂创建的次数
+    uint64_t recycled = 0;   ///< 结束后被重置并放回空闲列表的工作者数
+    uint64_t discarded = 0;  ///< 结束后因不能重置或空闲列表已满而销毁的工作者数
+    size_t idle = 0;         ///< 当前空闲的工作者数
+};
+
+namespace detail {
+
+/**
+ * @brief 已登记的工厂及其空闲工作者
+ *
+ * 地址在管理器生命周期内不变，条目通过指针引用它，回收时把工作者放回这里。
+ */
+struct FactorySlot {
+    std::unique_ptr<IThreadWorkerFactory> factory;
+    std::mutex mutex;               ///< 保护 idle
+    std::vector<WorkerPtr> idle;    ///< 已重置、可以复用的工作者
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> recycled{0};
+    std::atomic<uint64_t> discarded{0};
+};
+
+} // namespace detail
+
 /**
  * @brief 线程信息结构
+ *
+ * 存放在线程登记表的槽位中，地址稳定，槽位回收时通过 reset() 复用。
  */
 struct ThreadInfo {
-    std::unique_ptr<std::thread> thread;       ///< 线程对象
-    std::unique_ptr<IThreadWorker> worker;     ///< 工作者对象
+    /**
+     * @brief 把条目提交到线程池时使用的任务
+     *
+     * 嵌在条目中，提交时不需要额外分配；生命周期跟随条目，release() 什么也不做。
+     */
+    class LaunchTask : public PoolTask {
+    public:
+        ThreadManager* manager = nullptr;
+        ThreadInfo* entry = nullptr;
+
+        void execute() override;
+        void release() override {}
+    };
+
+    std::unique_ptr<NativeThread> thread;      ///< 独占线程对象，由 threadMutex 保护
+    WorkerPtr worker;                          ///< 工作者对象，可能来自管理器的内存池
     std::atomic<bool> running{false};          ///< 运行状态
     std::atomic<bool> started{false};          ///< 已确认启动状态
-    std::string name;                          ///< 线程名称
+    WorkerName name;                           ///< 线程名称，可以是驻留名称或匿名
     std::chrono::steady_clock::time_point startTime; ///< 启动时间
+    bool pooled{false};                        ///< 是否在线程池中执行
+    bool timerDriven{false};                   ///< 是否由共享定时服务驱动
+    bool async{false};                         ///< 是否为在线程池上运行的异步工作者
+    std::atomic<TimerService::TimerId> timerId{0}; ///< 共享定时服务中的定时器ID
+    std::mutex threadMutex;                    ///< 保护线程对象的设置和join
+    std::shared_ptr<ThreadGroup> group;        ///< 所属线程组，单独创建时为空
+    LaunchTask launchTask;                     ///< 池化或异步启动时提交的任务
+    CancellationRegistration cancellation;     ///< 工作者取消令牌上的停止回调，最先注销
+    mutable std::atomic<uint32_t> typeId{0};   ///< WorkerTypeTable 中的类型ID，首次采集状态时计算
+    size_t id{0};                              ///< 登记表中的线程ID，启动前设置，用于跟踪事件
+    detail::FactorySlot* recycler{nullptr};    ///< 创建它的工厂，结束后尝试回收；不是由工厂创建时为空
+
+    ThreadInfo() {
+        launchTask.entry = this;
+    }
+
+    ThreadInfo(const ThreadInfo&) = delete;
+    ThreadInfo& operator=(const ThreadInfo&) = delete;
+
+    /**
+     * @brief 是否没有独占线程（池化、定时服务驱动或异步）
+     */
+    bool sharesThread() const { return pooled || timerDriven || async; }
+
+    /**
+     * @brief 重置为初始状态，供槽位复用
+     */
+    void reset() {
+        cancellation.unregister(); // 等待正在执行的停止回调返回，之后才能销毁工作者
+        thread.reset();
+        worker.reset();
+        running.store(false);
+        started.store(false);
+        name = WorkerName();
+        startTime = std::chrono::steady_clock::time_point();
+        pooled = false;
+        timerDriven = false;
+        async = false;
+        timerId.store(0);
+        group.reset();
+        typeId.store(0, std::memory_order_relaxed);
+        id = 0;
+        recycler = nullptr;
+    }
+};
+
+/**
+ * @brief 单个线程的指标
+ */
+struct ThreadMetrics {
+    size_t threadId = 0;                 ///< 线程ID
+    std::string name;                    ///< 线程名称
+    std::string type;                    ///< 工作者类型
+    ThreadState state = ThreadState::STOPPED; ///< 快照时的状态
+    WorkerMetricsSnapshot metrics;       ///< 工作者指标
+};
+
+/**
+ * @brief 所有线程的指标快照
+ */
+struct MetricsSnapshot {
+    std::vector<ThreadMetrics> threads;   ///< 每个线程的指标
+    WorkerMetricsSnapshot total;          ///< 所有线程的汇总，百分位按合并后的直方图计算
+    HistogramSnapshot callbackLatency;    ///< 合并后的回调延迟直方图
+};
+
+/**
+ * @brief 关闭时如何处理线程池中排队的任务
+ */
+enum class ShutdownMode {
+    DRAIN,  ///< 执行完排队的任务
+    ABORT   ///< 丢弃可以丢弃的排队任务，submit() 返回的 Future 收到 OperationCancelled
+};
+
+/**
+ * @brief 关闭选项
+ */
+struct ShutdownOptions {
+    ShutdownMode mode = ShutdownMode::DRAIN;
+    std::chrono::milliseconds timeout = std::chrono::milliseconds::max(); ///< 整个关闭过程的时限，默认不限
+
+    /**
+     * @brief 执行完排队任务，最多等待 timeout
+     */
+    static ShutdownOptions drain(std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
+        ShutdownOptions options;
+        options.timeout = timeout;
+        return options;
+    }
+
+    /**
+     * @brief 丢弃排队任务，最多等待 timeout
+     */
+    static ShutdownOptions abort(std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
+        ShutdownOptions options;
+        options.mode = ShutdownMode::ABORT;
+        options.timeout = timeout;
+        return options;
+    }
+};
 
-    ThreadInfo(std::string n = "") : name(std::move(n)) {}
+/**
+ * @brief 截止时间前没有结束的工作者
+ */
+struct ShutdownStraggler {
+    size_t threadId = 0;                 ///< 线程ID
+    std::string name;                    ///< 线程名称
+    std::string type;                    ///< 工作者类型
+    ThreadState state = ThreadState::STOPPED; ///< 截止时的状态
+};
+
+/**
+ * @brief 关闭结果
+ */
+struct ShutdownReport {
+    size_t finishedWorkers = 0;          ///< 关闭期间结束的工作者数
+    uint64_t discardedTasks = 0;         ///< ABORT 模式下丢弃的任务数
+    bool poolDrained = true;             ///< 截止时线程池是否已空闲
+    std::chrono::nanoseconds elapsed{0}; ///< 关闭耗时
+    std::vector<ShutdownStraggler> stragglers; ///< 截止时仍未结束的工作者，仍由管理器持有
+
+    /**
+     * @brief 是否在截止时间前全部结束
+     */
+    bool completed() const {
+        return stragglers.empty() && poolDrained;
+    }
 };
 
 /**
@@ -37,22 +247,32 @@ public:
      * @brief 构造函数
      *
      * @param maxThreads 最大线程数限制，0表示无限制
+     * @param mode 执行模式，池化模式下线程池大小为硬件核心数
+     * @param poolOptions 线程池选项，池化模式和 submit()/parallelFor() 使用的线程池按此创建
      */
-    explicit ThreadManager(size_t maxThreads = 0) : maxThreads_(maxThreads) {}
+    explicit ThreadManager(size_t maxThreads = 0, ExecutionMode mode = ExecutionMode::DEDICATED_THREAD,
+                           const PoolOptions& poolOptions = PoolOptions())
+        : maxThreads_(maxThreads), mode_(mode), poolOptions_(poolOptions) {
+        if (mode_ == ExecutionMode::POOLED) {
+            getTaskPool();
+        }
+    }
 
     /**
      * @brief 析构函数
      *
-     * 自动停止所有线程并清理资源
+     * 自动停止所有线程并清理资源，等同于不限时的 shutdown()
      */
     ~ThreadManager() {
-        stopAll();
-        waitForAll();
+        shutdown();
     }
 
     /**
      * @brief 添加线程工作者工厂
      *
+     * 工厂重写了 resetWorker() 时，它创建的工作者结束并被清理后会放回该类型的空闲列表，
+     * 之后的 createThread() 优先复用它们。
+     *
      * @param factory 工厂对象的智能指针
      * @param type 工厂类型名称，用于后续创建线程
      * @return true 添加成功
@@ -65,18 +285,49 @@ public:
             return false; // 类型已存在
         }
 
-        factories_[type] = std::move(factory);
+        auto slot = std::make_unique<detail::FactorySlot>();
+        slot->factory = std::move(factory);
+        factories_[type] = std::move(slot);
+        return true;
+    }
+
+    /**
+     * @brief 获取工厂类型的回收统计
+     *
+     * @param type 工厂类型名称
+     * @param stats 输出参数
+     * @return true 获取成功
+     * @return false 工厂类型不存在
+     */
+    bool getRecycleStats(const std::string& type, RecycleStats& stats) const {
+        std::lock_guard<std::mutex> lock(factoriesMutex_);
+        auto it = factories_.find(type);
+        if (it == factories_.end()) {
+            return false;
+        }
+
+        detail::FactorySlot& slot = *it->second;
+        stats.hits = slot.hits.load(std::memory_order_relaxed);
+        stats.misses = slot.misses.load(std::memory_order_relaxed);
+        stats.recycled = slot.recycled.load(std::memory_order_relaxed);
+        stats.discarded = slot.discarded.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> idleLock(slot.mutex);
+        stats.idle = slot.idle.size();
         return true;
     }
 
     /**
      * @brief 创建并启动线程
      *
+     * 该类型有空闲的回收工作者时直接复用，不调用工厂的 createWorker() 和工作者的 onInitialize()。
+     *
      * @param type 工厂类型名称
      * @param name 线程名称，如果为空则自动生成
+     * @param options 启动选项，请求了放置或调度设置时工作者总是运行在独占线程上
      * @return size_t 线程ID，如果创建失败返回 SIZE_MAX
      */
-    size_t createThread(const std::string& type, const std::string& name = "") {
+    size_t createThread(const std::string& type, const std::string& name = "",
+                        const ThreadLaunchOptions& options = ThreadLaunchOptions()) {
         std::lock_guard<std::mutex> lock(factoriesMutex_);
 
         auto it = factories_.find(type);
@@ -85,16 +336,32 @@ public:
         }
 
         // 检查线程数限制
-        if (maxThreads_ > 0 && threads_.size() >= maxThreads_) {
+        if (maxThreads_ > 0 && registry_.size() >= maxThreads_) {
             return SIZE_MAX; // 达到最大线程数限制
         }
 
-        auto worker = it->second->createWorker();
-        if (!worker) {
-            return SIZE_MAX; // 创建工作者失败
+        detail::FactorySlot& slot = *it->second;
+        WorkerPtr worker;
+        {
+            std::lock_guard<std::mutex> idleLock(slot.mutex);
+            if (!slot.idle.empty()) {
+                worker = std::move(slot.idle.back());
+                slot.idle.pop_back();
+            }
+        }
+        bool reused = worker != nullptr;
+        if (reused) {
+            slot.hits.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            slot.misses.fetch_add(1, std::memory_order_relaxed);
+            worker = WorkerPtr(slot.factory->createWorker());
+            if (!worker) {
+                return SIZE_MAX; // 创建工作者失败
+            }
         }
 
-        return startWorker(std::move(worker), name.empty() ? type + "_" + std::to_string(nextId_++) : name);
+        return startWorker(std::move(worker), name.empty() ? type + "_" + std::to_string(nextId_++) : name,
+                           options, &slot, reused);
     }
 
     /**
@@ -102,41 +369,391 @@ public:
      *
      * @param worker 工作者对象的智能指针
      * @param name 线程名称
+     * @param options 启动选项，请求了放置或调度设置时工作者总是运行在独占线程上
      * @return size_t 线程ID，如果创建失败返回 SIZE_MAX
      */
-    size_t createThreadWithWorker(std::unique_ptr<IThreadWorker> worker, const std::string& name = "") {
+    size_t createThreadWithWorker(std::unique_ptr<IThreadWorker> worker, const std::string& name = "",
+                                  const ThreadLaunchOptions& options = ThreadLaunchOptions()) {
         if (!worker) {
             return SIZE_MAX;
         }
 
         // 检查线程数限制
-        if (maxThreads_ > 0 && threads_.size() >= maxThreads_) {
+        if (maxThreads_ > 0 && registry_.size() >= maxThreads_) {
+            return SIZE_MAX;
+        }
+
+        std::string threadName = name.empty() ? worker->getType() + "_" + std::to_string(nextId_++) : name;
+        return startWorker(WorkerPtr(std::move(worker)), std::move(threadName), options);
+    }
+
+    /**
+     * @brief 在管理器的内存池中直接构造工作者并启动
+     *
+     * 不超过 WorkerArena::MAX_BLOCK_SIZE 的工作者从按大小分级的内存池分配，回收后内存块直接复用；
+     * 名称可以是驻留名称（只复制一个指针）或匿名（不生成名称，也不设置系统线程名）。
+     *
+     * @code
+     * static const WorkerName name = WorkerName::interned("ingest");
+     * manager.createThreadWithWorker(std::in_place_type<TaskWorker>, name, ThreadLaunchOptions(), job);
+     * @endcode
+     *
+     * @tparam W 工作者类型
+     * @param name 线程名称
+     * @param options 启动选项
+     * @param args 工作者的构造参数
+     * @return size_t 线程ID，如果创建失败返回 SIZE_MAX
+     */
+    template <typename W, typename... Args>
+    size_t createThreadWithWorker(std::in_place_type_t<W>, WorkerName name, const ThreadLaunchOptions& options,
+                                  Args&&... args) {
+        static_assert(std::is_base_of<IThreadWorker, W>::value, "W must derive from IThreadWorker");
+
+        // 检查线程数限制
+        if (maxThreads_ > 0 && registry_.size() >= maxThreads_) {
+            return SIZE_MAX;
+        }
+
+        return startWorker(arena_.create<W>(std::forward<Args>(args)...), std::move(name), options);
+    }
+
+    /**
+     * @brief 获取工作者内存池
+     */
+    const WorkerArena& getWorkerArena() const {
+        return arena_;
+    }
+
+    /**
+     * @brief 批量创建并启动线程
+     *
+     * 所有工作者在一次登记操作中加入线程登记表，池化的工作者一次性提交到线程池。
+     * 范围中的工作者会被移走；任何一个为空或超出最大线程数时整批失败。
+     *
+     * @param first 工作者智能指针范围的起点
+     * @param last 工作者智能指针范围的终点
+     * @param namePrefix 线程名称前缀，为空时使用工作者类型名称
+     * @param options 所有成员共用的启动选项
+     * @return size_t 线程组ID，用于 waitForGroup()，如果创建失败返回 SIZE_MAX
+     */
+    template <typename Iterator>
+    size_t createThreadsWithWorkers(Iterator first, Iterator last, const std::string& namePrefix = "",
+                                    const ThreadLaunchOptions& options = ThreadLaunchOptions()) {
+        std::vector<std::unique_ptr<IThreadWorker>> workers;
+        for (; first != last; ++first) {
+            if (!*first) {
+                return SIZE_MAX;
+            }
+            workers.push_back(std::move(*first));
+        }
+        if (workers.empty()) {
+            return SIZE_MAX;
+        }
+
+        // 检查线程数限制
+        if (maxThreads_ > 0 && registry_.size() + workers.size() > maxThreads_) {
             return SIZE_MAX;
         }
 
-        return startWorker(std::move(worker), name.empty() ? worker->getType() + "_" + std::to_string(nextId_++) : name);
+        size_t count = workers.size();
+        std::vector<LaunchPlan> plans;
+        std::vector<WorkerName> names;
+        plans.reserve(count);
+        names.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            plans.push_back(prepareWorker(*workers[i], options));
+            names.push_back(namePrefix.empty() ? workers[i]->getType() + "_" + std::to_string(nextId_++)
+                                               : namePrefix + "_" + std::to_string(i));
+        }
+
+        auto group = std::make_shared<ThreadGroup>(count);
+        std::vector<ThreadInfo*> entries(count, nullptr);
+        std::vector<size_t> ids;
+        size_t registered = registry_.insertBatch(count, [&](size_t i, ThreadInfo& entry) {
+            fillEntry(entry, WorkerPtr(std::move(workers[i])), std::move(names[i]), plans[i], group);
+            entries[i] = &entry;
+        }, ids);
+        group->latch.countDown(count - registered); // 登记表已满，未登记的成员
+
+        std::vector<PoolTask*> tasks;
+        group->threadIds.reserve(registered);
+        for (size_t i = 0; i < registered; ++i) {
+            if (launchEntry(ids[i], *entries[i], plans[i], &tasks)) {
+                group->threadIds.push_back(ids[i]);
+            }
+        }
+        if (!tasks.empty()) {
+            pool_->submitBatch(tasks.data(), tasks.size(), options.taskOptions);
+        }
+
+        std::lock_guard<std::mutex> lock(groupsMutex_);
+        size_t groupId = nextGroupId_++;
+        groups_.emplace(groupId, std::move(group));
+        return groupId;
+    }
+
+    /**
+     * @brief 批量创建并启动线程
+     *
+     * @param workers 工作者列表
+     * @param namePrefix 线程名称前缀，为空时使用工作者类型名称
+     * @param options 所有成员共用的启动选项
+     * @return size_t 线程组ID，如果创建失败返回 SIZE_MAX
+     */
+    size_t createThreadsWithWorkers(std::vector<std::unique_ptr<IThreadWorker>> workers,
+                                    const std::string& namePrefix = "",
+                                    const ThreadLaunchOptions& options = ThreadLaunchOptions()) {
+        return createThreadsWithWorkers(workers.begin(), workers.end(), namePrefix, options);
+    }
+
+    /**
+     * @brief 等待线程组的所有成员完成
+     *
+     * 成员完成时只做一次原子减法，最后一个成员完成时才唤醒等待方。
+     * 返回后回收已完成的成员，线程组ID失效。
+     *
+     * @param groupId 线程组ID
+     * @return true 所有成员已完成
+     * @return false 线程组不存在
+     */
+    bool waitForGroup(size_t groupId) {
+        std::shared_ptr<ThreadGroup> group;
+        {
+            std::lock_guard<std::mutex> lock(groupsMutex_);
+            auto it = groups_.find(groupId);
+            if (it == groups_.end()) {
+                return false;
+            }
+            group = it->second;
+        }
+
+        group->latch.wait();
+
+        {
+            std::lock_guard<std::mutex> lock(groupsMutex_);
+            groups_.erase(groupId);
+        }
+        for (size_t id : group->threadIds) {
+            retireIfFinished(id);
+        }
+        return true;
+    }
+
+    /**
+     * @brief 获取线程组的成员线程ID
+     *
+     * @param groupId 线程组ID
+     * @return std::vector<size_t> 成员线程ID，线程组不存在时为空
+     */
+    std::vector<size_t> getGroupThreadIds(size_t groupId) const {
+        std::lock_guard<std::mutex> lock(groupsMutex_);
+        auto it = groups_.find(groupId);
+        if (it == groups_.end()) {
+            return {};
+        }
+        return it->second->threadIds;
+    }
+
+    /**
+     * @brief 提交一个返回结果的任务
+     *
+     * 任务在线程池中执行，池化模式使用工作者所在的线程池，其它模式在第一次调用时创建线程池。
+     * 参数按值保存，可调用对象、参数和结果共用一次堆分配。
+     *
+     * @param function 可调用对象
+     * @param args 调用参数
+     * @return Future 任务结果，任务抛出的异常在 Future::get() 中重新抛出
+     */
+    template <typename F, typename... Args,
+              typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, TaskOptions>::value>::type>
+    auto submit(F&& function, Args&&... args)
+        -> Future<typename std::invoke_result<typename std::decay<F>::type, typename std::decay<Args>::type...>::type> {
+        return submit(TaskOptions(), std::forward<F>(function), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief 按优先级类别和截止时间提交一个返回结果的任务
+     *
+     * CRITICAL 任务先于其它排队的工作执行，BATCH 任务在没有其它工作时执行；同一类别内截止时间早的先执行。
+     * 各类别的排队深度和等待时间见 getPoolStats().classes。
+     *
+     * @param options 调度选项
+     * @param function 可调用对象
+     * @param args 调用参数
+     * @return Future 任务结果
+     */
+    template <typename F, typename... Args>
+    auto submit(const TaskOptions& options, F&& function, Args&&... args)
+        -> Future<typename std::invoke_result<typename std::decay<F>::type, typename std::decay<Args>::type...>::type> {
+        using R = typename std::invoke_result<typename std::decay<F>::type, typename std::decay<Args>::type...>::type;
+        using State = detail::TaskState<R, typename std::decay<F>::type, typename std::decay<Args>::type...>;
+
+        ThreadPool& pool = getTaskPool();
+        auto* state = new State(&pool, std::forward<F>(function), std::forward<Args>(args)...);
+        if (options.cancellation.canBeCancelled()) {
+            state->setCancellation(options.cancellation);
+        }
+        pool.submit(static_cast<PoolTask*>(state), options);
+        return Future<R>(state);
+    }
+
+    /**
+     * @brief 创建结果写入端
+     *
+     * 不是由 submit() 产生的结果（例如工作者的处理结果）通过它交给 Future，延续在线程池中执行。
+     *
+     * @return Promise 新的写入端
+     */
+    template <typename R>
+    Promise<R> makePromise() {
+        return Promise<R>(getTaskPool());
+    }
+
+    /**
+     * @brief 创建带超时的取消源
+     *
+     * 与直接构造 CancellationSource 不同，到达截止时间时由共享定时服务触发取消，
+     * 注册在令牌上的回调（例如停止工作者、唤醒队列等待）按时执行，而不只是在下一次检查时才发现超时。
+     *
+     * @param timeout 超时时长
+     * @param parent 父令牌，取消它会取消新的源
+     * @return CancellationSource 新的取消源
+     */
+    template <typename Rep, typename Period>
+    CancellationSource makeCancellationSource(const std::chrono::duration<Rep, Period>& timeout,
+                                              const CancellationToken& parent = CancellationToken()) {
+        CancellationSource source(parent, timeout);
+        armDeadline(source.getToken());
+        return source;
+    }
+
+    /**
+     * @brief 并行循环
+     *
+     * 对区间 [begin, end) 中的每个下标调用 function(i)，区间在线程池中按需拆分。
+     * 调用方阻塞到全部完成，等待期间帮助执行线程池中的任务，因此也可以在池线程中嵌套调用。
+     *
+     * @param begin 起始下标
+     * @param end 结束下标（不包含）
+     * @param grain 最小块大小，0表示按区间大小和池线程数自动选择
+     * @param function 循环体，参数为下标
+     * @param progress 可选的进度对象，其它线程可以通过 getProgress() 查看完成比例
+     * @throws 循环体抛出的第一个异常，在所有块结束后重新抛出
+     */
+    template <typename F>
+    void parallelFor(size_t begin, size_t end, size_t grain, F&& function, ParallelProgress* progress = nullptr) {
+        auto body = [&function](size_t chunkBegin, size_t chunkEnd) {
+            for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+                function(i);
+            }
+        };
+        detail::runParallelLoop(getTaskPool(), begin, end, grain, body, progress);
+    }
+
+    /**
+     * @brief 并行归约
+     *
+     * 计算 combine(...combine(identity, map(begin))..., map(end - 1))。每个池线程先在本地累积，
+     * 最后合并各线程的部分结果，因此 combine 必须满足结合律和交换律，identity 必须是单位元。
+     *
+     * @param begin 起始下标
+     * @param end 结束下标（不包含）
+     * @param grain 最小块大小，0表示自动选择
+     * @param identity 单位元
+     * @param map 映射函数，参数为下标，返回 T
+     * @param combine 合并函数，参数为 (T, T)，返回 T
+     * @param progress 可选的进度对象
+     * @return T 归约结果
+     */
+    template <typename T, typename Map, typename Combine>
+    T parallelReduce(size_t begin, size_t end, size_t grain, T identity, Map&& map, Combine&& combine,
+                     ParallelProgress* progress = nullptr) {
+        ThreadPool& pool = getTaskPool();
+        size_t outside = pool.getMaxThreadCount();
+        std::vector<detail::ReducePartial<T>> partials(outside + 1, detail::ReducePartial<T>{identity});
+        std::mutex outsideMutex; // 池外线程共用最后一个部分结果
+
+        auto body = [&](size_t chunkBegin, size_t chunkEnd) {
+            T local = identity;
+            for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+                local = combine(std::move(local), map(i));
+            }
+
+            size_t index = pool.getCurrentThreadIndex();
+            if (index < outside) {
+                partials[index].value = combine(std::move(partials[index].value), std::move(local));
+            } else {
+                std::lock_guard<std::mutex> lock(outsideMutex);
+                partials[outside].value = combine(std::move(partials[outside].value), std::move(local));
+            }
+        };
+        detail::runParallelLoop(pool, begin, end, grain, body, progress);
+
+        T result = std::move(identity);
+        for (auto& partial : partials) {
+            result = combine(std::move(result), std::move(partial.value));
+        }
+        return result;
+    }
+
+    /**
+     * @brief 在线程池上执行任务依赖图并等待完成
+     *
+     * 每个节点在所有前驱完成后立即执行，等待期间帮助执行池中的任务，可以在池线程中嵌套调用。
+     *
+     * @param graph 任务依赖图
+     * @throws std::logic_error 图包含环或正在执行
+     * @throws 第一个失败节点抛出的异常
+     */
+    void runGraph(TaskGraph& graph) {
+        graph.run(getTaskPool());
+    }
+
+    /**
+     * @brief 在线程池上启动任务依赖图，不等待
+     *
+     * @param graph 任务依赖图，必须比本次执行活得更久
+     * @return Future<void> 执行完成时就绪，携带第一个失败节点的异常
+     * @throws std::logic_error 图包含环或正在执行
+     */
+    Future<void> submitGraph(TaskGraph& graph) {
+        return graph.submit(getTaskPool());
     }
 
     /**
      * @brief 停止指定线程
      *
+     * 等待线程退出时不持有任何登记表锁，其它查询不会被阻塞。
+     * 还在线程池队列中的工作者不等待：轮到它时 run() 会立即观察到停止请求，
+     * 否则池线程被暂停的工作者占住时，停止排在后面的工作者会一直阻塞。
+     *
      * @param threadId 线程ID
      * @return true 停止成功
      * @return false 停止失败（线程不存在或已停止）
      */
     bool stopThread(size_t threadId) {
-        std::lock_guard<std::mutex> lock(threadsMutex_);
-
-        auto it = threads_.find(threadId);
-        if (it == threads_.end()) {
+        auto info = registry_.acquire(threadId);
+        if (!info) {
             return false;
         }
 
-        auto& info = it->second;
-        info.worker->onStop();
+        signalStop(*info);
 
-        if (info.thread && info.thread->joinable()) {
-            info.thread->join();
+        if (info->pooled && !info->started.load()) {
+            return true; // 停止请求已在开始执行之前发出
+        }
+
+        if (info->sharesThread()) {
+            // 池线程和定时服务线程不能被join，等待工作者执行完毕
+            ThreadInfo* entry = info.get();
+            std::unique_lock<std::mutex> lock(threadsMutex_);
+            stopWaiters_++;
+            condition_.wait(lock, [entry]() {
+                return entry->started.load() && !entry->running.load();
+            });
+            stopWaiters_--;
+        } else {
+            joinThread(*info);
         }
 
         return true;
@@ -150,16 +767,15 @@ public:
      * @return false 暂停失败
      */
     bool pauseThread(size_t threadId) {
-        std::lock_guard<std::mutex> lock(threadsMutex_);
-
-        auto it = threads_.find(threadId);
-        if (it == threads_.end()) {
+        auto info = registry_.acquire(threadId);
+        if (!info) {
             return false;
         }
 
-        auto& info = it->second;
-        if (info.worker->isRunning()) {
-            info.worker->onPause();
+        if (info->worker->isRunning()) {
+            info->worker->requestPause();
+            info->worker->onPause();
+            info->worker->wakeAsync();
             return true;
         }
 
@@ -174,16 +790,15 @@ public:
      * @return false 恢复失败
      */
     bool resumeThread(size_t threadId) {
-        std::lock_guard<std::mutex> lock(threadsMutex_);
-
-        auto it = threads_.find(threadId);
-        if (it == threads_.end()) {
+        auto info = registry_.acquire(threadId);
+        if (!info) {
             return false;
         }
 
-        auto& info = it->second;
-        if (info.worker->isPaused()) {
-            info.worker->onResume();
+        if (info->worker->isPaused() || info->worker->isPauseRequested()) {
+            info->worker->requestResume();
+            info->worker->onResume();
+            info->worker->wakeAsync();
             return true;
         }
 
@@ -194,48 +809,121 @@ public:
      * @brief 停止所有线程
      */
     void stopAll() {
-        std::lock_guard<std::mutex> lock(threadsMutex_);
-
-        for (auto& pair : threads_) {
-            auto& info = pair.second;
+        // 先向所有工作者广播停止请求，再逐个调用停止回调
+        registry_.forEach([](size_t, ThreadInfo& info) {
+            info.worker->requestStop();
+        });
+        registry_.forEach([this](size_t, ThreadInfo& info) {
+            if (info.timerDriven) {
+                timerService_->fireNow(info.timerId.load());
+            }
+        });
+        registry_.forEach([](size_t, ThreadInfo& info) {
             info.worker->onStop();
-        }
+        });
+        registry_.forEach([](size_t, ThreadInfo& info) {
+            info.worker->wakeAsync();
+        });
     }
 
     /**
-     * @brief 等待所有线程完成
+     * @brief 停止所有工作者并在时限内等待它们结束
+     *
+     * 先向所有工作者广播停止请求（同 stopAll()），再等待线程池处理完排队的任务（ABORT 模式下丢弃它们），
+     * 最后等待所有工作者结束，三步共用 options.timeout。到达时限时不再等待，
+     * 没有结束的工作者列在报告中，它们仍由管理器持有，析构函数会继续等待；
+     * 需要在时限内退出进程时，调用方可以根据报告自行决定（例如记录后直接退出）。
+     * 已结束的工作者被清理。关闭期间新创建的工作者不保证被停止。
+     *
+     * @param options 关闭模式和时限
+     * @return ShutdownReport 结束的工作者数、丢弃的任务数和未结束的工作者
      */
-    void waitForAll() {
-        std::unique_lock<std::mutex> lock(threadsMutex_);
+    ShutdownReport shutdown(const ShutdownOptions& options = ShutdownOptions()) {
+        auto start = std::chrono::steady_clock::now();
+        auto deadline = options.timeout >= std::chrono::duration_cast<std::chrono::milliseconds>(
+                                              std::chrono::steady_clock::time_point::max() - start)
+                            ? std::chrono::steady_clock::time_point::max()
+                            : start + options.timeout;
+
+        ShutdownReport report;
+        size_t unfinished = unfinished_.load();
+        ThreadPool* pool = poolCreated_.load() ? pool_.get() : nullptr;
+        uint64_t discardedBefore = 0;
+        if (pool && options.mode == ShutdownMode::ABORT) {
+            discardedBefore = pool->getStats().discardedTasks;
+            pool->setDiscardQueued(true);
+        }
 
-        // 首先等待所有线程启动
-        condition_.wait(lock, [this]() {
-            return allThreadsStarted();
-        });
+        stopAll();
 
-        // 然后等待所有线程完成
-        condition_.wait(lock, [this]() {
-            return allThreadsFinished();
+        if (pool) {
+            report.poolDrained = pool->waitForIdle(deadline);
+        }
+        {
+            std::unique_lock<std::mutex> lock(threadsMutex_);
+            auto done = [this]() { return unfinished_.load() == 0; };
+            if (deadline == std::chrono::steady_clock::time_point::max()) {
+                condition_.wait(lock, done);
+            } else {
+                condition_.wait_until(lock, deadline, done);
+            }
+        }
+
+        registry_.forEach([&report](size_t threadId, const ThreadInfo& info) {
+            if (info.started.load() && !info.running.load()) {
+                return;
+            }
+            ShutdownStraggler straggler;
+            straggler.threadId = threadId;
+            straggler.name = info.name.isAnonymous() ? anonymousName() : info.name.str();
+            straggler.type = info.worker->getType();
+            straggler.state = info.worker->getState();
+            report.stragglers.push_back(std::move(straggler));
         });
+        size_t remaining = unfinished_.load();
+        report.finishedWorkers = unfinished > remaining ? unfinished - remaining : 0;
 
-        // 清理已完成的线程
-        cleanupFinishedThreadsUnsafe();
+        cleanupFinishedThreads();
+
+        if (pool && options.mode == ShutdownMode::ABORT) {
+            pool->setDiscardQueued(false);
+            report.discardedTasks = pool->getStats().discardedTasks - discardedBefore;
+        }
+        report.elapsed = std::chrono::steady_clock::now() - start;
+        return report;
+    }
+
+    /**
+     * @brief 等待所有线程完成
+     *
+     * 按未完成计数等待，只在最后一个工作者完成时被唤醒。
+     */
+    void waitForAll() {
+        {
+            std::unique_lock<std::mutex> lock(threadsMutex_);
+            condition_.wait(lock, [this]() {
+                return unfinished_.load() == 0;
+            });
+        }
+
+        // 清理已完成的线程，join在锁外进行
+        cleanupFinishedThreads();
     }
 
     /**
      * @brief 获取活跃线程数量
      *
+     * 无锁遍历登记表，不会被创建、停止或清理操作阻塞。
+     *
      * @return size_t 活跃线程数量
      */
     size_t getActiveThreadCount() const {
-        std::lock_guard<std::mutex> lock(threadsMutex_);
-
         size_t count = 0;
-        for (const auto& pair : threads_) {
-            if (pair.second.worker->isRunning() || pair.second.worker->isPaused()) {
+        registry_.forEach([&count](size_t, const ThreadInfo& info) {
+            if (info.worker->isRunning() || info.worker->isPaused()) {
                 count++;
             }
-        }
+        });
         return count;
     }
 
@@ -245,8 +933,7 @@ public:
      * @return size_t 总线程数量
      */
     size_t getTotalThreadCount() const {
-        std::lock_guard<std::mutex> lock(threadsMutex_);
-        return threads_.size();
+        return registry_.size();
     }
 
     /**
@@ -256,24 +943,12 @@ public:
      * @return std::string 状态信息，如果线程不存在返回空字符串
      */
     std::string getThreadStatus(size_t threadId) const {
-        std::lock_guard<std::mutex> lock(threadsMutex_);
-
-        auto it = threads_.find(threadId);
-        if (it == threads_.end()) {
+        auto info = registry_.acquire(threadId);
+        if (!info) {
             return "";
         }
 
-        const auto& info = it->second;
-        std::string stateStr;
-
-        switch (info.worker->getState()) {
-            case ThreadState::RUNNING: stateStr = "RUNNING"; break;
-            case ThreadState::STOPPED: stateStr = "STOPPED"; break;
-            case ThreadState::PAUSED: stateStr = "PAUSED"; break;
-            case ThreadState::FINISHED: stateStr = "FINISHED"; break;
-        }
-
-        return info.name + " [" + info.worker->getType() + "]: " + stateStr;
+        return formatStatus(*info);
     }
 
     /**
@@ -282,21 +957,160 @@ public:
      * @return std::vector<std::string> 所有线程的状态信息
      */
     std::vector<std::string> getAllThreadStatus() const {
-        std::lock_guard<std::mutex> lock(threadsMutex_);
-
         std::vector<std::string> status;
-        for (const auto& pair : threads_) {
-            status.push_back(getThreadStatus(pair.first));
-        }
+        registry_.forEach([this, &status](size_t, const ThreadInfo& info) {
+            status.push_back(formatStatus(info));
+        });
         return status;
     }
 
+    /**
+     * @brief 把所有线程的状态写入预先分配的数组
+     *
+     * 无锁遍历登记表，不构造字符串，也不分配内存（每种工作者类型第一次出现时登记一次类型名称除外）。
+     * 返回值大于 capacity 时只写入了前 capacity 条，调用方可以扩大数组后重试。
+     *
+     * @param records 输出数组
+     * @param capacity 数组容量
+     * @return size_t 遍历到的线程数
+     */
+    size_t captureStatus(ThreadStatusRecord* records, size_t capacity) const {
+        size_t count = 0;
+        registry_.forEach([records, capacity, &count](size_t id, const ThreadInfo& info) {
+            if (count < capacity) {
+                fillStatusRecord(id, info, records[count]);
+            }
+            count++;
+        });
+        return count;
+    }
+
+    /**
+     * @brief 把所有线程的状态写入数组，必要时扩大数组
+     *
+     * 数组容量足够时不分配内存，适合以同一个数组周期性采集。
+     *
+     * @param records 输出数组，大小调整为线程数
+     * @return size_t 线程数
+     */
+    size_t captureStatus(std::vector<ThreadStatusRecord>& records) const {
+        records.resize(records.capacity());
+        size_t count = captureStatus(records.data(), records.size());
+        while (count > records.size()) {
+            records.resize(count + count / 4 + 16);
+            count = captureStatus(records.data(), records.size());
+        }
+        records.resize(count);
+        return count;
+    }
+
+    /**
+     * @brief 开始记录执行跟踪
+     *
+     * 开始 Tracer 的新会话（丢弃上一次的事件），并登记当前所有工作者的名称。
+     * 跟踪是进程级的，多个管理器共享同一个会话。
+     *
+     * @param eventsPerThread 每个线程最多记录的事件数，超出的事件被丢弃
+     */
+    void startTracing(size_t eventsPerThread = Tracer::DEFAULT_EVENTS_PER_THREAD) {
+        Tracer::instance().start(eventsPerThread);
+        registry_.forEach([](size_t threadId, ThreadInfo& info) {
+            nameTracedWorker(threadId, info);
+        });
+    }
+
+    /**
+     * @brief 停止记录执行跟踪，已记录的事件保留到下一次 startTracing()
+     */
+    void stopTracing() {
+        Tracer::instance().stop();
+    }
+
+    /**
+     * @brief 以 Chrome trace 格式导出跟踪，可以用 chrome://tracing 或 Perfetto 打开
+     */
+    void writeTrace(std::ostream& out) const {
+        Tracer::instance().writeChromeTrace(out);
+    }
+
+    /**
+     * @brief 把跟踪导出到文件
+     *
+     * @param path 文件路径
+     * @return true 导出成功
+     * @return false 文件无法写入
+     */
+    bool writeTrace(const std::string& path) const {
+        return Tracer::instance().writeChromeTrace(path);
+    }
+
+    /**
+     * @brief 获取指定线程的指标
+     *
+     * @param threadId 线程ID
+     * @param metrics 输出参数
+     * @return true 获取成功
+     * @return false 线程不存在
+     */
+    bool getThreadMetrics(size_t threadId, WorkerMetricsSnapshot& metrics) const {
+        auto info = registry_.acquire(threadId);
+        if (!info) {
+            return false;
+        }
+
+        metrics = info->worker->getMetrics().snapshot();
+        return true;
+    }
+
+    /**
+     * @brief 获取所有线程的指标快照
+     *
+     * 无锁遍历登记表并以 relaxed 方式读取计数器，不会暂停任何工作者；
+     * 不同线程的数据不是同一时刻的严格快照。已被清理的线程不包含在内。
+     *
+     * @return MetricsSnapshot 指标快照
+     */
+    MetricsSnapshot getMetricsSnapshot() const {
+        MetricsSnapshot snapshot;
+        registry_.forEach([&snapshot](size_t id, const ThreadInfo& info) {
+            ThreadMetrics thread;
+            thread.threadId = id;
+            thread.name = info.name.str();
+            thread.type = info.worker->getType();
+            thread.state = info.worker->getState();
+
+            HistogramSnapshot latency;
+            thread.metrics = info.worker->getMetrics().snapshot(&latency);
+            snapshot.total.accumulate(thread.metrics);
+            snapshot.callbackLatency.merge(latency);
+            snapshot.threads.push_back(std::move(thread));
+        });
+
+        snapshot.total.callbackP50Ns = snapshot.callbackLatency.getPercentile(50.0);
+        snapshot.total.callbackP90Ns = snapshot.callbackLatency.getPercentile(90.0);
+        snapshot.total.callbackP99Ns = snapshot.callbackLatency.getPercentile(99.0);
+        return snapshot;
+    }
+
     /**
      * @brief 清理已完成的线程
+     *
+     * 先无锁收集已完成的条目，再逐个回收；回收时join已退出的线程。
      */
     void cleanupFinishedThreads() {
-        std::lock_guard<std::mutex> lock(threadsMutex_);
-        cleanupFinishedThreadsUnsafe();
+        std::vector<size_t> finished;
+        registry_.forEach([&finished](size_t id, const ThreadInfo& info) {
+            if (!info.running.load() && info.worker->isFinished()) {
+                finished.push_back(id);
+            }
+        });
+
+        for (size_t id : finished) {
+            registry_.retire(id, [this](ThreadInfo& info) {
+                joinThread(info);
+                recycleWorker(info);
+            });
+        }
     }
 
     /**
@@ -317,107 +1131,561 @@ public:
         return maxThreads_;
     }
 
+    /**
+     * @brief 获取执行模式
+     *
+     * @return ExecutionMode 当前执行模式
+     */
+    ExecutionMode getExecutionMode() const {
+        return mode_;
+    }
+
+    /**
+     * @brief 获取线程池大小
+     *
+     * @return size_t 正在运行的池线程数量（弹性线程池会随负载变化），线程池尚未创建时返回0
+     */
+    size_t getPoolThreadCount() const {
+        return poolCreated_.load() ? pool_->getThreadCount() : 0;
+    }
+
+    /**
+     * @brief 获取线程池统计信息
+     *
+     * 包含每个池线程的执行、窃取和空闲计数，线程池尚未创建时返回空统计。
+     *
+     * @return PoolStats 线程池统计信息
+     */
+    PoolStats getPoolStats() const {
+        return poolCreated_.load() ? pool_->getStats() : PoolStats{};
+    }
+
+    /**
+     * @brief 获取共享定时服务
+     *
+     * 第一次调用时创建。共享定时服务模式的 TimerWorker/MonitorWorker 注册在这里，
+     * 也可以直接用它注册自定义的定时回调。
+     *
+     * @return TimerService& 共享定时服务
+     */
+    TimerService& getTimerService() {
+        std::call_once(timerServiceOnce_, [this]() {
+            timerService_ = std::make_unique<TimerService>();
+        });
+        return *timerService_;
+    }
+
+    /**
+     * @brief 获取共享事件循环
+     *
+     * 第一次调用时创建，在自己的线程上运行。异步工作者在这里等待文件描述符就绪，
+     * 也可以直接用它注册自定义的描述符回调。
+     *
+     * @return EventLoop& 共享事件循环
+     */
+    EventLoop& getEventLoop() {
+        std::call_once(eventLoopOnce_, [this]() {
+            eventLoop_ = std::make_unique<EventLoopThread>();
+        });
+        return eventLoop_->getLoop();
+    }
+
 private:
-    std::unordered_map<std::string, std::unique_ptr<IThreadWorkerFactory>> factories_;
-    std::unordered_map<size_t, ThreadInfo> threads_;
+    std::unordered_map<std::string, std::unique_ptr<detail::FactorySlot>> factories_; ///< 最先声明，空闲工作者最后销毁
+    friend class ThreadInfo::LaunchTask;
+
+    WorkerArena arena_;                         ///< 工作者内存池，必须比登记表中的工作者活得更久
+    ThreadRegistry<ThreadInfo> registry_;
     mutable std::mutex factoriesMutex_;
-    mutable std::mutex threadsMutex_;
+    mutable std::mutex threadsMutex_;           ///< 只配合 condition_ 用于生命周期通知
     std::condition_variable condition_;
+    std::atomic<size_t> unfinished_{0};         ///< 已登记但尚未完成的工作者数量
+    size_t stopWaiters_ = 0;                    ///< 在 condition_ 上等待单个工作者的 stopThread 调用数，由 threadsMutex_ 保护
+    std::unordered_map<size_t, std::shared_ptr<ThreadGroup>> groups_;
+    mutable std::mutex groupsMutex_;
+    size_t nextGroupId_ = 1;                    ///< 由 groupsMutex_ 保护
     size_t maxThreads_;
+    ExecutionMode mode_;
+    PoolOptions poolOptions_;
     std::atomic<size_t> nextId_{1};
+    std::once_flag poolOnce_;
+    std::atomic<bool> poolCreated_{false};
+    std::unique_ptr<ThreadPool> pool_;          ///< 池化模式或 submit() 使用的线程池
+    std::once_flag timerServiceOnce_;
+    std::unique_ptr<TimerService> timerService_; ///< 共享定时服务，按需创建
+    std::once_flag eventLoopOnce_;
+    std::unique_ptr<EventLoopThread> eventLoop_; ///< 共享事件循环及其线程，按需创建
 
     /**
-     * @brief 启动工作者
+     * @brief 获取线程池，第一次调用时创建
      */
-    size_t startWorker(std::unique_ptr<IThreadWorker> worker, const std::string& name) {
-        size_t threadId = nextId_++;
+    ThreadPool& getTaskPool() {
+        std::call_once(poolOnce_, [this]() {
+            pool_ = std::make_unique<ThreadPool>(poolOptions_);
+            poolCreated_.store(true);
+        });
+        return *pool_;
+    }
 
-        auto info = std::make_unique<ThreadInfo>(name);
-        info->worker = std::move(worker);
-        info->startTime = std::chrono::steady_clock::now();
+    /**
+     * @brief 工作者的启动方式
+     */
+    struct LaunchPlan {
+        std::chrono::milliseconds timerInterval{0};
+        bool timerDriven = false;
+        bool pooled = false;
+        bool async = false;
+        const ThreadLaunchOptions* options = nullptr; ///< 启动选项，在启动期间有效
+    };
 
-        // 初始化工作者
-        info->worker->onInitialize();
+    /**
+     * @brief 初始化工作者并确定启动方式
+     *
+     * 请求了放置或调度设置的工作者需要自己的系统线程，不池化也不交给共享定时服务。
+     * 异步工作者总是在线程池上运行，忽略放置和调度设置，只使用 taskOptions。
+     */
+    LaunchPlan prepareWorker(IThreadWorker& worker, const ThreadLaunchOptions& options, bool reused = false) {
+        const CancellationToken& token =
+            options.cancellation.canBeCancelled() ? options.cancellation : options.taskOptions.cancellation;
+        if (token.canBeCancelled()) {
+            worker.setCancellationToken(token);
+        }
+        if (!reused) {
+            // 回收复用的工作者已经初始化过
+            TF_TRACE_SPAN(TraceKind::INITIALIZE, 0);
+            worker.onInitialize();
+        }
 
-        // 创建并启动线程
-        std::thread newThread([this, threadId]() {
-            auto it = threads_.find(threadId);
-            if (it != threads_.end()) {
-                auto& info = it->second;
+        LaunchPlan plan;
+        plan.options = &options;
+        if (worker.isAsync()) {
+            plan.async = true;
+            getTaskPool();
+            getTimerService();
+            getEventLoop();
+            return plan;
+        }
 
-                // 确认线程已启动
-                info.started.store(true);
-                info.running.store(true);
-                condition_.notify_all(); // 通知线程已启动
+        bool dedicated = options.requestsPlacement();
+        plan.timerInterval = dedicated ? std::chrono::milliseconds(0) : worker.getSharedTimerInterval();
+        plan.timerDriven = plan.timerInterval.count() > 0;
+        plan.pooled = !dedicated && !plan.timerDriven && mode_ == ExecutionMode::POOLED && worker.isPoolable();
+        if (plan.timerDriven) {
+            getTimerService();
+        }
+        return plan;
+    }
 
-                info.worker->onStart();
+    /**
+     * @brief 在登记表的初始化回调中填写条目
+     */
+    void fillEntry(ThreadInfo& entry, WorkerPtr worker, WorkerName&& name,
+                   const LaunchPlan& plan, std::shared_ptr<ThreadGroup> group) {
+        entry.name = std::move(name);
+        entry.worker = std::move(worker);
+        entry.startTime = std::chrono::steady_clock::now();
+        entry.pooled = plan.pooled;
+        entry.timerDriven = plan.timerDriven;
+        entry.async = plan.async;
+        entry.group = std::move(group);
+
+        if (plan.timerDriven) {
+            // 定时服务驱动的工作者没有执行体，登记时即视为已启动
+            entry.started.store(true);
+            entry.running.store(true);
+        }
+        unfinished_.fetch_add(1);
+
+        // 启动之前注册，回调执行期间条目不会被回收；令牌已取消时工作者一开始就观察到停止请求
+        const CancellationToken& token = entry.worker->getCancellationToken();
+        if (token.canBeCancelled()) {
+            ThreadInfo* target = &entry;
+            entry.cancellation = token.onCancel([this, target]() { signalStop(*target); });
+            armDeadline(token);
+        }
+    }
+
+    /**
+     * @brief 向工作者发出停止请求并唤醒它，不等待
+     */
+    void signalStop(ThreadInfo& info) {
+        info.worker->requestStop();
+        info.worker->onStop();
+        info.worker->wakeAsync();
+
+        if (info.timerDriven) {
+            // 让定时器立即触发，工作者在本次回调中观察到停止请求
+            timerService_->fireNow(info.timerId.load());
+        }
+    }
+
+    /**
+     * @brief 到达截止时间时由共享定时服务取消令牌，每个令牌只安排一次
+     */
+    void armDeadline(const CancellationToken& token) {
+        if (!token.hasDeadline() || !token.state_->markDeadlineArmed()) {
+            return;
+        }
+        std::weak_ptr<detail::CancellationState> state = token.state_;
+        getTimerService().scheduleAt(token.getDeadline(), [state]() {
+            if (auto target = state.lock()) {
+                target->cancel(CancellationReason::DEADLINE);
+            }
+        });
+    }
+
+    /**
+     * @brief 启动已登记的条目
+     *
+     * @param batch 不为空时池化任务追加到这里，由调用方批量提交
+     * @return false 创建线程失败，条目已被回收
+     */
+    bool launchEntry(size_t threadId, ThreadInfo& info, const LaunchPlan& plan, std::vector<PoolTask*>* batch) {
+        info.id = threadId;
+#if THREAD_FRAMEWORK_TRACING
+        if (Tracer::isActive()) {
+            nameTracedWorker(threadId, info);
+            if (!plan.timerDriven) {
+                Tracer::instance().record(TraceKind::QUEUED, TracePhase::ASYNC_BEGIN, threadId);
+            }
+        }
+#endif
+
+        if (plan.pooled || plan.async) {
+            // 排队到已有的池线程上执行，任务对象嵌在条目中
+            info.launchTask.manager = this;
+            if (batch) {
+                batch->push_back(&info.launchTask);
+            } else {
+                pool_->submit(&info.launchTask, plan.options->taskOptions);
+            }
+        } else if (plan.timerDriven) {
+            attachTimerWorker(info, plan.timerInterval);
+        } else {
+            // 创建并启动线程，放置和调度设置在新线程开始执行工作者之前应用
+            try {
+                std::lock_guard<std::mutex> lock(info.threadMutex);
+                ThreadInfo* entry = &info;
+                ThreadLaunchOptions options = *plan.options;
+                size_t stackSize = options.stackSize;
+                info.thread = std::make_unique<NativeThread>([this, entry, options]() {
+                    std::string error;
+                    if (!detail::applyThreadOptions(options, entry->name.str(), error)) {
+                        entry->worker->reportError(error);
+                    }
+                    executeWorker(*entry);
+                }, stackSize);
+            } catch (const std::system_error&) {
+                markFinished(info);
+                registry_.retire(threadId, [](ThreadInfo&) {});
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief 启动工作者
+     */
+    size_t startWorker(WorkerPtr worker, WorkerName name, const ThreadLaunchOptions& options,
+                       detail::FactorySlot* recycler = nullptr, bool reused = false) {
+        LaunchPlan plan = prepareWorker(*worker, options, reused);
+
+        // 先登记工作者信息，再启动线程，保证执行体能看到完整的条目
+        ThreadInfo* info = nullptr;
+        size_t threadId = registry_.insert([&](ThreadInfo& entry) {
+            fillEntry(entry, std::move(worker), std::move(name), plan, nullptr);
+            entry.recycler = recycler;
+            info = &entry;
+        });
+        if (threadId == SIZE_MAX) {
+            return SIZE_MAX; // 登记表已满
+        }
 
+        if (!launchEntry(threadId, *info, plan, nullptr)) {
+            return SIZE_MAX; // 创建线程失败
+        }
+        return threadId;
+    }
+
+    /**
+     * @brief 把工作者注册到共享定时服务
+     */
+    void attachTimerWorker(ThreadInfo& info, std::chrono::milliseconds interval) {
+        {
+            TF_TRACE_SPAN(TraceKind::START, info.id);
+            info.worker->onStart();
+        }
+        info.worker->onTimerAttach();
+
+        ThreadInfo* entry = &info;
+        timerService_->schedulePeriodic(interval, [this, entry]() {
+            bool again = false;
+            WorkerMetrics& metrics = entry->worker->getMetrics();
+            metrics.beginRun();
+            {
+                TF_TRACE_WORKER_SCOPE(entry->id);
+                TF_TRACE_SPAN(TraceKind::TIMER_FIRE, entry->id);
+                ScratchScope scratch;
                 try {
-                    info.worker->run();
+                    CancellationScope scope(entry->worker->getCancellationToken());
+                    again = entry->worker->onTimerTick();
                 } catch (const std::exception& e) {
-                    info.worker->onError(e.what());
+                    entry->worker->reportError(e.what());
                 }
+            }
+            metrics.endRun();
 
-                // setState is protected, but the worker should set its own state
-                // We'll let the worker's run() method handle this
-                info.running.store(false);
-                condition_.notify_all(); // 通知线程已完成
+            if (!again) {
+                markFinished(*entry);
             }
+            return again;
+        }, [entry](TimerService::TimerId timerId) {
+            // 定时器进入调度之前公开ID：signalStop() 先请求停止再读ID，这里先写ID再检查停止请求，
+            // 两侧都是 seq_cst，至少一侧能看到对方；已经收到停止请求时立即触发，不必等满一个间隔
+            entry->timerId.store(timerId);
+            return entry->worker->isStopRequested();
         });
+    }
 
-        // 存储工作者信息
-        ThreadInfo& threadInfo = threads_[threadId];
-        threadInfo.worker = std::move(info->worker);
-        threadInfo.startTime = info->startTime;
+    /**
+     * @brief 在当前线程上执行工作者
+     */
+    void executeWorker(ThreadInfo& info) {
+        // 确认线程已启动
+        setLifecycleFlags(info, true, true);
+
+        WorkerMetrics& metrics = info.worker->getMetrics();
+        metrics.recordQueueWait(std::chrono::steady_clock::now() - info.startTime);
+        metrics.beginRun();
+
+        {
+            // 事件的工作者ID在这里读取，markFinished() 之后条目可能已被回收
+            TF_TRACE_WORKER_SCOPE(info.id);
+            TF_TRACE(TraceKind::QUEUED, TracePhase::ASYNC_END, info.id, 0);
+            {
+                TF_TRACE_SPAN(TraceKind::START, info.id);
+                info.worker->onStart();
+            }
 
-        // 设置线程
-        threadInfo.thread = std::make_unique<std::thread>(std::move(newThread));
-        return threadId;
+            TF_TRACE_SPAN(TraceKind::RUN, info.id);
+            try {
+                CancellationScope scope(info.worker->getCancellationToken());
+                info.worker->run();
+            } catch (const std::exception& e) {
+                info.worker->reportError(e.what());
+            }
+        }
+
+        metrics.endRun();
+
+        // setState is protected, but the worker should set its own state
+        // We'll let the worker's run() method handle this
+        markFinished(info);
     }
 
     /**
-     * @brief 检查所有线程是否已启动
+     * @brief 执行从线程池中取出的条目
      */
-    bool allThreadsStarted() const {
-        for (const auto& pair : threads_) {
-            if (!pair.second.started.load()) {
-                return false;
-            }
+    void runLaunched(ThreadInfo& info) {
+        if (info.async) {
+            executeAsyncWorker(info);
+        } else {
+            executeWorker(info);
         }
-        return true;
     }
 
     /**
-     * @brief 检查所有线程是否已完成
+     * @brief 在当前池线程上启动异步工作者
+     *
+     * 工作者调用结束通知时才视为完成，在此之前它在各次等待之间可能换到其它池线程上继续执行。
      */
-    bool allThreadsFinished() const {
-        for (const auto& pair : threads_) {
-            if (pair.second.running.load()) {
-                return false;
+    void executeAsyncWorker(ThreadInfo& info) {
+        setLifecycleFlags(info, true, true);
+
+        WorkerMetrics& metrics = info.worker->getMetrics();
+        metrics.recordQueueWait(std::chrono::steady_clock::now() - info.startTime);
+        metrics.beginRun();
+
+        // 只跟踪启动部分，之后的执行由工作者的回调在各个池线程上完成
+        TF_TRACE_WORKER_SCOPE(info.id);
+        TF_TRACE(TraceKind::QUEUED, TracePhase::ASYNC_END, info.id, 0);
+        {
+            TF_TRACE_SPAN(TraceKind::START, info.id);
+            info.worker->onStart();
+        }
+        TF_TRACE_SPAN(TraceKind::RUN, info.id);
+
+        AsyncContext context;
+        context.pool = pool_.get();
+        context.timers = timerService_.get();
+        context.events = &eventLoop_->getLoop();
+
+        ThreadInfo* entry = &info;
+        try {
+            info.worker->startAsync(context, [this, entry]() {
+                entry->worker->getMetrics().endRun();
+                markFinished(*entry);
+            });
+        } catch (const std::exception& e) {
+            info.worker->reportError(e.what());
+            metrics.endRun();
+            markFinished(info);
+        }
+    }
+
+    /**
+     * @brief 更新条目的启动/运行标志
+     *
+     * 在 threadsMutex_ 内更新，等待方不会错过随后的通知。
+     */
+    void setLifecycleFlags(ThreadInfo& info, bool started, bool running) {
+        std::lock_guard<std::mutex> lock(threadsMutex_);
+        info.started.store(started);
+        info.running.store(running);
+    }
+
+    /**
+     * @brief 标记工作者已完成
+     *
+     * 只在最后一个工作者完成或有 stopThread 等待时才唤醒 condition_ 上的等待方。
+     * 标志更新后条目随时可能被回收，之后不能再访问 info。
+     */
+    void markFinished(ThreadInfo& info) {
+        std::shared_ptr<ThreadGroup> group = info.group;
+        bool notify;
+        {
+            std::lock_guard<std::mutex> lock(threadsMutex_);
+            info.started.store(true);
+            info.running.store(false);
+            notify = unfinished_.fetch_sub(1) == 1 || stopWaiters_ > 0;
+        }
+        if (notify) {
+            condition_.notify_all();
+        }
+        if (group) {
+            group->latch.countDown();
+        }
+    }
+
+    /**
+     * @brief 回收已完成的条目
+     */
+    void retireIfFinished(size_t threadId) {
+        {
+            auto info = registry_.acquire(threadId);
+            if (!info || info->running.load() || !info->worker->isFinished()) {
+                return;
             }
         }
-        return true;
+        registry_.retire(threadId, [this](ThreadInfo& info) {
+            joinThread(info);
+            recycleWorker(info);
+        });
     }
 
     /**
-     * @brief 清理已完成的线程（不使用锁）
+     * @brief join独占线程，可以被多个调用者并发调用
      */
-    void cleanupFinishedThreadsUnsafe() {
-        auto it = threads_.begin();
-        while (it != threads_.end()) {
-            auto& info = it->second;
-            if (!info.running.load() && info.worker->isFinished()) {
-                if (info.thread && info.thread->joinable()) {
-                    info.thread->join();
-                }
-                it = threads_.erase(it);
-            } else {
-                ++it;
+    void joinThread(ThreadInfo& info) {
+        std::lock_guard<std::mutex> lock(info.threadMutex);
+        if (info.thread && info.thread->joinable() && !info.thread->isCurrentThread()) {
+            info.thread->join();
+        }
+    }
+
+    /**
+     * @brief 把已结束条目的工作者放回工厂的空闲列表
+     *
+     * 在回收条目时调用，此时没有其它线程访问条目。工厂不支持重置、重置失败或空闲列表已满时工作者随条目销毁。
+     */
+    static void recycleWorker(ThreadInfo& info) {
+        detail::FactorySlot* slot = info.recycler;
+        if (!slot || !info.worker) {
+            return;
+        }
+
+        // 先注销停止回调，之后取消令牌不会再访问条目中的工作者
+        info.cancellation.unregister();
+        info.worker->resetControlState();
+        bool reusable = false;
+        try {
+            reusable = slot->factory->resetWorker(*info.worker);
+        } catch (const std::exception&) {
+            reusable = false;
+        }
+
+        if (reusable) {
+            std::lock_guard<std::mutex> lock(slot->mutex);
+            if (slot->idle.size() < slot->factory->getRecycleLimit()) {
+                slot->idle.push_back(std::move(info.worker));
+                slot->recycled.fetch_add(1, std::memory_order_relaxed);
+                return;
             }
         }
+        slot->discarded.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 登记工作者在跟踪中显示的名称，匿名工作者使用类型名称
+     */
+    static void nameTracedWorker(size_t threadId, const ThreadInfo& info) {
+        if (info.worker) {
+            Tracer::instance().setWorkerName(threadId, info.name.isAnonymous() ? info.worker->getType() : info.name.str());
+        }
+    }
+
+    /**
+     * @brief 格式化单个条目的状态信息
+     */
+    static std::string formatStatus(const ThreadInfo& info) {
+        const std::string& name = info.name.isAnonymous() ? anonymousName() : info.name.str();
+        return name + " [" + info.worker->getType() + "]: " + getStateName(info.worker->getState());
+    }
+
+    /**
+     * @brief 填写一条状态记录
+     */
+    static void fillStatusRecord(size_t id, const ThreadInfo& info, ThreadStatusRecord& record) {
+        const IThreadWorker& worker = *info.worker;
+        uint32_t typeId = info.typeId.load(std::memory_order_relaxed);
+        if (typeId == 0) {
+            typeId = WorkerTypeTable::intern(worker.getType());
+            info.typeId.store(typeId, std::memory_order_relaxed);
+        }
+
+        WorkerMetricsSnapshot counters = worker.getMetrics().readCounters();
+        record.threadId = id;
+        record.runTimeNs = counters.runTimeNs;
+        record.queueWaitNs = counters.queueWaitNs;
+        record.pauseTimeNs = counters.pauseTimeNs;
+        record.errorCount = counters.errorCount;
+        record.callbackCount = counters.callbackCount;
+        record.typeId = typeId;
+        record.state = static_cast<uint8_t>(worker.getState());
+        record.flags = static_cast<uint8_t>((info.pooled ? STATUS_POOLED : 0) |
+                                            (info.timerDriven ? STATUS_TIMER_DRIVEN : 0) |
+                                            (info.async ? STATUS_ASYNC : 0) |
+                                            (info.name.isAnonymous() ? STATUS_ANONYMOUS : 0) |
+                                            (worker.isStopRequested() ? STATUS_STOP_REQUESTED : 0));
+
+        const std::string& name = info.name.str();
+        size_t length = std::min(name.size(), ThreadStatusRecord::NAME_CAPACITY - 1);
+        std::memcpy(record.name, name.data(), length);
+        record.name[length] = '\0';
+        record.nameLength = static_cast<uint16_t>(std::min<size_t>(name.size(), UINT16_MAX));
+    }
+
+    static const std::string& anonymousName() {
+        static const std::string name = "(anonymous)";
+        return name;
     }
 };
 
+inline void ThreadInfo::LaunchTask::execute() {
+    manager->runLaunched(*entry);
+}
+
 } // namespace thread_framework
 
 #endif // THREAD_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,562 @@
+#ifndef THREAD_OPTIONS_H
+#define THREAD_OPTIONS_H
+
+#include "CancellationToken.h"
+#include <pthread.h>
+#include <sched.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <utility>
+#include <system_error>
+#include <type_traits>
+
+/**
+ * @file ThreadOptions.h
+ * @brief 线程的CPU亲和性、NUMA放置和调度策略
+ *
+ * CPU拓扑从 /sys/devices/system 读取，不依赖 libnuma。NUMA放置通过把线程限制在该节点的
+ * CPU上实现，线程随后分配的内存按首次访问原则落在本节点。非 Linux 平台上放置相关的设置不生效。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief 调度策略枚举
+ */
+enum class SchedulingPolicy {
+    INHERIT,        ///< 继承创建者的调度策略
+    NORMAL,         ///< SCHED_OTHER，priority 为 nice 值
+    BATCH,          ///< SCHED_BATCH，适合吞吐型的批处理任务，priority 为 nice 值
+    IDLE,           ///< SCHED_IDLE，只在CPU空闲时运行
+    FIFO,           ///< SCHED_FIFO 实时调度，priority 为1到99，通常需要 CAP_SYS_NICE
+    ROUND_ROBIN     ///< SCHED_RR 实时调度，priority 为1到99，通常需要 CAP_SYS_NICE
+};
+
+/**
+ * @brief 池化工作的优先级类别
+ *
+ * 与操作系统的调度策略无关，只决定任务在线程池队列中的先后顺序。
+ */
+enum class PriorityClass {
+    CRITICAL = 0,   ///< 延迟敏感，先于其它类别执行
+    NORMAL = 1,     ///< 默认类别
+    BATCH = 2       ///< 批处理，没有更高类别的工作时才执行
+};
+
+/**
+ * @brief 优先级类别的数量
+ */
+constexpr size_t PRIORITY_CLASS_COUNT = 3;
+
+/**
+ * @brief 获取优先级类别的名称
+ */
+inline const char* priorityClassName(PriorityClass priorityClass) {
+    switch (priorityClass) {
+        case PriorityClass::CRITICAL: return "CRITICAL";
+        case PriorityClass::NORMAL: return "NORMAL";
+        case PriorityClass::BATCH: return "BATCH";
+    }
+    return "UNKNOWN";
+}
+
+/**
+ * @brief 提交到线程池的任务的调度选项
+ *
+ * 同一类别内有截止时间的任务按截止时间最早优先执行，没有截止时间的任务排在其后并保持提交顺序。
+ * 截止时间只影响顺序，错过截止时间的任务仍然执行，并计入统计。
+ * 要让过期的任务不再执行，使用带截止时间的取消令牌。
+ */
+struct TaskOptions {
+    PriorityClass priorityClass = PriorityClass::NORMAL; ///< 优先级类别
+    std::chrono::steady_clock::time_point deadline{};     ///< 截止时间，默认值表示没有截止时间
+    CancellationToken cancellation;                       ///< submit() 的任务开始前已取消则不执行，Future 收到 OperationCancelled
+
+    TaskOptions() = default;
+    explicit TaskOptions(PriorityClass cls, std::chrono::steady_clock::time_point due = {})
+        : priorityClass(cls), deadline(due) {}
+
+    /**
+     * @brief 按相对时间设置截止时间
+     *
+     * @param cls 优先级类别
+     * @param budget 从现在起允许的等待时间
+     */
+    template <typename Rep, typename Period>
+    static TaskOptions within(PriorityClass cls, std::chrono::duration<Rep, Period> budget) {
+        return TaskOptions(cls, std::chrono::steady_clock::now() +
+                                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(budget));
+    }
+
+    /**
+     * @brief 是否设置了截止时间
+     */
+    bool hasDeadline() const {
+        return deadline != std::chrono::steady_clock::time_point{};
+    }
+
+    /**
+     * @brief 是否为默认选项（NORMAL 且没有截止时间）
+     *
+     * 默认选项的任务走线程池原有的无锁路径，不记录等待时间。
+     */
+    bool isDefault() const {
+        return priorityClass == PriorityClass::NORMAL && !hasDeadline();
+    }
+};
+
+/**
+ * @brief 独占线程的启动选项
+ *
+ * 请求了CPU、NUMA节点、调度策略或栈大小的工作者总是运行在自己的独占线程上，
+ * 不会被池化或交给共享定时服务。
+ */
+struct ThreadLaunchOptions {
+    std::vector<int> cpus;                               ///< 允许运行的CPU编号，为空表示不限制
+    int numaNode = -1;                                   ///< NUMA节点，不小于0时只在该节点的CPU上运行
+    SchedulingPolicy policy = SchedulingPolicy::INHERIT; ///< 调度策略
+    int priority = 0;                                    ///< 实时策略的优先级或普通策略的 nice 值
+    size_t stackSize = 0;                                ///< 栈大小（字节），0表示系统默认
+    bool setOsThreadName = true;                         ///< 是否把线程名称设置为系统线程名（截断为15字节）
+    TaskOptions taskOptions;                             ///< 池化执行时的优先级类别和截止时间，不影响是否池化
+    CancellationToken cancellation;                      ///< 取消令牌，取消或到达截止时间时停止工作者；为空时使用 taskOptions.cancellation
+
+    /**
+     * @brief 是否请求了任何放置或调度设置
+     */
+    bool requestsPlacement() const {
+        return !cpus.empty() || numaNode >= 0 || policy != SchedulingPolicy::INHERIT || stackSize != 0;
+    }
+};
+
+/**
+ * @brief CPU拓扑
+ *
+ * 第一次调用 get() 时检测。只包含当前进程允许使用的CPU，
+ * 读取不到 sysfs 时退化为单个节点、每个CPU一个物理核心。
+ */
+class CpuTopology {
+public:
+    /**
+     * @brief 获取本机拓扑
+     */
+    static const CpuTopology& get() {
+        static const CpuTopology topology;
+        return topology;
+    }
+
+    /**
+     * @brief 获取可用的CPU编号，按编号升序
+     */
+    const std::vector<int>& getCpus() const {
+        return cpus_;
+    }
+
+    /**
+     * @brief 获取NUMA节点数量（最大节点编号加1）
+     */
+    size_t getNodeCount() const {
+        return nodeCpus_.size();
+    }
+
+    /**
+     * @brief 获取节点上的可用CPU
+     *
+     * @param node 节点编号
+     * @return const std::vector<int>& 该节点的可用CPU，节点不存在时为空
+     */
+    const std::vector<int>& getNodeCpus(size_t node) const {
+        static const std::vector<int> empty;
+        return node < nodeCpus_.size() ? nodeCpus_[node] : empty;
+    }
+
+    /**
+     * @brief 获取CPU所在的NUMA节点
+     *
+     * @return size_t 节点编号，未知的CPU返回0
+     */
+    size_t getNodeOfCpu(int cpu) const {
+        if (cpu < 0 || static_cast<size_t>(cpu) >= cpuNode_.size()) {
+            return 0;
+        }
+        return cpuNode_[cpu];
+    }
+
+    /**
+     * @brief 获取每个物理核心的第一个可用逻辑CPU
+     *
+     * 同一物理核心上的超线程只取一个，按节点、再按CPU编号排列。
+     */
+    const std::vector<int>& getCoreCpus() const {
+        return coreCpus_;
+    }
+
+    /**
+     * @brief 解析 sysfs 的CPU列表格式，例如 "0-3,8,10-11"
+     */
+    static std::vector<int> parseCpuList(const std::string& list) {
+        std::vector<int> result;
+        size_t pos = 0;
+        while (pos < list.size()) {
+            size_t comma = list.find(',', pos);
+            std::string item = list.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            pos = comma == std::string::npos ? list.size() : comma + 1;
+
+            size_t dash = item.find('-');
+            try {
+                int first = std::stoi(item.substr(0, dash));
+                int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+                for (int cpu = first; cpu <= last; ++cpu) {
+                    result.push_back(cpu);
+                }
+            } catch (const std::exception&) {
+                // 忽略无法解析的片段，例如空行
+            }
+        }
+        return result;
+    }
+
+private:
+    std::vector<int> cpus_;
+    std::vector<std::vector<int>> nodeCpus_;
+    std::vector<size_t> cpuNode_;              ///< 按CPU编号索引
+    std::vector<int> coreCpus_;
+
+    CpuTopology() {
+        detectCpus();
+        detectNodes();
+        detectCores();
+    }
+
+    static bool readLine(const std::string& path, std::string& line) {
+        std::ifstream file(path);
+        return static_cast<bool>(std::getline(file, line));
+    }
+
+    void detectCpus() {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) {
+                    cpus_.push_back(cpu);
+                }
+            }
+        }
+#endif
+        if (cpus_.empty()) {
+            unsigned count = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned cpu = 0; cpu < count; ++cpu) {
+                cpus_.push_back(static_cast<int>(cpu));
+            }
+        }
+        cpuNode_.assign(static_cast<size_t>(cpus_.back()) + 1, 0);
+    }
+
+    void detectNodes() {
+        std::string line;
+        if (readLine("/sys/devices/system/node/online", line)) {
+            for (int node : parseCpuList(line)) {
+                std::string cpuList;
+                if (!readLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", cpuList)) {
+                    continue;
+                }
+                if (static_cast<size_t>(node) >= nodeCpus_.size()) {
+                    nodeCpus_.resize(static_cast<size_t>(node) + 1);
+                }
+                for (int cpu : parseCpuList(cpuList)) {
+                    if (isUsable(cpu)) {
+                        nodeCpus_[node].push_back(cpu);
+                        cpuNode_[cpu] = static_cast<size_t>(node);
+                    }
+                }
+            }
+        }
+
+        if (nodeCpus_.empty()) {
+            nodeCpus_.push_back(cpus_);
+        }
+    }
+
+    void detectCores() {
+        // (节点, 封装, 核心) 相同的逻辑CPU属于同一个物理核心
+        std::vector<std::pair<std::vector<long>, int>> cores;
+        for (int cpu : cpus_) {
+            std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+            std::string package;
+            std::string core;
+            std::vector<long> key;
+            key.push_back(static_cast<long>(getNodeOfCpu(cpu)));
+            if (readLine(base + "physical_package_id", package) && readLine(base + "core_id", core)) {
+                key.push_back(std::atol(package.c_str()));
+                key.push_back(std::atol(core.c_str()));
+            } else {
+                key.push_back(-1);
+                key.push_back(cpu);
+            }
+            cores.emplace_back(std::move(key), cpu);
+        }
+
+        std::stable_sort(cores.begin(), cores.end(), [](const auto& a, const auto& b) {
+            return a.first < b.first;
+        });
+        for (size_t i = 0; i < cores.size(); ++i) {
+            if (i == 0 || cores[i].first != cores[i - 1].first) {
+                coreCpus_.push_back(cores[i].second);
+            }
+        }
+        std::sort(coreCpus_.begin(), coreCpus_.end(), [this](int a, int b) {
+            size_t nodeA = getNodeOfCpu(a);
+            size_t nodeB = getNodeOfCpu(b);
+            return nodeA != nodeB ? nodeA < nodeB : a < b;
+        });
+    }
+
+    bool isUsable(int cpu) const {
+        return std::binary_search(cpus_.begin(), cpus_.end(), cpu);
+    }
+};
+
+namespace detail {
+
+/**
+ * @brief 计算选项实际允许的CPU
+ *
+ * @param options 启动选项
+ * @param cpus 输出参数，为空表示不限制
+ * @return false 指定的CPU和节点没有可用的交集
+ */
+inline bool resolveCpus(const ThreadLaunchOptions& options, std::vector<int>& cpus) {
+    cpus.clear();
+    if (options.cpus.empty() && options.numaNode < 0) {
+        return true;
+    }
+
+    const CpuTopology& topology = CpuTopology::get();
+    const std::vector<int>& allowed = options.numaNode >= 0
+        ? topology.getNodeCpus(static_cast<size_t>(options.numaNode)) : topology.getCpus();
+    if (options.cpus.empty()) {
+        cpus = allowed;
+    } else {
+        for (int cpu : options.cpus) {
+            if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    return !cpus.empty();
+}
+
+/**
+ * @brief 把当前线程限制在指定的CPU上
+ */
+inline bool setCurrentThreadAffinity(const std::vector<int>& cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+/**
+ * @brief 设置当前线程的系统线程名，超过15字节的部分被截断
+ */
+inline bool setCurrentThreadName(const std::string& name) {
+#ifdef __linux__
+    return pthread_setname_np(pthread_self(), name.substr(0, 15).c_str()) == 0;
+#else
+    (void)name;
+    return false;
+#endif
+}
+
+/**
+ * @brief 设置当前线程的调度策略和优先级
+ *
+ * @param error 失败时写入原因
+ */
+inline bool setCurrentThreadScheduling(SchedulingPolicy policy, int priority, std::string& error) {
+#ifdef __linux__
+    int native = SCHED_OTHER;
+    switch (policy) {
+        case SchedulingPolicy::INHERIT: return true;
+        case SchedulingPolicy::NORMAL: native = SCHED_OTHER; break;
+        case SchedulingPolicy::BATCH: native = SCHED_BATCH; break;
+        case SchedulingPolicy::IDLE: native = SCHED_IDLE; break;
+        case SchedulingPolicy::FIFO: native = SCHED_FIFO; break;
+        case SchedulingPolicy::ROUND_ROBIN: native = SCHED_RR; break;
+    }
+
+    bool realtime = native == SCHED_FIFO || native == SCHED_RR;
+    sched_param param{};
+    param.sched_priority = realtime ? priority : 0;
+    int rc = pthread_setschedparam(pthread_self(), native, &param);
+    if (rc != 0) {
+        error = std::string("failed to set scheduling policy: ") + std::strerror(rc);
+        return false;
+    }
+
+    // Linux 上 nice 值是每个线程独立的
+    if (!realtime && native != SCHED_IDLE && priority != 0) {
+        pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+        if (setpriority(PRIO_PROCESS, static_cast<id_t>(tid), priority) != 0) {
+            error = std::string("failed to set nice value: ") + std::strerror(errno);
+            return false;
+        }
+    }
+    return true;
+#else
+    (void)policy;
+    (void)priority;
+    error = "scheduling policy is not supported on this platform";
+    return false;
+#endif
+}
+
+/**
+ * @brief 在新线程开始执行工作者之前应用启动选项
+ *
+ * 每一项独立应用，某一项失败不影响其它项。
+ *
+ * @param options 启动选项
+ * @param name 线程名称
+ * @param error 失败时写入原因，多项失败以分号分隔
+ * @return true 全部应用成功
+ * @return false 至少一项失败
+ */
+inline bool applyThreadOptions(const ThreadLaunchOptions& options, const std::string& name, std::string& error) {
+    std::vector<std::string> failures;
+
+    if (options.setOsThreadName && !name.empty()) {
+        setCurrentThreadName(name); // 名称只用于诊断，失败时不报告
+    }
+
+    std::vector<int> cpus;
+    if (!resolveCpus(options, cpus)) {
+        failures.push_back("no usable CPU matches the requested CPU set and NUMA node");
+    } else if (!cpus.empty() && !setCurrentThreadAffinity(cpus)) {
+        failures.push_back("failed to set CPU affinity");
+    }
+
+    std::string schedulingError;
+    if (!setCurrentThreadScheduling(options.policy, options.priority, schedulingError)) {
+        failures.push_back(schedulingError);
+    }
+
+    error.clear();
+    for (const auto& failure : failures) {
+        error += (error.empty() ? "" : "; ") + failure;
+    }
+    return failures.empty();
+}
+
+} // namespace detail
+
+/**
+ * @brief 可以指定栈大小的系统线程
+ *
+ * 接口与 std::thread 的 join 部分一致，线程管理器用它运行独占线程。
+ * 析构时线程仍可join则将其分离，而不是终止进程。
+ */
+class NativeThread {
+public:
+    /**
+     * @brief 创建并启动线程
+     *
+     * @param function 线程执行体
+     * @param stackSize 栈大小（字节），0表示系统默认，小于系统最小值时取最小值
+     * @throws std::system_error 创建线程失败
+     */
+    template <typename F>
+    explicit NativeThread(F&& function, size_t stackSize = 0) {
+        using Body = typename std::decay<F>::type;
+        std::unique_ptr<Body> body(new Body(std::forward<F>(function)));
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        int rc = 0;
+        if (stackSize > 0) {
+            rc = pthread_attr_setstacksize(&attr, std::max<size_t>(stackSize, PTHREAD_STACK_MIN));
+        }
+        if (rc == 0) {
+            rc = pthread_create(&handle_, &attr, &NativeThread::entry<Body>, body.get());
+        }
+        pthread_attr_destroy(&attr);
+        if (rc != 0) {
+            throw std::system_error(rc, std::generic_category(), "failed to create thread");
+        }
+
+        body.release(); // 由新线程释放
+        joinable_ = true;
+    }
+
+    ~NativeThread() {
+        if (joinable_) {
+            pthread_detach(handle_);
+        }
+    }
+
+    NativeThread(const NativeThread&) = delete;
+    NativeThread& operator=(const NativeThread&) = delete;
+
+    bool joinable() const {
+        return joinable_;
+    }
+
+    /**
+     * @brief 等待线程结束
+     */
+    void join() {
+        if (joinable_) {
+            pthread_join(handle_, nullptr);
+            joinable_ = false;
+        }
+    }
+
+    /**
+     * @brief 是否就是调用线程
+     */
+    bool isCurrentThread() const {
+        return joinable_ && pthread_equal(handle_, pthread_self());
+    }
+
+private:
+    pthread_t handle_{};
+    bool joinable_ = false;
+
+    template <typename Body>
+    static void* entry(void* arg) {
+        std::unique_ptr<Body> body(static_cast<Body*>(arg));
+        (*body)();
+        return nullptr;
+    }
+};
+
+} // namespace thread_framework
+
+#endif // THREAD_OPTIONS_H
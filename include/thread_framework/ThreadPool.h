@@ -0,0 +1,1305 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "WorkStealingDeque.h"
+#include "ThreadOptions.h"
+#include "Counters.h"
+#include "Tracing.h"
+#include "ScratchArena.h"
+#include <thread>
+#include <vector>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+#include <system_error>
+
+/**
+ * @file ThreadPool.h
+ * @brief 工作窃取线程池
+ *
+ * 线程管理器在池化模式下使用这个线程池执行可池化的工作者，
+ * 避免为每个短任务创建和销毁系统线程。每个池线程拥有一个 Chase-Lev 双端队列，
+ * 池线程内派生的任务进入本地队列，空闲线程从其它线程的队列中窃取任务。
+ * 可以按物理核心或NUMA节点放置池线程，此时每个节点有自己的注入队列，窃取也优先在节点内进行。
+ * 带 TaskOptions 提交的任务进入按优先级类别划分的截止时间堆，CRITICAL 和 NORMAL 先于普通任务执行，
+ * BATCH 最后执行，饥饿保护保证低类别的任务不会被无限推迟。
+ * 弹性模式下线程数在常驻线程数和最大线程数之间伸缩：任务积压时增加线程，额外线程空闲一段时间后退出，
+ * 池线程在 blockingRegion() 内阻塞时补充线程以保持并行度。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief 线程池任务接口
+ *
+ * 线程池以指针形式调度任务。execute() 执行完毕后线程池调用 release()，
+ * 默认实现释放任务对象，派生类可以重写以实现引用计数等自定义的生命周期。
+ * 线程池丢弃排队任务时（见 ThreadPool::setDiscardQueued()）先调用 discard()，
+ * 返回 true 的任务不再执行，随后同样调用 release()。
+ */
+class PoolTask {
+public:
+    virtual ~PoolTask() = default;
+
+    /**
+     * @brief 执行任务
+     */
+    virtual void execute() = 0;
+
+    /**
+     * @brief 任务执行完毕后由线程池调用
+     */
+    virtual void release() { delete this; }
+
+    /**
+     * @brief 放弃执行，线程池丢弃排队任务时调用
+     *
+     * @return true 任务已放弃，不再调用 execute()
+     * @return false 任务不能被丢弃（例如有调用方在等待它完成），照常执行
+     */
+    virtual bool discard() { return false; }
+};
+
+/**
+ * @brief 包装可调用对象的线程池任务
+ *
+ * 可调用对象直接存放在任务对象中，不经过 std::function 的额外堆分配。
+ */
+template <typename F>
+class FunctionTask : public PoolTask {
+private:
+    F function_;
+
+public:
+    explicit FunctionTask(F function) : function_(std::move(function)) {}
+
+    void execute() override {
+        function_();
+    }
+
+    bool discard() override {
+        return true;
+    }
+};
+
+/**
+ * @brief 单个池线程的统计信息
+ */
+struct PoolThreadStats {
+    uint64_t tasksExecuted = 0;   ///< 执行的任务数
+    uint64_t localPushes = 0;     ///< 压入本地队列的任务数
+    uint64_t steals = 0;          ///< 成功窃取的任务数
+    uint64_t stealAttempts = 0;   ///< 窃取尝试次数（每轮遍历所有受害者计一次）
+    uint64_t idleParks = 0;       ///< 无任务时休眠的次数
+    uint64_t idleTimeNs = 0;      ///< 休眠的总时长（纳秒）
+    size_t node = 0;              ///< 所在的NUMA节点
+    bool active = true;           ///< 是否有线程在运行（弹性模式的额外线程可能已退出）
+};
+
+/**
+ * @brief 单个优先级类别的统计信息
+ *
+ * 只统计带 TaskOptions 提交的任务。等待时间从提交到开始执行，用于检查延迟目标。
+ */
+struct PriorityClassStats {
+    PriorityClass priorityClass = PriorityClass::NORMAL; ///< 类别
+    size_t queueDepth = 0;             ///< 排队中的任务数（近似值）
+    uint64_t submitted = 0;            ///< 提交的任务数
+    uint64_t executed = 0;             ///< 开始执行的任务数
+    uint64_t deadlineMisses = 0;       ///< 开始执行时已超过截止时间的任务数
+    uint64_t starvationPromotions = 0; ///< 因饥饿保护而提前执行的任务数
+    uint64_t totalWaitNs = 0;          ///< 总等待时长（纳秒）
+    uint64_t maxWaitNs = 0;            ///< 最长等待时长（纳秒）
+
+    /**
+     * @brief 获取平均等待时长（毫秒）
+     */
+    double getAverageWaitMs() const {
+        return executed == 0 ? 0.0 : static_cast<double>(totalWaitNs) / 1e6 / static_cast<double>(executed);
+    }
+};
+
+/**
+ * @brief 线程池统计信息
+ */
+struct PoolStats {
+    size_t threadCount = 0;       ///< 正在运行的池线程数量
+    size_t maxThreads = 0;        ///< 最大池线程数量，非弹性模式等于常驻线程数
+    size_t blockedThreads = 0;    ///< 正在 blockingRegion() 内的池线程数
+    uint64_t spawnedThreads = 0;  ///< 弹性模式增加的线程数
+    uint64_t retiredThreads = 0;  ///< 弹性模式因空闲而退出的线程数
+    size_t pendingTasks = 0;      ///< 等待执行的任务数（近似值）
+    uint64_t injectedTasks = 0;   ///< 从池外提交到共享注入队列的任务数
+    uint64_t discardedTasks = 0;  ///< 丢弃模式下放弃执行的任务数
+    PoolThreadStats total;        ///< 所有池线程的汇总
+    std::vector<PoolThreadStats> threads; ///< 每个池线程的统计
+    std::array<PriorityClassStats, PRIORITY_CLASS_COUNT> classes; ///< 按 PriorityClass 取下标的类别统计
+};
+
+/**
+ * @brief 池线程的放置策略
+ */
+enum class PoolPlacement {
+    NONE,               ///< 不绑定CPU，由系统调度
+    PER_PHYSICAL_CORE,  ///< 每个物理核心一个池线程并绑定到该核心，超线程不重复使用
+    NUMA_NODES          ///< 池线程按CPU数分布到各NUMA节点，并限制在所在节点的CPU上
+};
+
+/**
+ * @brief 线程池选项
+ */
+struct PoolOptions {
+    size_t threadCount = 0;                      ///< 池线程数量，0表示按放置策略自动选择
+    PoolPlacement placement = PoolPlacement::NONE; ///< 放置策略
+    std::string threadNamePrefix = "tf-pool";    ///< 池线程的系统线程名前缀
+    size_t starvationLimit = 32;                 ///< 低类别有任务等待时，连续执行多少个高类别任务后插入一个低类别任务，0表示不限制
+    size_t maxThreads = 0;                       ///< 最大池线程数，大于常驻线程数时启用弹性模式
+    std::chrono::milliseconds spawnThreshold{10};  ///< 弹性模式：任务积压且没有空闲线程持续这么久时增加一个线程
+    std::chrono::milliseconds keepAlive{30000};    ///< 弹性模式：额外线程空闲这么久后退出
+
+    PoolOptions() = default;
+    PoolOptions(size_t count, PoolPlacement place = PoolPlacement::NONE) : threadCount(count), placement(place) {}
+
+    /**
+     * @brief 创建弹性线程池选项
+     *
+     * @param minThreads 常驻线程数，0表示按放置策略自动选择
+     * @param maxThreads 最大线程数
+     * @param keepAlive 额外线程空闲多久后退出
+     */
+    static PoolOptions elastic(size_t minThreads, size_t maxThreads,
+                               std::chrono::milliseconds keepAlive = std::chrono::milliseconds(30000)) {
+        PoolOptions options(minThreads);
+        options.maxThreads = maxThreads;
+        options.keepAlive = keepAlive;
+        return options;
+    }
+};
+
+/**
+ * @brief 工作窃取线程池
+ *
+ * 常驻池线程在构造时创建。池外提交的任务进入共享注入队列，池线程内提交的任务
+ * 进入该线程的本地双端队列。池线程按 本地队列 → 注入队列 → 窃取 的顺序查找任务，
+ * 找不到时在条件变量上休眠，不消耗CPU。析构时执行完剩余任务后退出。
+ *
+ * 弹性模式（maxThreads 大于常驻线程数）下，所有线程槽位在构造时分配，额外线程按需启动：
+ * 监视线程每隔 spawnThreshold 采样一次，连续两次看到任务积压且没有休眠的池线程时增加一个线程；
+ * 池线程进入 blockingRegion() 使可运行的线程少于常驻线程数时立即补充一个线程。
+ * 额外线程空闲 keepAlive 后退出，常驻线程不会退出。
+ *
+ * 带 TaskOptions 提交的任务按 CRITICAL → NORMAL → 普通任务 → BATCH 的顺序执行，
+ * 同一类别内按截止时间最早优先。已经开始执行的任务不会被抢占。
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param threadCount 池线程数量，0表示使用硬件核心数
+     */
+    explicit ThreadPool(size_t threadCount = 0) : ThreadPool(PoolOptions(threadCount)) {}
+
+    /**
+     * @brief 按选项构造
+     *
+     * 未指定线程数时，PER_PHYSICAL_CORE 使用物理核心数，NUMA_NODES 使用可用CPU数，
+     * NONE 使用硬件核心数。
+     *
+     * @param options 线程池选项
+     */
+    explicit ThreadPool(const PoolOptions& options) : options_(options) {
+        const CpuTopology& topology = CpuTopology::get();
+        size_t threadCount = options.threadCount;
+        if (threadCount == 0) {
+            switch (options.placement) {
+                case PoolPlacement::NONE: threadCount = std::thread::hardware_concurrency(); break;
+                case PoolPlacement::PER_PHYSICAL_CORE: threadCount = topology.getCoreCpus().size(); break;
+                case PoolPlacement::NUMA_NODES: threadCount = topology.getCpus().size(); break;
+            }
+        }
+        if (threadCount == 0) {
+            threadCount = 1;
+        }
+
+        size_t queueCount = options.placement == PoolPlacement::NONE ? 1 : topology.getNodeCount();
+        for (size_t i = 0; i < queueCount; ++i) {
+            injectQueues_.push_back(std::make_unique<InjectQueue>());
+        }
+
+        coreThreads_ = threadCount;
+        size_t capacity = std::max(threadCount, options.maxThreads);
+        workers_.reserve(capacity);
+        for (size_t i = 0; i < capacity; ++i) {
+            workers_.push_back(std::make_unique<WorkerSlot>(i));
+            placeWorker(*workers_[i], i, topology);
+        }
+        for (size_t i = 0; i < threadCount; ++i) {
+            launch(i);
+        }
+        if (isElastic()) {
+            monitor_ = std::thread([this]() { monitorLoop(); });
+        }
+    }
+
+    /**
+     * @brief 析构函数
+     *
+     * 执行完所有剩余任务后停止并回收池线程
+     */
+    ~ThreadPool() {
+        {
+            // 在 spawnMutex_ 内设置，之后不会再启动新线程
+            std::lock_guard<std::mutex> lock(spawnMutex_);
+            stopping_.store(true);
+        }
+        {
+            std::lock_guard<std::mutex> lock(parkMutex_);
+        }
+        parkCondition_.notify_all();
+
+        if (monitor_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(monitorMutex_);
+            }
+            monitorCondition_.notify_all();
+            monitor_.join();
+        }
+        for (auto& worker : workers_) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief 提交任务对象
+     *
+     * 在本线程池的池线程上调用时任务进入本地队列，否则进入共享注入队列。
+     *
+     * @param task 任务对象，执行完毕后由线程池调用 release()
+     */
+    void submit(PoolTask* task) {
+        WorkerContext& context = currentContext();
+        if (context.pool == this) {
+            WorkerSlot& self = *workers_[context.index];
+            self.deque.push(task);
+            self.localPushes.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            InjectQueue& queue = callerInjectQueue();
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasks.push_back(task);
+                queue.size.store(queue.tasks.size(), std::memory_order_seq_cst);
+            }
+            injectedTasks_.add();
+        }
+
+        wakeOne();
+    }
+
+    /**
+     * @brief 批量提交任务对象
+     *
+     * 所有任务一次性进入队列：池外提交时调用方所在节点的注入队列只加锁一次，
+     * 并按任务数量唤醒休眠的池线程。
+     *
+     * @param tasks 任务对象数组
+     * @param count 任务数量
+     */
+    void submitBatch(PoolTask* const* tasks, size_t count) {
+        if (count == 0) {
+            return;
+        }
+
+        WorkerContext& context = currentContext();
+        if (context.pool == this) {
+            WorkerSlot& self = *workers_[context.index];
+            for (size_t i = 0; i < count; ++i) {
+                self.deque.push(tasks[i]);
+            }
+            self.localPushes.fetch_add(count, std::memory_order_relaxed);
+        } else {
+            InjectQueue& queue = callerInjectQueue();
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasks.insert(queue.tasks.end(), tasks, tasks + count);
+                queue.size.store(queue.tasks.size(), std::memory_order_seq_cst);
+            }
+            injectedTasks_.add(count);
+        }
+
+        wake(count);
+    }
+
+    /**
+     * @brief 按调度选项提交任务对象
+     *
+     * 默认选项等同于 submit(task)。其它选项的任务进入对应类别的截止时间堆，并记录提交时间。
+     *
+     * @param task 任务对象，执行完毕后由线程池调用 release()
+     * @param options 优先级类别和截止时间
+     */
+    void submit(PoolTask* task, const TaskOptions& options) {
+        if (options.isDefault()) {
+            submit(task);
+            return;
+        }
+        pushClassed(&task, 1, options);
+        wakeOne();
+    }
+
+    /**
+     * @brief 按调度选项批量提交任务对象
+     *
+     * @param tasks 任务对象数组
+     * @param count 任务数量
+     * @param options 所有任务共用的优先级类别和截止时间
+     */
+    void submitBatch(PoolTask* const* tasks, size_t count, const TaskOptions& options) {
+        if (options.isDefault()) {
+            submitBatch(tasks, count);
+            return;
+        }
+        if (count == 0) {
+            return;
+        }
+        pushClassed(tasks, count, options);
+        wake(count);
+    }
+
+    /**
+     * @brief 提交可调用对象
+     *
+     * @param job 要在池线程上执行的可调用对象
+     */
+    template <typename F,
+              typename = typename std::enable_if<!std::is_convertible<F, PoolTask*>::value>::type>
+    void submit(F&& job) {
+        submit(static_cast<PoolTask*>(new FunctionTask<typename std::decay<F>::type>(std::forward<F>(job))));
+    }
+
+    /**
+     * @brief 按调度选项提交可调用对象
+     *
+     * @param job 要在池线程上执行的可调用对象
+     * @param options 优先级类别和截止时间
+     */
+    template <typename F,
+              typename = typename std::enable_if<!std::is_convertible<F, PoolTask*>::value>::type>
+    void submit(F&& job, const TaskOptions& options) {
+        submit(static_cast<PoolTask*>(new FunctionTask<typename std::decay<F>::type>(std::forward<F>(job))), options);
+    }
+
+    /**
+     * @brief 获取正在运行的池线程数量
+     */
+    size_t getThreadCount() const {
+        return liveThreads_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 获取最大池线程数量，也是池线程序号的上界
+     */
+    size_t getMaxThreadCount() const {
+        return workers_.size();
+    }
+
+    /**
+     * @brief 是否为弹性线程池
+     */
+    bool isElastic() const {
+        return workers_.size() > coreThreads_;
+    }
+
+    /**
+     * @brief 池线程中阻塞区域的守卫，见 blockingRegion()
+     */
+    class BlockingRegion {
+    public:
+        BlockingRegion() {
+            WorkerContext& context = currentContext();
+            if (context.pool && context.blockingDepth++ == 0) {
+                pool_ = context.pool;
+                pool_->enterBlocking();
+            }
+        }
+
+        ~BlockingRegion() {
+            if (pool_) {
+                currentContext().blockingDepth = 0;
+                pool_->leaveBlocking();
+            } else if (currentContext().pool) {
+                currentContext().blockingDepth--;
+            }
+        }
+
+        BlockingRegion(const BlockingRegion&) = delete;
+        BlockingRegion& operator=(const BlockingRegion&) = delete;
+
+    private:
+        ThreadPool* pool_ = nullptr;
+    };
+
+    /**
+     * @brief 获取等待执行的任务数量（近似值）
+     */
+    size_t getPendingCount() const {
+        size_t pending = getInjectedCount() + classedPending_.load(std::memory_order_relaxed);
+        size_t slots = usedSlots();
+        for (size_t i = 0; i < slots; ++i) {
+            pending += workers_[i]->deque.size();
+        }
+        return pending;
+    }
+
+    /**
+     * @brief 设置是否丢弃排队的任务
+     *
+     * 开启后池线程取到任务时先调用 PoolTask::discard()，可以丢弃的任务不再执行；
+     * 不能丢弃的任务（启动工作者、并行循环和任务图的分片等）照常执行。关闭前提交的任务也会被丢弃。
+     *
+     * @param discard true 丢弃，false 恢复正常执行
+     */
+    void setDiscardQueued(bool discard) {
+        discarding_.store(discard, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 等待线程池空闲：没有排队的任务，且所有池线程都在休眠
+     *
+     * 在池外调用 runPendingTask() 执行的任务不计入。
+     *
+     * @param deadline 截止时间，time_point::max() 表示一直等待
+     * @return true 线程池已空闲
+     * @return false 到达截止时间时仍有任务
+     */
+    bool waitForIdle(std::chrono::steady_clock::time_point deadline) {
+        auto idle = [this]() {
+            return sleepers_.load(std::memory_order_seq_cst) >= liveThreads_.load() && !hasVisibleWork();
+        };
+        std::unique_lock<std::mutex> lock(parkMutex_);
+        idleWaiters_++;
+        bool reached = true;
+        if (deadline == std::chrono::steady_clock::time_point::max()) {
+            idleCondition_.wait(lock, idle);
+        } else {
+            reached = idleCondition_.wait_until(lock, deadline, idle);
+        }
+        idleWaiters_--;
+        return reached;
+    }
+
+    /**
+     * @brief 检查当前线程是否为本线程池的池线程
+     */
+    bool isPoolThread() const {
+        return currentContext().pool == this;
+    }
+
+    /**
+     * @brief 获取当前池线程的序号
+     *
+     * @return size_t 池线程序号，池外线程返回 getMaxThreadCount()
+     */
+    size_t getCurrentThreadIndex() const {
+        const WorkerContext& context = currentContext();
+        return context.pool == this ? context.index : workers_.size();
+    }
+
+    /**
+     * @brief 获取当前线程本地队列中的任务数量
+     *
+     * 池外线程返回注入队列的总长度。用于判断是否需要为空闲线程拆分出更多任务。
+     */
+    size_t getLocalPendingCount() const {
+        const WorkerContext& context = currentContext();
+        if (context.pool == this) {
+            return workers_[context.index]->deque.size();
+        }
+        return getInjectedCount();
+    }
+
+    /**
+     * @brief 获取线程池选项
+     */
+    const PoolOptions& getOptions() const {
+        return options_;
+    }
+
+    /**
+     * @brief 在当前线程上执行一个待执行的任务
+     *
+     * 等待线程池中的结果时用来帮助执行任务，而不是阻塞。池线程按正常顺序查找任务，
+     * 池外线程先取 CRITICAL 和 NORMAL 类别的任务，再从注入队列取任务或从池线程的队列中窃取，最后取 BATCH 任务。
+     *
+     * @return true 执行了一个任务
+     * @return false 没有可执行的任务
+     */
+    bool runPendingTask() {
+        WorkerContext& context = currentContext();
+        PoolTask* task = nullptr;
+
+        if (context.pool == this) {
+            WorkerSlot& self = *workers_[context.index];
+            if (!findTask(self, context.index, task)) {
+                return false;
+            }
+            runTask(self, task);
+            return true;
+        }
+
+        if (!takeClassed(PriorityClass::CRITICAL, task, false) && !takeClassed(PriorityClass::NORMAL, task, false) &&
+            !takeInjected(callerNode(), task) && !stealFromOutside(task) &&
+            !takeClassed(PriorityClass::BATCH, task, false)) {
+            return false;
+        }
+        if (!discardTask(task)) {
+            ScratchScope scratch;
+            try {
+                task->execute();
+            } catch (...) {
+                // 任务自身负责报告错误
+            }
+        }
+        task->release();
+        return true;
+    }
+
+    /**
+     * @brief 获取统计信息
+     *
+     * 计数器以relaxed方式读取，不会阻塞池线程。
+     */
+    PoolStats getStats() const {
+        PoolStats stats;
+        stats.threadCount = getThreadCount();
+        stats.maxThreads = workers_.size();
+        stats.blockedThreads = blockedThreads_.load(std::memory_order_relaxed);
+        stats.spawnedThreads = spawnedThreads_.load(std::memory_order_relaxed);
+        stats.retiredThreads = retiredThreads_.load(std::memory_order_relaxed);
+        stats.pendingTasks = getPendingCount();
+        stats.injectedTasks = injectedTasks_.load();
+        stats.discardedTasks = discardedTasks_.load();
+
+        // 从未启动过的额外槽位不列出
+        size_t slots = usedSlots();
+        stats.threads.reserve(slots);
+        for (size_t i = 0; i < slots; ++i) {
+            const auto& worker = workers_[i];
+            PoolThreadStats t;
+            t.tasksExecuted = worker->tasksExecuted.load(std::memory_order_relaxed);
+            t.localPushes = worker->localPushes.load(std::memory_order_relaxed);
+            t.steals = worker->steals.load(std::memory_order_relaxed);
+            t.stealAttempts = worker->stealAttempts.load(std::memory_order_relaxed);
+            t.idleParks = worker->idleParks.load(std::memory_order_relaxed);
+            t.idleTimeNs = worker->idleTimeNs.load(std::memory_order_relaxed);
+            t.node = worker->node;
+            t.active = worker->active.load(std::memory_order_relaxed);
+
+            stats.total.tasksExecuted += t.tasksExecuted;
+            stats.total.localPushes += t.localPushes;
+            stats.total.steals += t.steals;
+            stats.total.stealAttempts += t.stealAttempts;
+            stats.total.idleParks += t.idleParks;
+            stats.total.idleTimeNs += t.idleTimeNs;
+            stats.threads.push_back(t);
+        }
+
+        for (size_t i = 0; i < PRIORITY_CLASS_COUNT; ++i) {
+            const ClassQueue& queue = classQueues_[i];
+            PriorityClassStats& c = stats.classes[i];
+            c.priorityClass = static_cast<PriorityClass>(i);
+            c.queueDepth = queue.size.load(std::memory_order_relaxed);
+            c.submitted = queue.submitted.load(std::memory_order_relaxed);
+            c.executed = queue.executed.load(std::memory_order_relaxed);
+            c.deadlineMisses = queue.deadlineMisses.load(std::memory_order_relaxed);
+            c.starvationPromotions = queue.starvationPromotions.load(std::memory_order_relaxed);
+            c.totalWaitNs = queue.totalWaitNs.load(std::memory_order_relaxed);
+            c.maxWaitNs = queue.maxWaitNs.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+private:
+    /**
+     * @brief 池线程私有数据，按缓存行对齐避免伪共享
+     */
+    struct alignas(64) WorkerSlot {
+        WorkStealingDeque<PoolTask*> deque;
+        std::thread thread;
+        uint64_t rngState;
+        std::atomic<uint64_t> tasksExecuted{0};
+        std::atomic<uint64_t> localPushes{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<uint64_t> stealAttempts{0};
+        std::atomic<uint64_t> idleParks{0};
+        std::atomic<uint64_t> idleTimeNs{0};
+        size_t node = 0;          ///< 所在节点，也是优先使用的注入队列
+        std::vector<int> cpus;    ///< 绑定的CPU，为空表示不绑定
+        size_t priorityStreak = 0;   ///< 低类别有任务等待时，连续执行高类别任务的次数
+        size_t starvationCursor = 0; ///< 饥饿保护轮流照顾的较低级别
+        std::atomic<bool> active{false}; ///< 是否有线程在这个槽位上运行，只在 spawnMutex_ 内或由退出的线程修改
+
+        explicit WorkerSlot(size_t index) : rngState(0x9E3779B97F4A7C15ULL * (index + 1)) {}
+    };
+
+    /**
+     * @brief 当前线程所属的线程池
+     */
+    struct WorkerContext {
+        ThreadPool* pool = nullptr;
+        size_t index = 0;
+        size_t blockingDepth = 0; ///< 嵌套的 blockingRegion() 层数
+    };
+
+    /**
+     * @brief 共享注入队列，每个NUMA节点一个
+     */
+    struct alignas(64) InjectQueue {
+        std::mutex mutex;
+        std::deque<PoolTask*> tasks;
+        std::atomic<size_t> size{0};
+    };
+
+    /**
+     * @brief 类别队列中的一项，没有截止时间的任务使用最大时间点
+     */
+    struct ClassEntry {
+        std::chrono::steady_clock::time_point deadline;
+        uint64_t sequence;
+        std::chrono::steady_clock::time_point enqueued;
+        PoolTask* task;
+    };
+
+    /**
+     * @brief 截止时间早的先执行，相同时按提交顺序
+     */
+    struct ClassEntryLater {
+        bool operator()(const ClassEntry& a, const ClassEntry& b) const {
+            if (a.deadline != b.deadline) {
+                return a.deadline > b.deadline;
+            }
+            return a.sequence > b.sequence;
+        }
+    };
+
+    /**
+     * @brief 单个优先级类别的截止时间堆和统计
+     */
+    struct alignas(64) ClassQueue {
+        std::mutex mutex;
+        std::vector<ClassEntry> heap;
+        uint64_t nextSequence = 0;
+        std::atomic<size_t> size{0};
+        std::atomic<uint64_t> submitted{0};
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> deadlineMisses{0};
+        std::atomic<uint64_t> starvationPromotions{0};
+        std::atomic<uint64_t> totalWaitNs{0};
+        std::atomic<uint64_t> maxWaitNs{0};
+    };
+
+    PoolOptions options_;
+    std::vector<std::unique_ptr<WorkerSlot>> workers_;
+    std::vector<std::unique_ptr<InjectQueue>> injectQueues_;
+    ShardedCounter injectedTasks_;             ///< 外部线程提交的任务数，按提交线程分片
+    std::atomic<size_t> outsideStealCursor_{0};
+    std::array<ClassQueue, PRIORITY_CLASS_COUNT> classQueues_;
+    std::atomic<size_t> classedPending_{0}; ///< 所有类别队列中的任务总数
+
+    std::mutex parkMutex_;
+    std::condition_variable parkCondition_;
+    std::condition_variable idleCondition_;   ///< waitForIdle() 的等待方，与 parkMutex_ 配合
+    size_t idleWaiters_ = 0;                  ///< waitForIdle() 的等待方数量，由 parkMutex_ 保护
+    std::atomic<size_t> sleepers_{0};
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> discarding_{false};     ///< 是否丢弃排队的任务
+    ShardedCounter discardedTasks_;           ///< 放弃执行的任务数
+
+    size_t coreThreads_ = 0;                  ///< 常驻线程数
+    std::atomic<size_t> liveThreads_{0};      ///< 正在运行的线程数
+    std::atomic<size_t> slotLimit_{0};        ///< 启动过线程的最大槽位序号加一，之后的槽位队列一定为空
+    std::atomic<size_t> blockedThreads_{0};
+    std::atomic<uint64_t> spawnedThreads_{0};
+    std::atomic<uint64_t> retiredThreads_{0};
+    std::mutex spawnMutex_;                   ///< 保护额外线程的启动和回收
+    std::thread monitor_;                     ///< 弹性模式的监视线程
+    std::mutex monitorMutex_;
+    std::condition_variable monitorCondition_;
+
+    static WorkerContext& currentContext() {
+        thread_local WorkerContext context;
+        return context;
+    }
+
+    /**
+     * @brief 可能有任务的槽位数
+     */
+    size_t usedSlots() const {
+        return slotLimit_.load(std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief 在槽位上启动池线程，构造期间或在 spawnMutex_ 内调用
+     */
+    void launch(size_t index) {
+        WorkerSlot& slot = *workers_[index];
+        slot.active.store(true);
+        liveThreads_.fetch_add(1);
+        if (slotLimit_.load() < index + 1) {
+            slotLimit_.store(index + 1);
+        }
+        slot.thread = std::thread([this, index]() { workerLoop(index); });
+    }
+
+    /**
+     * @brief 在空闲的额外槽位上启动一个线程
+     *
+     * @return true 启动了线程
+     * @return false 已达到最大线程数或线程池正在停止
+     */
+    bool spawnThread() {
+        std::lock_guard<std::mutex> lock(spawnMutex_);
+        if (stopping_.load()) {
+            return false;
+        }
+        for (size_t i = coreThreads_; i < workers_.size(); ++i) {
+            WorkerSlot& slot = *workers_[i];
+            if (slot.active.load()) {
+                continue;
+            }
+            // 上一个线程已经退出或正在退出
+            if (slot.thread.joinable()) {
+                slot.thread.join();
+            }
+            try {
+                launch(i);
+            } catch (const std::system_error&) {
+                slot.active.store(false);
+                liveThreads_.fetch_sub(1);
+                return false;
+            }
+            spawnedThreads_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief 池线程进入阻塞区域，可运行的线程少于常驻线程数时补充一个线程
+     */
+    void enterBlocking() {
+        size_t blocked = blockedThreads_.fetch_add(1) + 1;
+        if (isElastic() && liveThreads_.load() < coreThreads_ + blocked) {
+            spawnThread();
+        }
+    }
+
+    void leaveBlocking() {
+        // 多出来的线程在空闲 keepAlive 后自行退出
+        blockedThreads_.fetch_sub(1);
+    }
+
+    /**
+     * @brief 弹性模式的监视线程：任务积压且没有休眠的池线程持续一个采样间隔时增加线程
+     */
+    void monitorLoop() {
+        detail::setCurrentThreadName(options_.threadNamePrefix + "-mon");
+        bool starvedBefore = false;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(monitorMutex_);
+                monitorCondition_.wait_for(lock, options_.spawnThreshold, [this]() { return stopping_.load(); });
+            }
+            if (stopping_.load()) {
+                break;
+            }
+
+            bool starved = sleepers_.load(std::memory_order_seq_cst) == 0 && hasVisibleWork();
+            if (starved && starvedBefore) {
+                spawnThread();
+            }
+            starvedBefore = starved;
+        }
+    }
+
+    /**
+     * @brief 按放置策略确定池线程的节点和CPU
+     */
+    void placeWorker(WorkerSlot& slot, size_t index, const CpuTopology& topology) {
+        if (options_.placement == PoolPlacement::PER_PHYSICAL_CORE) {
+            const std::vector<int>& cores = topology.getCoreCpus();
+            int cpu = cores[index % cores.size()];
+            slot.cpus.push_back(cpu);
+            slot.node = topology.getNodeOfCpu(cpu);
+        } else if (options_.placement == PoolPlacement::NUMA_NODES) {
+            const std::vector<int>& cpus = topology.getCpus();
+            slot.node = topology.getNodeOfCpu(cpus[index % cpus.size()]);
+            slot.cpus = topology.getNodeCpus(slot.node);
+        }
+        if (slot.node >= injectQueues_.size()) {
+            slot.node = 0;
+        }
+    }
+
+    /**
+     * @brief 调用线程当前所在的节点
+     */
+    size_t callerNode() const {
+        if (injectQueues_.size() == 1) {
+            return 0;
+        }
+        const WorkerContext& context = currentContext();
+        if (context.pool == this) {
+            return workers_[context.index]->node;
+        }
+        int cpu = sched_getcpu();
+        size_t node = cpu < 0 ? 0 : CpuTopology::get().getNodeOfCpu(cpu);
+        return node < injectQueues_.size() ? node : 0;
+    }
+
+    /**
+     * @brief 池外提交使用的注入队列：调用线程所在节点的队列
+     */
+    InjectQueue& callerInjectQueue() {
+        return *injectQueues_[callerNode()];
+    }
+
+    /**
+     * @brief 所有注入队列中的任务数（近似值）
+     */
+    size_t getInjectedCount() const {
+        size_t count = 0;
+        for (const auto& queue : injectQueues_) {
+            count += queue->size.load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    /**
+     * @brief 有休眠线程时唤醒其中一个
+     */
+    void wakeOne() {
+        // 与 park() 配对：任务的 seq_cst 发布和这里的 seq_cst 读取保证
+        // 要么提交者看到休眠者，要么休眠者在复查时看到新任务
+        if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+            {
+                std::lock_guard<std::mutex> lock(parkMutex_);
+            }
+            parkCondition_.notify_one();
+        }
+    }
+
+    /**
+     * @brief 按新任务数量唤醒休眠线程
+     */
+    void wake(size_t count) {
+        size_t sleepers = sleepers_.load(std::memory_order_seq_cst);
+        if (sleepers == 0) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(parkMutex_);
+        }
+        if (count >= sleepers) {
+            parkCondition_.notify_all();
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                parkCondition_.notify_one();
+            }
+        }
+    }
+
+    /**
+     * @brief 池线程主循环
+     */
+    void workerLoop(size_t index) {
+        WorkerContext& context = currentContext();
+        context.pool = this;
+        context.index = index;
+
+        WorkerSlot& self = *workers_[index];
+        detail::setCurrentThreadName(options_.threadNamePrefix + "-" + std::to_string(index));
+        if (!self.cpus.empty()) {
+            detail::setCurrentThreadAffinity(self.cpus);
+        }
+
+        while (true) {
+            PoolTask* task = nullptr;
+            if (findTask(self, index, task)) {
+                runTask(self, task);
+                continue;
+            }
+
+            if (!park(self, index)) {
+                break;
+            }
+        }
+
+        context.pool = nullptr;
+    }
+
+    /**
+     * @brief 查找下一个任务
+     *
+     * 没有类别任务时只走 本地队列 → 注入队列 → 窃取。否则按 CRITICAL → NORMAL → 普通任务 → BATCH
+     * 的顺序查找；较低级别有任务等待时记录连续执行高级别任务的次数，达到 starvationLimit 后
+     * 轮流从较低的级别取一个任务。
+     */
+    bool findTask(WorkerSlot& self, size_t index, PoolTask*& task) {
+        if (classedPending_.load(std::memory_order_relaxed) == 0) {
+            self.priorityStreak = 0;
+            return findUnclassed(self, index, task);
+        }
+
+        if (options_.starvationLimit > 0 && self.priorityStreak >= options_.starvationLimit) {
+            self.priorityStreak = 0;
+            if (takeStarved(self, index, task)) {
+                return true;
+            }
+        }
+
+        if (takeClassed(PriorityClass::CRITICAL, task, false)) {
+            notePick(self, 0);
+            return true;
+        }
+        if (takeClassed(PriorityClass::NORMAL, task, false)) {
+            notePick(self, 1);
+            return true;
+        }
+        if (findUnclassed(self, index, task)) {
+            notePick(self, 2);
+            return true;
+        }
+        if (takeClassed(PriorityClass::BATCH, task, false)) {
+            self.priorityStreak = 0;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief 记录一次按级别的选择
+     *
+     * 级别 0 为 CRITICAL，1 为 NORMAL，2 为普通任务，3 为 BATCH。普通任务只检查本地队列和注入队列。
+     */
+    void notePick(WorkerSlot& self, size_t level) {
+        bool lowerWaiting = classQueues_[static_cast<size_t>(PriorityClass::BATCH)].size.load(std::memory_order_relaxed) > 0;
+        if (!lowerWaiting && level < 2) {
+            lowerWaiting = !self.deque.empty() || getInjectedCount() > 0;
+        }
+        if (!lowerWaiting && level < 1) {
+            lowerWaiting = classQueues_[static_cast<size_t>(PriorityClass::NORMAL)].size.load(std::memory_order_relaxed) > 0;
+        }
+        self.priorityStreak = lowerWaiting ? self.priorityStreak + 1 : 0;
+    }
+
+    /**
+     * @brief 饥饿保护：轮流从 BATCH、普通任务、NORMAL 中取一个任务
+     */
+    bool takeStarved(WorkerSlot& self, size_t index, PoolTask*& task) {
+        for (size_t k = 0; k < 3; ++k) {
+            size_t level = 3 - (self.starvationCursor + k) % 3;
+            bool found = level == 2 ? findUnclassed(self, index, task)
+                                    : takeClassed(level == 3 ? PriorityClass::BATCH : PriorityClass::NORMAL, task, true);
+            if (found) {
+                self.starvationCursor = (self.starvationCursor + k + 1) % 3;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 把任务放入类别队列
+     */
+    void pushClassed(PoolTask* const* tasks, size_t count, const TaskOptions& options) {
+        ClassQueue& queue = classQueues_[static_cast<size_t>(options.priorityClass)];
+        auto now = std::chrono::steady_clock::now();
+        auto deadline = options.hasDeadline() ? options.deadline : std::chrono::steady_clock::time_point::max();
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            // 在锁内先增加总数，取出方在锁内减少，总数不会短暂下溢
+            classedPending_.fetch_add(count, std::memory_order_seq_cst);
+            for (size_t i = 0; i < count; ++i) {
+                queue.heap.push_back(ClassEntry{deadline, queue.nextSequence++, now, tasks[i]});
+                std::push_heap(queue.heap.begin(), queue.heap.end(), ClassEntryLater());
+            }
+            queue.size.store(queue.heap.size(), std::memory_order_relaxed);
+        }
+        queue.submitted.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 从类别队列取出截止时间最早的任务，并记录等待时间
+     *
+     * @param promoted 是否因饥饿保护而取出
+     */
+    bool takeClassed(PriorityClass priorityClass, PoolTask*& task, bool promoted) {
+        ClassQueue& queue = classQueues_[static_cast<size_t>(priorityClass)];
+        if (queue.size.load(std::memory_order_relaxed) == 0) {
+            return false;
+        }
+
+        ClassEntry entry;
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.heap.empty()) {
+                return false;
+            }
+            std::pop_heap(queue.heap.begin(), queue.heap.end(), ClassEntryLater());
+            entry = queue.heap.back();
+            queue.heap.pop_back();
+            queue.size.store(queue.heap.size(), std::memory_order_relaxed);
+            classedPending_.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        uint64_t wait = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - entry.enqueued).count());
+        queue.executed.fetch_add(1, std::memory_order_relaxed);
+        queue.totalWaitNs.fetch_add(wait, std::memory_order_relaxed);
+        uint64_t longest = queue.maxWaitNs.load(std::memory_order_relaxed);
+        while (wait > longest && !queue.maxWaitNs.compare_exchange_weak(longest, wait, std::memory_order_relaxed)) {
+        }
+        if (now > entry.deadline) {
+            queue.deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (promoted) {
+            queue.starvationPromotions.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        task = entry.task;
+        return true;
+    }
+
+    /**
+     * @brief 按 本地队列 → 注入队列 → 窃取 的顺序查找普通任务
+     */
+    bool findUnclassed(WorkerSlot& self, size_t index, PoolTask*& task) {
+        if (self.deque.pop(task)) {
+            return true;
+        }
+        if (takeInjected(self.node, task)) {
+            return true;
+        }
+        return trySteal(self, index, task);
+    }
+
+    /**
+     * @brief 从注入队列取出任务，先取指定节点的队列，再取其它节点的
+     */
+    bool takeInjected(size_t node, PoolTask*& task) {
+        size_t count = injectQueues_.size();
+        for (size_t k = 0; k < count; ++k) {
+            InjectQueue& queue = *injectQueues_[(node + k) % count];
+            if (queue.size.load(std::memory_order_relaxed) == 0) {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) {
+                continue;
+            }
+
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+            queue.size.store(queue.tasks.size(), std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief 从随机起点开始依次尝试窃取其它池线程的任务
+     *
+     * 有多个节点时先窃取同一节点的池线程，再跨节点窃取。
+     */
+    bool trySteal(WorkerSlot& self, size_t index, PoolTask*& task) {
+        size_t count = usedSlots();
+        if (count < 2) {
+            return false;
+        }
+
+        self.stealAttempts.fetch_add(1, std::memory_order_relaxed);
+
+        // xorshift64 选择起始受害者
+        uint64_t x = self.rngState;
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        self.rngState = x;
+
+        size_t start = static_cast<size_t>(x % count);
+        size_t passes = injectQueues_.size() > 1 ? 2 : 1;
+        for (size_t pass = 0; pass < passes; ++pass) {
+            for (size_t k = 0; k < count; ++k) {
+                size_t victim = (start + k) % count;
+                if (victim == index) {
+                    continue;
+                }
+                if (passes == 2 && (workers_[victim]->node == self.node) != (pass == 0)) {
+                    continue;
+                }
+                if (workers_[victim]->deque.steal(task)) {
+                    self.steals.fetch_add(1, std::memory_order_relaxed);
+                    TF_TRACE(TraceKind::STEAL, TracePhase::INSTANT, 0, victim);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 池外线程窃取任务，起点轮转以分散竞争
+     */
+    bool stealFromOutside(PoolTask*& task) {
+        size_t count = usedSlots();
+        size_t start = outsideStealCursor_.fetch_add(1, std::memory_order_relaxed);
+        for (size_t k = 0; k < count; ++k) {
+            if (workers_[(start + k) % count]->deque.steal(task)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 检查是否有任何可见的待执行任务
+     */
+    bool hasVisibleWork() const {
+        if (classedPending_.load(std::memory_order_seq_cst) > 0) {
+            return true;
+        }
+        for (const auto& queue : injectQueues_) {
+            if (queue->size.load(std::memory_order_seq_cst) > 0) {
+                return true;
+            }
+        }
+        size_t slots = usedSlots();
+        for (size_t i = 0; i < slots; ++i) {
+            if (!workers_[i]->deque.empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 没有任务时休眠
+     *
+     * 弹性模式的额外线程最多休眠 keepAlive，超时后仍没有任务就退出。
+     *
+     * @return true 被唤醒或发现新任务，继续查找
+     * @return false 线程池正在停止且没有剩余任务，或者额外线程空闲超时，池线程应退出
+     */
+    bool park(WorkerSlot& self, size_t index) {
+        std::unique_lock<std::mutex> lock(parkMutex_);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+
+        if (hasVisibleWork()) {
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        if (stopping_.load()) {
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        if (idleWaiters_ > 0) {
+            idleCondition_.notify_all(); // 可能是最后一个进入休眠的池线程
+        }
+
+        self.idleParks.fetch_add(1, std::memory_order_relaxed);
+        auto idleStart = std::chrono::steady_clock::now();
+        bool timedOut = false;
+        if (index < coreThreads_) {
+            parkCondition_.wait(lock);
+        } else {
+            timedOut = parkCondition_.wait_for(lock, options_.keepAlive) == std::cv_status::timeout;
+        }
+        auto idleTime = std::chrono::steady_clock::now() - idleStart;
+        self.idleTimeNs.fetch_add(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(idleTime).count()), std::memory_order_relaxed);
+
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        // 在 parkMutex_ 内复查，提交者的唤醒不会丢给一个正在退出的线程
+        if (timedOut && !stopping_.load() && !hasVisibleWork()) {
+            liveThreads_.fetch_sub(1);
+            retiredThreads_.fetch_add(1, std::memory_order_relaxed);
+            self.active.store(false);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 执行任务，异常不会逃逸出池线程
+     *
+     * 任务期间从当前线程临时内存分配的内存在任务结束时回收。
+     */
+    void runTask(WorkerSlot& self, PoolTask* task) {
+        if (!discardTask(task)) {
+            ScratchScope scratch;
+            try {
+                task->execute();
+            } catch (...) {
+                // 任务自身负责报告错误，这里只保护池线程
+            }
+        }
+        task->release();
+        self.tasksExecuted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 丢弃模式下尝试放弃任务
+     *
+     * @return true 任务已放弃，不应再执行
+     */
+    bool discardTask(PoolTask* task) {
+        if (!discarding_.load(std::memory_order_relaxed) || !task->discard()) {
+            return false;
+        }
+        discardedTasks_.add();
+        return true;
+    }
+};
+
+/**
+ * @brief 标记池线程即将阻塞
+ *
+ * 在池线程中执行阻塞调用（同步IO、等待锁或其它结果）之前创建，守卫销毁时结束阻塞区域。
+ * 弹性线程池在可运行的线程少于常驻线程数时补充一个线程，其它情况下只记录阻塞的线程数。
+ * 在池外线程上没有任何作用，可以嵌套。
+ *
+ * @code
+ * {
+ *     auto region = blockingRegion();
+ *     response = client.fetch(url);
+ * }
+ * @endcode
+ */
+inline ThreadPool::BlockingRegion blockingRegion() {
+    return ThreadPool::BlockingRegion();
+}
+
+} // namespace thread_framework
+
+#endif // THREAD_POOL_H
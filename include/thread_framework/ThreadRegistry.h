@@ -0,0 +1,359 @@
+#ifndef THREAD_REGISTRY_H
+#define THREAD_REGISTRY_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @file ThreadRegistry.h
+ * @brief 无锁读取的线程登记表
+ *
+ * 线程管理器用这个登记表保存所有工作者条目。条目存放在只增不减的分段槽位数组中，
+ * 地址在整个生命周期内保持稳定；ID中带有槽位的代数，槽位被回收重用后旧ID自动失效。
+ * 查询和遍历不加锁，只有登记和回收之间使用互斥锁。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief 分段槽位登记表
+ *
+ * 读取方通过槽位上的读者计数保护条目：先增加计数再检查槽位状态和代数，
+ * 回收方先把状态改为回收中再等待读者计数归零，因此读取方永远不会看到被销毁的条目，
+ * 也不会被其它读取方或登记操作阻塞。
+ *
+ * ID格式：高32位为代数，低32位为槽位下标。
+ *
+ * @tparam Entry 条目类型，必须可默认构造并提供 reset() 方法
+ */
+template <typename Entry>
+class ThreadRegistry {
+    static_assert(sizeof(size_t) >= 8, "ThreadRegistry IDs require a 64-bit size_t");
+
+private:
+    enum SlotStatus : uint32_t {
+        SLOT_FREE = 0,      ///< 空闲
+        SLOT_LIVE = 1,      ///< 已登记，可以读取
+        SLOT_RETIRING = 2   ///< 正在回收
+    };
+
+    struct Slot {
+        std::atomic<uint32_t> status{SLOT_FREE};
+        std::atomic<uint32_t> generation{1};
+        std::atomic<uint32_t> readers{0};
+        Entry entry;
+    };
+
+    static constexpr size_t kSegmentBits = 10;
+    static constexpr size_t kSegmentSize = size_t(1) << kSegmentBits;
+    static constexpr size_t kMaxSegments = 4096;
+
+    struct Segment {
+        Slot slots[kSegmentSize];
+    };
+
+public:
+    /**
+     * @brief 条目的读取句柄
+     *
+     * 句柄存在期间条目不会被回收。句柄只能移动，析构时释放读者计数。
+     */
+    class Handle {
+    public:
+        Handle() = default;
+        Handle(Handle&& other) noexcept : slot_(other.slot_), id_(other.id_) { other.slot_ = nullptr; }
+        Handle& operator=(Handle&& other) noexcept {
+            if (this != &other) {
+                release();
+                slot_ = other.slot_;
+                id_ = other.id_;
+                other.slot_ = nullptr;
+            }
+            return *this;
+        }
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+        ~Handle() { release(); }
+
+        explicit operator bool() const { return slot_ != nullptr; }
+        Entry& operator*() const { return slot_->entry; }
+        Entry* operator->() const { return &slot_->entry; }
+        Entry* get() const { return slot_ ? &slot_->entry : nullptr; }
+        size_t id() const { return id_; }
+
+    private:
+        friend class ThreadRegistry;
+        Handle(Slot* slot, size_t id) : slot_(slot), id_(id) {}
+
+        void release() {
+            if (slot_) {
+                slot_->readers.fetch_sub(1, std::memory_order_seq_cst);
+                slot_ = nullptr;
+            }
+        }
+
+        Slot* slot_ = nullptr;
+        size_t id_ = 0;
+    };
+
+    ThreadRegistry() : segments_(new std::atomic<Segment*>[kMaxSegments]) {
+        for (size_t i = 0; i < kMaxSegments; ++i) {
+            segments_[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~ThreadRegistry() {
+        for (size_t i = 0; i < kMaxSegments; ++i) {
+            delete segments_[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    ThreadRegistry(const ThreadRegistry&) = delete;
+    ThreadRegistry& operator=(const ThreadRegistry&) = delete;
+
+    /**
+     * @brief 登记新条目
+     *
+     * init 在条目发布之前执行，此时其它线程还看不到这个条目。
+     *
+     * @param init 初始化函数，参数为 Entry&
+     * @return size_t 条目ID，槽位耗尽时返回 SIZE_MAX
+     */
+    template <typename Init>
+    size_t insert(Init&& init) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        size_t index;
+        if (!allocateSlot(index)) {
+            return SIZE_MAX;
+        }
+
+        size_t id = publish(index, init);
+        size_.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    /**
+     * @brief 批量登记条目
+     *
+     * 所有条目在一次加锁内分配和发布。槽位耗尽时只登记前面的部分条目。
+     *
+     * @param count 条目数量
+     * @param init 初始化函数，参数为 (size_t 序号, Entry&)
+     * @param ids 输出参数，依次追加已登记条目的ID
+     * @return size_t 实际登记的数量
+     */
+    template <typename Init>
+    size_t insertBatch(size_t count, Init&& init, std::vector<size_t>& ids) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        ids.reserve(ids.size() + count);
+        size_t inserted = 0;
+        for (; inserted < count; ++inserted) {
+            size_t index;
+            if (!allocateSlot(index)) {
+                break;
+            }
+
+            size_t position = inserted;
+            ids.push_back(publish(index, [&init, position](Entry& entry) { init(position, entry); }));
+        }
+
+        size_.fetch_add(inserted, std::memory_order_relaxed);
+        return inserted;
+    }
+
+    /**
+     * @brief 按ID获取条目
+     *
+     * 无锁，不会被登记、回收或其它读取阻塞。
+     *
+     * @param id 条目ID
+     * @return Handle 读取句柄，条目不存在时为空
+     */
+    Handle acquire(size_t id) const {
+        size_t index = static_cast<size_t>(id & 0xFFFFFFFFu);
+        uint32_t generation = static_cast<uint32_t>(id >> 32);
+
+        if (index >= highWater_.load(std::memory_order_acquire)) {
+            return Handle();
+        }
+
+        Slot* slot = slotAt(index);
+        if (!pin(slot)) {
+            return Handle();
+        }
+        if (slot->generation.load(std::memory_order_acquire) != generation) {
+            slot->readers.fetch_sub(1, std::memory_order_seq_cst);
+            return Handle();
+        }
+        return Handle(slot, id);
+    }
+
+    /**
+     * @brief 遍历所有已登记的条目
+     *
+     * 无锁遍历，遍历期间新登记或回收的条目是否被访问不确定。
+     *
+     * @param fn 访问函数，参数为 (size_t id, Entry&)
+     */
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        size_t limit = highWater_.load(std::memory_order_acquire);
+        for (size_t index = 0; index < limit; ++index) {
+            Slot* slot = slotAt(index);
+            if (slot->status.load(std::memory_order_relaxed) != SLOT_LIVE || !pin(slot)) {
+                continue;
+            }
+
+            Handle handle(slot, makeId(slot->generation.load(std::memory_order_acquire), index));
+            fn(handle.id(), handle.slot_->entry);
+        }
+    }
+
+    /**
+     * @brief 回收条目
+     *
+     * 等待所有读者释放后调用 cleanup，然后重置条目并把槽位放回空闲列表。
+     * 同一条目只有一个调用者能回收成功。
+     *
+     * @param id 条目ID
+     * @param cleanup 回收函数，参数为 Entry&
+     * @return true 回收成功
+     * @return false 条目不存在或正在被其它调用者回收
+     */
+    template <typename Cleanup>
+    bool retire(size_t id, Cleanup&& cleanup) {
+        size_t index = static_cast<size_t>(id & 0xFFFFFFFFu);
+        uint32_t generation = static_cast<uint32_t>(id >> 32);
+
+        if (index >= highWater_.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        Slot* slot = slotAt(index);
+        if (slot->generation.load(std::memory_order_acquire) != generation) {
+            return false;
+        }
+
+        uint32_t expected = SLOT_LIVE;
+        if (!slot->status.compare_exchange_strong(expected, SLOT_RETIRING, std::memory_order_seq_cst)) {
+            return false;
+        }
+        if (slot->generation.load(std::memory_order_acquire) != generation) {
+            // 槽位在检查之后被重用，恢复状态
+            slot->status.store(SLOT_LIVE, std::memory_order_release);
+            return false;
+        }
+
+        // 读者持有时间都很短，让出CPU等待即可
+        while (slot->readers.load(std::memory_order_seq_cst) != 0) {
+            std::this_thread::yield();
+        }
+
+        cleanup(slot->entry);
+        slot->entry.reset();
+
+        uint32_t next = generation + 1;
+        if (next == 0 || next == 0xFFFFFFFFu) {
+            next = 1;
+        }
+        slot->generation.store(next, std::memory_order_release);
+        slot->status.store(SLOT_FREE, std::memory_order_release);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        freeList_.push_back(index);
+        return true;
+    }
+
+    /**
+     * @brief 获取已登记的条目数量
+     */
+    size_t size() const {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 获取曾经使用过的槽位数量
+     */
+    size_t capacity() const {
+        return highWater_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::unique_ptr<std::atomic<Segment*>[]> segments_;
+    std::atomic<size_t> highWater_{0};
+    std::atomic<size_t> size_{0};
+    std::mutex mutex_;               ///< 只保护空闲列表和槽位分配
+    std::vector<size_t> freeList_;
+
+    /**
+     * @brief 分配一个空闲槽位，调用方持有 mutex_
+     */
+    bool allocateSlot(size_t& index) {
+        if (!freeList_.empty()) {
+            index = freeList_.back();
+            freeList_.pop_back();
+            return true;
+        }
+
+        index = highWater_.load(std::memory_order_relaxed);
+        if (index >= kMaxSegments * kSegmentSize) {
+            return false;
+        }
+
+        size_t segment = index >> kSegmentBits;
+        if (segments_[segment].load(std::memory_order_relaxed) == nullptr) {
+            segments_[segment].store(new Segment(), std::memory_order_release);
+        }
+        highWater_.store(index + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 初始化并发布槽位中的条目
+     */
+    template <typename Init>
+    size_t publish(size_t index, Init&& init) {
+        Slot& slot = *slotAt(index);
+        init(slot.entry);
+
+        size_t id = makeId(slot.generation.load(std::memory_order_relaxed), index);
+        slot.status.store(SLOT_LIVE, std::memory_order_release);
+        return id;
+    }
+
+    static size_t makeId(uint32_t generation, size_t index) {
+        return (static_cast<size_t>(generation) << 32) | index;
+    }
+
+    Slot* slotAt(size_t index) const {
+        Segment* segment = segments_[index >> kSegmentBits].load(std::memory_order_acquire);
+        return &segment->slots[index & (kSegmentSize - 1)];
+    }
+
+    /**
+     * @brief 增加读者计数并确认槽位处于已登记状态
+     */
+    static bool pin(Slot* slot) {
+        slot->readers.fetch_add(1, std::memory_order_seq_cst);
+        if (slot->status.load(std::memory_order_seq_cst) != SLOT_LIVE) {
+            slot->readers.fetch_sub(1, std::memory_order_seq_cst);
+            return false;
+        }
+        return true;
+    }
+};
+
+} // namespace thread_framework
+
+#endif // THREAD_REGISTRY_H
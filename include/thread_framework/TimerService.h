@@ -0,0 +1,358 @@
+#ifndef TIMER_SERVICE_H
+#define TIMER_SERVICE_H
+
+#include <thread>
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+/**
+ * @file TimerService.h
+ * @brief 共享定时服务
+ *
+ * 基于最小堆的定时器队列，在一个或少量线程上驱动大量周期性定时器，
+ * 替代每个定时器独占一个大部分时间都在休眠的线程。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief 共享定时服务
+ *
+ * 周期定时器按绝对截止时间调度：下一次触发时间 = 上一次截止时间 + 间隔，
+ * 回调本身的执行时间不会累积成漂移。如果服务落后超过一个间隔，
+ * 错过的触发会被跳过而不是连续补发。回调在服务线程上执行，应尽量简短。
+ */
+class TimerService {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = uint64_t;
+
+    /**
+     * @brief 构造函数
+     *
+     * @param threadCount 服务线程数量，至少为1
+     */
+    explicit TimerService(size_t threadCount = 1) {
+        if (threadCount == 0) {
+            threadCount = 1;
+        }
+
+        threads_.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i) {
+            threads_.emplace_back([this]() { serviceLoop(); });
+        }
+    }
+
+    /**
+     * @brief 析构函数
+     *
+     * 停止服务线程，尚未触发的定时器被丢弃
+     */
+    ~TimerService() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        condition_.notify_all();
+
+        for (auto& thread : threads_) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+    TimerService(const TimerService&) = delete;
+    TimerService& operator=(const TimerService&) = delete;
+
+    /**
+     * @brief 注册周期定时器
+     *
+     * 第一次触发在 interval 之后。
+     *
+     * @param interval 触发间隔，必须大于0
+     * @param callback 回调函数，返回false表示不再继续触发
+     * @return TimerId 定时器ID
+     */
+    template <typename Rep, typename Period>
+    TimerId schedulePeriodic(const std::chrono::duration<Rep, Period>& interval, std::function<bool()> callback) {
+        auto period = std::chrono::duration_cast<Clock::duration>(interval);
+        if (period <= Clock::duration::zero()) {
+            period = Clock::duration(1);
+        }
+        return addTimer(Clock::now() + period, period, std::move(callback));
+    }
+
+    /**
+     * @brief 注册周期定时器，在定时器能够触发之前把ID交给调用方
+     *
+     * onRegistered 在服务内部的锁中、定时器进入调度之前调用，只应保存ID和读取原子状态，
+     * 不能再调用 TimerService 的方法；返回 true 时第一次触发提前到现在。
+     * 用于让并发的 fireNow()/cancel() 总能看到ID，不会在注册完成前落空。
+     *
+     * @param interval 触发间隔，必须大于0
+     * @param callback 回调函数，返回false表示不再继续触发
+     * @param onRegistered 接收定时器ID，返回是否立即触发
+     * @return TimerId 定时器ID
+     */
+    template <typename Rep, typename Period>
+    TimerId schedulePeriodic(const std::chrono::duration<Rep, Period>& interval, std::function<bool()> callback,
+                             const std::function<bool(TimerId)>& onRegistered) {
+        auto period = std::chrono::duration_cast<Clock::duration>(interval);
+        if (period <= Clock::duration::zero()) {
+            period = Clock::duration(1);
+        }
+        return addTimer(Clock::now() + period, period, std::move(callback), &onRegistered);
+    }
+
+    /**
+     * @brief 注册单次定时器
+     *
+     * @param delay 延迟时长
+     * @param callback 回调函数
+     * @return TimerId 定时器ID
+     */
+    template <typename Rep, typename Period>
+    TimerId scheduleAfter(const std::chrono::duration<Rep, Period>& delay, std::function<void()> callback) {
+        return scheduleAt(Clock::now() + std::chrono::duration_cast<Clock::duration>(delay), std::move(callback));
+    }
+
+    /**
+     * @brief 注册在指定时间点触发的单次定时器
+     *
+     * @param deadline 触发时间点
+     * @param callback 回调函数
+     * @return TimerId 定时器ID
+     */
+    TimerId scheduleAt(Clock::time_point deadline, std::function<void()> callback) {
+        return addTimer(deadline, Clock::duration::zero(), [callback = std::move(callback)]() {
+            if (callback) {
+                callback();
+            }
+            return false;
+        });
+    }
+
+    /**
+     * @brief 取消定时器
+     *
+     * 如果回调正在执行，本次执行会完成，但不会再被调度。
+     *
+     * @param id 定时器ID
+     * @return true 取消成功
+     * @return false 定时器不存在或已结束
+     */
+    bool cancel(TimerId id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto it = timers_.find(id);
+        if (it == timers_.end()) {
+            return false;
+        }
+
+        if (it->second->running) {
+            it->second->cancelled = true;
+        } else {
+            timers_.erase(it); // 堆中残留的条目会被惰性跳过
+        }
+        return true;
+    }
+
+    /**
+     * @brief 让定时器立即触发
+     *
+     * 用于让等待中的定时器尽快观察到停止等状态变化。
+     * 如果回调正在执行，回调返回后立即再次触发。
+     *
+     * @param id 定时器ID
+     * @return true 操作成功
+     * @return false 定时器不存在或已结束
+     */
+    bool fireNow(TimerId id) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            auto it = timers_.find(id);
+            if (it == timers_.end()) {
+                return false;
+            }
+
+            Timer& timer = *it->second;
+            if (timer.running) {
+                timer.expedite = true;
+                return true;
+            }
+
+            timer.deadline = Clock::now();
+            timer.generation++;
+            heap_.push(HeapEntry{timer.deadline, timer.generation, id});
+        }
+        condition_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief 获取已注册的定时器数量
+     */
+    size_t getTimerCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return timers_.size();
+    }
+
+    /**
+     * @brief 获取服务线程数量
+     */
+    size_t getThreadCount() const {
+        return threads_.size();
+    }
+
+    /**
+     * @brief 获取因服务落后而跳过的触发次数
+     */
+    uint64_t getMissedTicks() const {
+        return missedTicks_.load(std::memory_order_relaxed);
+    }
+
+private:
+    /**
+     * @brief 定时器状态
+     */
+    struct Timer {
+        Clock::time_point deadline;       ///< 下一次触发的绝对时间
+        Clock::duration interval;         ///< 触发间隔，0表示单次定时器
+        std::function<bool()> callback;   ///< 回调函数
+        uint64_t generation = 0;          ///< 与堆条目匹配，用于惰性删除
+        bool running = false;             ///< 回调正在执行
+        bool cancelled = false;           ///< 执行期间被取消
+        bool expedite = false;            ///< 执行期间被要求立即再次触发
+    };
+
+    /**
+     * @brief 最小堆条目
+     */
+    struct HeapEntry {
+        Clock::time_point deadline;
+        uint64_t generation;
+        TimerId id;
+
+        bool operator>(const HeapEntry& other) const {
+            return deadline > other.deadline;
+        }
+    };
+
+    std::vector<std::thread> threads_;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap_;
+    std::unordered_map<TimerId, std::unique_ptr<Timer>> timers_;
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    bool stopping_ = false;
+    TimerId nextTimerId_ = 1;
+    std::atomic<uint64_t> missedTicks_{0};
+
+    TimerId addTimer(Clock::time_point deadline, Clock::duration interval, std::function<bool()> callback,
+                     const std::function<bool(TimerId)>* onRegistered = nullptr) {
+        TimerId id;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            id = nextTimerId_++;
+            if (onRegistered && *onRegistered && (*onRegistered)(id)) {
+                deadline = Clock::now();
+            }
+
+            auto timer = std::make_unique<Timer>();
+            timer->deadline = deadline;
+            timer->interval = interval;
+            timer->callback = std::move(callback);
+            heap_.push(HeapEntry{deadline, timer->generation, id});
+            timers_.emplace(id, std::move(timer));
+        }
+        condition_.notify_one();
+        return id;
+    }
+
+    /**
+     * @brief 服务线程主循环
+     */
+    void serviceLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        while (!stopping_) {
+            if (heap_.empty()) {
+                condition_.wait(lock);
+                continue;
+            }
+
+            HeapEntry top = heap_.top();
+            auto it = timers_.find(top.id);
+            if (it == timers_.end() || it->second->generation != top.generation) {
+                heap_.pop(); // 已取消或已重新调度的残留条目
+                continue;
+            }
+
+            if (top.deadline > Clock::now()) {
+                condition_.wait_until(lock, top.deadline);
+                continue;
+            }
+
+            heap_.pop();
+            // unique_ptr 保证执行期间定时器对象地址稳定
+            Timer& timer = *it->second;
+            timer.running = true;
+
+            lock.unlock();
+            bool again = false;
+            try {
+                again = timer.callback();
+            } catch (...) {
+                again = timer.interval > Clock::duration::zero();
+            }
+            lock.lock();
+
+            timer.running = false;
+            if (!again || timer.cancelled || timer.interval == Clock::duration::zero()) {
+                timers_.erase(top.id);
+                continue;
+            }
+
+            reschedule(timer, top.id);
+        }
+    }
+
+    /**
+     * @brief 按绝对截止时间计算下一次触发
+     */
+    void reschedule(Timer& timer, TimerId id) {
+        Clock::time_point now = Clock::now();
+
+        if (timer.expedite) {
+            timer.expedite = false;
+            timer.deadline = now;
+        } else {
+            timer.deadline += timer.interval;
+            if (timer.deadline <= now) {
+                // 落后超过一个间隔，跳过错过的触发并对齐到原有节拍
+                auto missed = (now - timer.deadline) / timer.interval + 1;
+                timer.deadline += timer.interval * missed;
+                missedTicks_.fetch_add(static_cast<uint64_t>(missed), std::memory_order_relaxed);
+            }
+        }
+
+        timer.generation++;
+        heap_.push(HeapEntry{timer.deadline, timer.generation, id});
+    }
+};
+
+} // namespace thread_framework
+
+#endif // TIMER_SERVICE_H
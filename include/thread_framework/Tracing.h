@@ -0,0 +1,599 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @file Tracing.h
+ * @brief 低开销的执行跟踪
+ *
+ * 跟踪事件写入每个线程自己的缓冲区，不加锁、不分配内存（线程第一次记录时分配缓冲区除外），
+ * 时间戳在 x86 上直接读取 TSC，导出时再按会话开始和结束时的 steady_clock 换算成时间。
+ * 缓冲区写满后丢弃新事件并计数。导出格式为 Chrome trace（JSON），可以用 chrome://tracing 或 Perfetto 打开。
+ *
+ * 编译时用 THREAD_FRAMEWORK_TRACING=0 去掉所有 TF_TRACE_* 调用；默认编译进来，
+ * 未开启跟踪时每个跟踪点只有一次 relaxed 原子读取和分支。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+/**
+ * @brief 是否编译跟踪点，默认为1
+ */
+#ifndef THREAD_FRAMEWORK_TRACING
+#define THREAD_FRAMEWORK_TRACING 1
+#endif
+
+namespace thread_framework {
+
+/**
+ * @brief 跟踪事件的种类
+ */
+enum class TraceKind : uint8_t {
+    INITIALIZE,     ///< onInitialize()，在创建线程上
+    START,          ///< onStart()
+    RUN,            ///< run() 或异步工作者的启动
+    CALLBACK,       ///< timeCallback() 包装的回调
+    PAUSE,          ///< 暂停期间（异步事件，可以跨越多次定时触发）
+    QUEUED,         ///< 从登记到开始执行（异步事件，开始和结束在不同线程上）
+    TIMER_FIRE,     ///< 定时触发：共享定时服务的一次 onTimerTick()，或 TimerWorker 的一次触发
+    STEAL           ///< 池线程从其它池线程窃取到任务
+};
+
+/**
+ * @brief 事件的阶段，对应 Chrome trace 的 ph 字段
+ */
+enum class TracePhase : uint8_t {
+    BEGIN,          ///< "B"，与同一线程上的 END 配对，必须嵌套
+    END,            ///< "E"
+    INSTANT,        ///< "i"
+    ASYNC_BEGIN,    ///< "b"，按工作者ID与 ASYNC_END 配对，可以在不同线程上
+    ASYNC_END       ///< "e"
+};
+
+/**
+ * @brief 一个跟踪事件
+ */
+struct TraceEvent {
+    uint64_t ticks;     ///< 时间戳（TSC 或 steady_clock 纳秒）
+    uint64_t worker;    ///< ThreadManager 中的线程ID，0 表示不属于某个工作者
+    uint64_t arg;       ///< 附加参数，STEAL 为受害者的池线程序号
+    TraceKind kind;
+    TracePhase phase;
+};
+
+namespace detail {
+
+/**
+ * @brief 单个线程的跟踪缓冲区
+ *
+ * 只有拥有它的线程写入；导出方读取 size() 之前的事件，这些事件不会再被修改。
+ */
+class TraceBuffer {
+public:
+    /**
+     * @brief 追加一个事件，缓冲区已满时丢弃并计数
+     */
+    void push(const TraceEvent& event) {
+        size_t size = size_.load(std::memory_order_relaxed);
+        if (size >= capacity_) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        events_[size] = event;
+        size_.store(size + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief 清空并切换到新的会话，只能由写入方（或没有写入方时）调用
+     */
+    void reset(size_t capacity, uint64_t generation) {
+        if (capacity != capacity_) {
+            events_.reset(new TraceEvent[capacity]);
+            capacity_ = capacity;
+        }
+        size_.store(0, std::memory_order_relaxed);
+        dropped_.store(0, std::memory_order_relaxed);
+        generation_.store(generation, std::memory_order_release);
+    }
+
+    uint64_t getGeneration() const {
+        return generation_.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    const TraceEvent& at(size_t index) const {
+        return events_[index];
+    }
+
+    uint64_t getDropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    long tid = 0;                   ///< 系统线程ID，由 Tracer 的互斥锁保护
+    char threadName[16] = {};       ///< 系统线程名称，由 Tracer 的互斥锁保护
+    bool orphaned = false;          ///< 拥有者线程已退出，由 Tracer 的互斥锁保护
+
+private:
+    std::unique_ptr<TraceEvent[]> events_;
+    size_t capacity_ = 0;
+    std::atomic<size_t> size_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> generation_{0};
+};
+
+} // namespace detail
+
+/**
+ * @brief 进程级的跟踪器
+ *
+ * start() 开始一个新会话并丢弃上一个会话的事件，stop() 停止记录，
+ * writeChromeTrace() 导出当前会话。导出可以在记录期间进行，但不能与 start() 同时调用。
+ * ThreadManager::startTracing() 等方法是对它的封装，并补充工作者名称。
+ */
+class Tracer {
+public:
+    static constexpr size_t DEFAULT_EVENTS_PER_THREAD = 16384; ///< 默认每个线程的事件容量
+    static constexpr uint64_t CURRENT_WORKER = UINT64_MAX;     ///< 使用当前线程正在执行的工作者ID
+
+    /**
+     * @brief 获取跟踪器
+     */
+    static Tracer& instance() {
+        // 有意不释放，线程退出时仍然会访问缓冲区列表
+        static Tracer* tracer = new Tracer();
+        return *tracer;
+    }
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    /**
+     * @brief 是否正在记录，跟踪点的快速检查
+     */
+    static bool isActive() {
+        return active_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 开始新的会话
+     *
+     * @param eventsPerThread 每个线程最多记录的事件数
+     */
+    void start(size_t eventsPerThread = DEFAULT_EVENTS_PER_THREAD) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_.store(eventsPerThread > 0 ? eventsPerThread : 1, std::memory_order_relaxed);
+        workerNames_.clear();
+        startTicks_ = readTicks();
+        startTime_ = std::chrono::steady_clock::now();
+        stopTicks_ = 0;
+        generation_.fetch_add(1, std::memory_order_release);
+        active_.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief 停止记录，已记录的事件保留到下一次 start()
+     */
+    void stop() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (active_.exchange(false, std::memory_order_relaxed)) {
+            stopTicks_ = readTicks();
+            stopTime_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    /**
+     * @brief 记录一个事件
+     *
+     * 通常通过 TF_TRACE_* 宏调用，宏会先检查 isActive()。
+     */
+    void record(TraceKind kind, TracePhase phase, uint64_t worker, uint64_t arg = 0) {
+        detail::TraceBuffer* buffer = localBuffer();
+        if (!buffer) {
+            return;
+        }
+        TraceEvent event;
+        event.ticks = readTicks();
+        event.worker = worker == CURRENT_WORKER ? currentWorker() : worker;
+        event.arg = arg;
+        event.kind = kind;
+        event.phase = phase;
+        buffer->push(event);
+    }
+
+    /**
+     * @brief 设置工作者在跟踪中显示的名称
+     */
+    void setWorkerName(uint64_t worker, const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        workerNames_[worker] = name;
+    }
+
+    /**
+     * @brief 获取当前会话中因缓冲区满而丢弃的事件数
+     */
+    uint64_t getDroppedCount() const {
+        uint64_t dropped = 0;
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t generation = generation_.load(std::memory_order_acquire);
+        for (const auto& buffer : buffers_) {
+            if (buffer->getGeneration() == generation) {
+                dropped += buffer->getDropped();
+            }
+        }
+        return dropped;
+    }
+
+    /**
+     * @brief 获取当前会话中已记录的事件数
+     */
+    size_t getEventCount() const {
+        size_t count = 0;
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t generation = generation_.load(std::memory_order_acquire);
+        for (const auto& buffer : buffers_) {
+            if (buffer->getGeneration() == generation) {
+                count += buffer->size();
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @brief 以 Chrome trace 的 JSON 格式导出当前会话
+     *
+     * 时间戳为相对会话开始的微秒数。
+     */
+    void writeChromeTrace(std::ostream& out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t generation = generation_.load(std::memory_order_acquire);
+        double nsPerTick = calibrate();
+        long pid = static_cast<long>(::getpid());
+        uint64_t dropped = 0;
+
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        out << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << pid
+            << ",\"args\":{\"name\":\"thread_framework\"}}";
+        for (const auto& buffer : buffers_) {
+            if (buffer->getGeneration() != generation) {
+                continue;
+            }
+            dropped += buffer->getDropped();
+            out << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid << ",\"tid\":" << buffer->tid
+                << ",\"args\":{\"name\":\"";
+            writeEscaped(out, buffer->threadName);
+            out << "\"}}";
+
+            size_t size = buffer->size();
+            for (size_t i = 0; i < size; ++i) {
+                writeEvent(out, buffer->at(i), pid, buffer->tid, nsPerTick);
+            }
+        }
+        out << "\n],\"otherData\":{\"droppedEvents\":\"" << dropped << "\"}}\n";
+    }
+
+    /**
+     * @brief 导出到文件
+     *
+     * @param path 文件路径
+     * @return true 写入成功
+     * @return false 无法打开或写入文件
+     */
+    bool writeChromeTrace(const std::string& path) const {
+        std::ofstream file(path);
+        if (!file) {
+            return false;
+        }
+        writeChromeTrace(file);
+        return static_cast<bool>(file);
+    }
+
+    /**
+     * @brief 获取当前线程正在执行的工作者ID，不在工作者中时为0
+     */
+    static uint64_t currentWorker() {
+        return currentWorkerSlot();
+    }
+
+    /**
+     * @brief 在作用域内把当前线程标记为正在执行某个工作者
+     */
+    class WorkerScope {
+    public:
+        explicit WorkerScope(uint64_t worker) : previous_(currentWorkerSlot()) {
+            currentWorkerSlot() = worker;
+        }
+
+        ~WorkerScope() {
+            currentWorkerSlot() = previous_;
+        }
+
+        WorkerScope(const WorkerScope&) = delete;
+        WorkerScope& operator=(const WorkerScope&) = delete;
+
+    private:
+        uint64_t previous_;
+    };
+
+    /**
+     * @brief 记录 BEGIN/END 配对的作用域，开始时未在记录则什么也不做
+     */
+    class Span {
+    public:
+        Span(TraceKind kind, uint64_t worker) : kind_(kind), active_(isActive()) {
+            if (active_) {
+                worker_ = worker == CURRENT_WORKER ? currentWorker() : worker;
+                instance().record(kind_, TracePhase::BEGIN, worker_);
+            }
+        }
+
+        ~Span() {
+            if (active_) {
+                instance().record(kind_, TracePhase::END, worker_);
+            }
+        }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        TraceKind kind_;
+        bool active_;
+        uint64_t worker_ = 0;
+    };
+
+private:
+    /**
+     * @brief 线程退出时交还缓冲区，已记录的事件保留到会话结束
+     */
+    struct BufferHolder {
+        detail::TraceBuffer* buffer = nullptr;
+
+        ~BufferHolder() {
+            if (buffer) {
+                instance().orphan(buffer);
+            }
+            threadExited() = true;
+        }
+    };
+
+    /**
+     * @brief 当前线程的 BufferHolder 是否已析构，之后的事件被丢弃
+     */
+    static bool& threadExited() {
+        thread_local bool exited = false;
+        return exited;
+    }
+
+    static inline std::atomic<bool> active_{false};
+
+    std::atomic<uint64_t> generation_{0};
+    std::atomic<size_t> capacity_{DEFAULT_EVENTS_PER_THREAD};
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<detail::TraceBuffer>> buffers_; ///< 由 mutex_ 保护
+    std::unordered_map<uint64_t, std::string> workerNames_;     ///< 由 mutex_ 保护
+    uint64_t startTicks_ = 0;
+    uint64_t stopTicks_ = 0;
+    std::chrono::steady_clock::time_point startTime_;
+    std::chrono::steady_clock::time_point stopTime_;
+
+    Tracer() = default;
+
+    static uint64_t& currentWorkerSlot() {
+        thread_local uint64_t worker = 0;
+        return worker;
+    }
+
+    static uint64_t readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /**
+     * @brief 获取当前线程的缓冲区，第一次调用或会话切换时分配或重置
+     */
+    detail::TraceBuffer* localBuffer() {
+        if (threadExited()) {
+            return nullptr;
+        }
+        thread_local BufferHolder holder;
+        uint64_t generation = generation_.load(std::memory_order_acquire);
+        if (!holder.buffer) {
+            holder.buffer = adopt();
+        }
+        if (holder.buffer->getGeneration() != generation) {
+            holder.buffer->reset(capacity_.load(std::memory_order_relaxed), generation);
+        }
+        return holder.buffer;
+    }
+
+    /**
+     * @brief 为当前线程分配缓冲区，优先复用拥有者已退出、且不属于当前会话的缓冲区
+     */
+    detail::TraceBuffer* adopt() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t generation = generation_.load(std::memory_order_acquire);
+        detail::TraceBuffer* buffer = nullptr;
+        for (const auto& candidate : buffers_) {
+            if (candidate->orphaned && candidate->getGeneration() != generation) {
+                buffer = candidate.get();
+                break;
+            }
+        }
+        if (!buffer) {
+            buffers_.push_back(std::make_unique<detail::TraceBuffer>());
+            buffer = buffers_.back().get();
+        }
+        buffer->orphaned = false;
+        buffer->tid = static_cast<long>(::syscall(SYS_gettid));
+        std::memset(buffer->threadName, 0, sizeof(buffer->threadName));
+        pthread_getname_np(pthread_self(), buffer->threadName, sizeof(buffer->threadName));
+        return buffer;
+    }
+
+    void orphan(detail::TraceBuffer* buffer) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffer->orphaned = true;
+    }
+
+    /**
+     * @brief 计算每个时间戳单位对应的纳秒数，调用方持有 mutex_
+     */
+    double calibrate() const {
+#if defined(__x86_64__) || defined(__i386__)
+        uint64_t endTicks = stopTicks_ ? stopTicks_ : readTicks();
+        auto endTime = stopTicks_ ? stopTime_ : std::chrono::steady_clock::now();
+        double elapsedNs = std::chrono::duration<double, std::nano>(endTime - startTime_).count();
+        if (endTicks <= startTicks_ || elapsedNs <= 0) {
+            return 1.0;
+        }
+        return elapsedNs / static_cast<double>(endTicks - startTicks_);
+#else
+        return 1.0;
+#endif
+    }
+
+    /**
+     * @brief 输出一个事件，调用方持有 mutex_
+     */
+    void writeEvent(std::ostream& out, const TraceEvent& event, long pid, long tid, double nsPerTick) const {
+        static const char* const phases[] = {"B", "E", "i", "b", "e"};
+        double ts = event.ticks >= startTicks_
+                        ? static_cast<double>(event.ticks - startTicks_) * nsPerTick / 1000.0
+                        : 0.0;
+
+        out << ",\n{\"ph\":\"" << phases[static_cast<size_t>(event.phase)] << "\",\"cat\":\"thread_framework\""
+            << ",\"name\":\"";
+        if (event.kind == TraceKind::RUN && event.worker != 0) {
+            writeWorkerLabel(out, event.worker);
+        } else {
+            out << getKindName(event.kind);
+        }
+        out << "\",\"pid\":" << pid << ",\"tid\":" << tid << ",\"ts\":" << ts;
+        if (event.phase == TracePhase::INSTANT) {
+            out << ",\"s\":\"t\"";
+        }
+        if (event.phase == TracePhase::ASYNC_BEGIN || event.phase == TracePhase::ASYNC_END) {
+            out << ",\"id\":\"" << event.worker << "\"";
+        }
+        out << ",\"args\":{";
+        bool comma = false;
+        if (event.worker != 0) {
+            out << "\"worker\":\"" << event.worker << "\",\"worker_name\":\"";
+            writeWorkerLabel(out, event.worker);
+            out << "\"";
+            comma = true;
+        }
+        if (event.kind == TraceKind::STEAL) {
+            out << (comma ? "," : "") << "\"victim\":" << event.arg;
+        }
+        out << "}}";
+    }
+
+    void writeWorkerLabel(std::ostream& out, uint64_t worker) const {
+        auto it = workerNames_.find(worker);
+        if (it != workerNames_.end()) {
+            writeEscaped(out, it->second.c_str());
+        } else {
+            out << "worker " << worker;
+        }
+    }
+
+    static const char* getKindName(TraceKind kind) {
+        switch (kind) {
+            case TraceKind::INITIALIZE: return "onInitialize";
+            case TraceKind::START: return "onStart";
+            case TraceKind::RUN: return "run";
+            case TraceKind::CALLBACK: return "callback";
+            case TraceKind::PAUSE: return "paused";
+            case TraceKind::QUEUED: return "queued";
+            case TraceKind::TIMER_FIRE: return "timer";
+            case TraceKind::STEAL: return "steal";
+        }
+        return "unknown";
+    }
+
+    static void writeEscaped(std::ostream& out, const char* text) {
+        for (const char* c = text; *c; ++c) {
+            unsigned char ch = static_cast<unsigned char>(*c);
+            if (ch == '"' || ch == '\\') {
+                out << '\\' << *c;
+            } else if (ch < 0x20) {
+                static const char hex[] = "0123456789abcdef";
+                out << "\\u00" << hex[ch >> 4] << hex[ch & 0xF];
+            } else {
+                out << *c;
+            }
+        }
+    }
+};
+
+} // namespace thread_framework
+
+#if THREAD_FRAMEWORK_TRACING
+
+/**
+ * @brief 记录一个事件，未开启跟踪时只有一次 relaxed 读取
+ */
+#define TF_TRACE(kind, phase, worker, arg)                                                          \
+    do {                                                                                            \
+        if (::thread_framework::Tracer::isActive()) {                                               \
+            ::thread_framework::Tracer::instance().record(kind, phase, worker, arg);                \
+        }                                                                                           \
+    } while (0)
+
+#define TF_TRACE_CONCAT_INNER(a, b) a##b
+#define TF_TRACE_CONCAT(a, b) TF_TRACE_CONCAT_INNER(a, b)
+
+/**
+ * @brief 在当前作用域记录 BEGIN/END 配对
+ */
+#define TF_TRACE_SPAN(kind, worker) \
+    ::thread_framework::Tracer::Span TF_TRACE_CONCAT(tfTraceSpan, __LINE__)(kind, worker)
+
+/**
+ * @brief 在当前作用域把线程标记为执行某个工作者，回调等事件归属到该工作者
+ */
+#define TF_TRACE_WORKER_SCOPE(worker) \
+    ::thread_framework::Tracer::WorkerScope TF_TRACE_CONCAT(tfTraceWorker, __LINE__)(worker)
+
+#else
+
+#define TF_TRACE(kind, phase, worker, arg) \
+    do {                                   \
+    } while (0)
+#define TF_TRACE_SPAN(kind, worker) \
+    do {                            \
+    } while (0)
+#define TF_TRACE_WORKER_SCOPE(worker) \
+    do {                              \
+    } while (0)
+
+#endif
+
+#endif // TRACING_H
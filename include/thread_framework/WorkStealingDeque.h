@@ -0,0 +1,190 @@
+#ifndef WORK_STEALING_DEQUE_H
+#define WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <type_traits>
+
+/**
+ * @file WorkStealingDeque.h
+ * @brief Chase-Lev 工作窃取双端队列
+ *
+ * 拥有者线程在底部无锁地压入和弹出，其它线程在顶部窃取。
+ * 实现参考 Lê, Pop, Cohen, Zappa Nardelli 的 C11 内存模型版本，
+ * 其中的独立栅栏改为 seq_cst 原子操作，以便 ThreadSanitizer 能够正确建模。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief Chase-Lev 工作窃取双端队列
+ *
+ * push()/pop() 只能由拥有者线程调用，steal() 可以由任意线程并发调用。
+ * 元素类型必须可平凡复制（通常是指针）。扩容后的旧缓冲区保留到析构时才释放，
+ * 保证并发窃取者不会读到已释放的内存。
+ *
+ * @tparam T 元素类型
+ */
+template <typename T>
+class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque requires trivially copyable elements");
+
+private:
+    /**
+     * @brief 环形缓冲区
+     */
+    struct Buffer {
+        int64_t capacity;
+        int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+
+        explicit Buffer(int64_t cap)
+            : capacity(cap), mask(cap - 1), slots(new std::atomic<T>[static_cast<size_t>(cap)]) {}
+
+        void put(int64_t index, T value) {
+            slots[static_cast<size_t>(index & mask)].store(value, std::memory_order_relaxed);
+        }
+
+        T get(int64_t index) const {
+            return slots[static_cast<size_t>(index & mask)].load(std::memory_order_relaxed);
+        }
+    };
+
+    alignas(64) std::atomic<int64_t> top_{0};     ///< 窃取端，由窃取者修改
+    alignas(64) std::atomic<int64_t> bottom_{0};  ///< 拥有者端
+    std::atomic<Buffer*> buffer_;
+    std::vector<std::unique_ptr<Buffer>> buffers_; ///< 当前及已退役的缓冲区，只由拥有者修改
+
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param capacity 初始容量，会向上取整为2的幂
+     */
+    explicit WorkStealingDeque(int64_t capacity = 256) {
+        int64_t cap = 1;
+        while (cap < capacity) {
+            cap <<= 1;
+        }
+        buffers_.push_back(std::make_unique<Buffer>(cap));
+        buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    /**
+     * @brief 在底部压入元素（仅拥有者）
+     */
+    void push(T value) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Buffer* buf = buffer_.load(std::memory_order_relaxed);
+
+        if (b - t > buf->capacity - 1) {
+            buf = grow(buf, t, b);
+        }
+
+        buf->put(b, value);
+        // seq_cst 存储同时作为发布操作，并参与线程池休眠协议的全序
+        bottom_.store(b + 1, std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief 从底部弹出元素（仅拥有者）
+     *
+     * @param out 弹出的元素
+     * @return true 弹出成功
+     * @return false 队列为空或最后一个元素被窃取
+     */
+    bool pop(T& out) {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Buffer* buf = buffer_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_seq_cst);
+
+        if (t > b) {
+            // 队列为空
+            bottom_.store(b + 1, std::memory_order_release);
+            return false;
+        }
+
+        out = buf->get(b);
+        if (t == b) {
+            // 最后一个元素，与窃取者竞争
+            bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_release);
+            return won;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 从顶部窃取元素（任意线程）
+     *
+     * @param out 窃取到的元素
+     * @return true 窃取成功
+     * @return false 队列为空或与其它线程竞争失败
+     */
+    bool steal(T& out) {
+        int64_t t = top_.load(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_seq_cst);
+
+        if (t >= b) {
+            return false;
+        }
+
+        Buffer* buf = buffer_.load(std::memory_order_acquire);
+        T value = buf->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return false;
+        }
+
+        out = value;
+        return true;
+    }
+
+    /**
+     * @brief 检查队列是否为空（近似值）
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief 获取队列长度（近似值）
+     */
+    size_t size() const {
+        int64_t b = bottom_.load(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_seq_cst);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+private:
+    /**
+     * @brief 扩容为两倍大小，旧缓冲区保留给仍在读取的窃取者
+     */
+    Buffer* grow(Buffer* old, int64_t t, int64_t b) {
+        auto bigger = std::make_unique<Buffer>(old->capacity * 2);
+        for (int64_t i = t; i < b; ++i) {
+            bigger->put(i, old->get(i));
+        }
+
+        Buffer* raw = bigger.get();
+        buffers_.push_back(std::move(bigger));
+        buffer_.store(raw, std::memory_order_release);
+        return raw;
+    }
+};
+
+} // namespace thread_framework
+
+#endif // WORK_STEALING_DEQUE_H
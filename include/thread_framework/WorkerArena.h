@@ -0,0 +1,229 @@
+#ifndef WORKER_ARENA_H
+#define WORKER_ARENA_H
+
+#include "IThreadWorker.h"
+#include "SlabPool.h"
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+
+/**
+ * @file WorkerArena.h
+ * @brief 工作者对象的内存池和线程名称
+ *
+ * 高频创建短任务时，工作者对象从按大小分级的内存池中分配，回收后的内存块直接复用，
+ * 不经过通用分配器；线程名称可以驻留在进程级的名称表中共享，或者完全省略。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief 工作者对象的删除器
+ *
+ * 内存池中的工作者先析构再把内存块还给所在的池，其它工作者用 delete 释放。
+ * 可以从 std::default_delete 隐式转换，因此 std::unique_ptr<IThreadWorker> 能直接转换为 WorkerPtr。
+ */
+struct WorkerDeleter {
+    SlabPool* pool = nullptr;   ///< 所在的池，为空表示用 delete 释放
+    void* block = nullptr;      ///< 内存块起始地址（派生对象的地址，可能与基类子对象不同）
+
+    WorkerDeleter() = default;
+    WorkerDeleter(SlabPool* owner, void* memory) : pool(owner), block(memory) {}
+    WorkerDeleter(std::default_delete<IThreadWorker>) {}
+
+    void operator()(IThreadWorker* worker) const {
+        if (!pool) {
+            delete worker;
+            return;
+        }
+        worker->~IThreadWorker();
+        pool->deallocate(block);
+    }
+};
+
+/**
+ * @brief 线程管理器持有工作者使用的智能指针
+ */
+using WorkerPtr = std::unique_ptr<IThreadWorker, WorkerDeleter>;
+
+/**
+ * @brief 工作者对象的分级内存池
+ *
+ * 大小不超过 MAX_BLOCK_SIZE 且对齐要求不超过 SlabPool::BLOCK_ALIGN 的工作者从对应等级的池中分配，
+ * 其它工作者退回到 new。内存池必须比从中分配的所有工作者活得更久。
+ */
+class WorkerArena {
+public:
+    static constexpr size_t MAX_BLOCK_SIZE = 1024; ///< 最大的池化对象大小
+
+    WorkerArena() : pools_{{SlabPool(128), SlabPool(256), SlabPool(512), SlabPool(MAX_BLOCK_SIZE)}} {}
+
+    WorkerArena(const WorkerArena&) = delete;
+    WorkerArena& operator=(const WorkerArena&) = delete;
+
+    /**
+     * @brief 在池中构造工作者
+     *
+     * @tparam W 工作者类型，必须派生自 IThreadWorker
+     * @param args 构造参数
+     * @return WorkerPtr 工作者，释放时内存块回到池中
+     * @throws 工作者构造函数抛出的异常，此时内存块已归还
+     */
+    template <typename W, typename... Args>
+    WorkerPtr create(Args&&... args) {
+        static_assert(std::is_base_of<IThreadWorker, W>::value, "W must derive from IThreadWorker");
+
+        SlabPool* pool = poolFor(sizeof(W), alignof(W));
+        if (!pool) {
+            return WorkerPtr(new W(std::forward<Args>(args)...));
+        }
+
+        void* block = pool->allocate();
+        W* worker = nullptr;
+        try {
+            worker = new (block) W(std::forward<Args>(args)...);
+        } catch (...) {
+            pool->deallocate(block);
+            throw;
+        }
+        return WorkerPtr(worker, WorkerDeleter(pool, block));
+    }
+
+    /**
+     * @brief 获取所有等级正在使用的块数
+     */
+    size_t getBlocksInUse() const {
+        size_t count = 0;
+        for (const SlabPool& pool : pools_) {
+            count += pool.getBlocksInUse();
+        }
+        return count;
+    }
+
+    /**
+     * @brief 获取所有等级已申请的块数
+     */
+    size_t getBlocksReserved() const {
+        size_t count = 0;
+        for (const SlabPool& pool : pools_) {
+            count += pool.getBlocksReserved();
+        }
+        return count;
+    }
+
+private:
+    SlabPool* poolFor(size_t size, size_t align) {
+        if (align > SlabPool::BLOCK_ALIGN) {
+            return nullptr;
+        }
+        for (SlabPool& pool : pools_) {
+            if (size <= pool.getBlockSize()) {
+                return &pool;
+            }
+        }
+        return nullptr;
+    }
+
+    std::array<SlabPool, 4> pools_;
+};
+
+/**
+ * @brief 进程级的名称驻留表
+ *
+ * 相同的名称只保存一份，返回的指针在进程生命周期内有效。只适合数量有限的名称。
+ */
+class NameTable {
+public:
+    /**
+     * @brief 驻留名称
+     *
+     * @param name 名称
+     * @return const std::string* 名称表中的稳定地址
+     */
+    static const std::string* intern(const std::string& name) {
+        // 有意不释放，避免退出时与仍在使用名称的线程竞争
+        static Table* table = new Table();
+        std::lock_guard<std::mutex> lock(table->mutex);
+        return &*table->names.insert(name).first;
+    }
+
+private:
+    struct Table {
+        std::mutex mutex;
+        std::unordered_set<std::string> names;
+    };
+};
+
+/**
+ * @brief 工作者名称
+ *
+ * 可以是普通字符串、驻留在 NameTable 中的共享名称，或者匿名（没有名称，也不设置系统线程名）。
+ * 驻留名称只复制一个指针，适合以相同名称高频创建的任务；应保存 WorkerName 对象重复使用，
+ * 而不是每次调用 interned()。
+ */
+class WorkerName {
+public:
+    /**
+     * @brief 匿名
+     */
+    WorkerName() = default;
+    WorkerName(std::string name) : owned_(std::move(name)) {}
+    WorkerName(const char* name) : owned_(name) {}
+
+    /**
+     * @brief 创建匿名名称
+     */
+    static WorkerName anonymous() {
+        return WorkerName();
+    }
+
+    /**
+     * @brief 创建驻留名称
+     *
+     * @param name 名称，相同的名称共享同一份存储
+     */
+    static WorkerName interned(const std::string& name) {
+        WorkerName result;
+        result.interned_ = NameTable::intern(name);
+        return result;
+    }
+
+    /**
+     * @brief 是否匿名
+     */
+    bool isAnonymous() const {
+        return !interned_ && owned_.empty();
+    }
+
+    /**
+     * @brief 是否为驻留名称
+     */
+    bool isInterned() const {
+        return interned_ != nullptr;
+    }
+
+    /**
+     * @brief 获取名称，匿名时为空字符串
+     */
+    const std::string& str() const {
+        return interned_ ? *interned_ : owned_;
+    }
+
+private:
+    std::string owned_;
+    const std::string* interned_ = nullptr;
+};
+
+} // namespace thread_framework
+
+#endif // WORKER_ARENA_H
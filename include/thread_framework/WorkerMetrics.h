@@ -0,0 +1,417 @@
+#ifndef WORKER_METRICS_H
+#define WORKER_METRICS_H
+
+#include "SlabPool.h"
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @file WorkerMetrics.h
+ * @brief 工作者的运行指标
+ *
+ * 每个工作者自带一组原子计数器和一个回调延迟直方图，记录都是无锁的 relaxed 原子操作。
+ * 读取快照时不暂停工作者，各计数器之间不保证严格一致。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief 延迟直方图快照
+ */
+struct HistogramSnapshot {
+    uint64_t count = 0;                  ///< 记录次数
+    uint64_t totalNs = 0;                ///< 总和（纳秒）
+    uint64_t maxNs = 0;                  ///< 最大值（纳秒）
+    std::vector<uint64_t> buckets;       ///< 各桶计数，为空表示没有记录
+
+    /**
+     * @brief 合并另一个快照
+     */
+    void merge(const HistogramSnapshot& other);
+
+    /**
+     * @brief 获取百分位数
+     *
+     * @param percentile 百分位，0到100
+     * @return uint64_t 对应的值（纳秒），相对误差不超过 1/8
+     */
+    uint64_t getPercentile(double percentile) const;
+
+    /**
+     * @brief 获取平均值（纳秒）
+     */
+    uint64_t getMeanNs() const {
+        return count == 0 ? 0 : totalNs / count;
+    }
+};
+
+/**
+ * @brief 无锁对数线性延迟直方图
+ *
+ * 与 HDR 直方图相同的分桶方式：每个2的幂区间分成8个等宽的桶，
+ * 整个64位范围共496个桶，记录只是一次 relaxed 的 fetch_add。
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t kSubBucketBits = 3;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    static constexpr size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    LatencyHistogram() {
+        for (auto& bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * @brief 从进程级的内存池分配，短任务反复创建工作者时不进入通用分配器
+     */
+    static void* operator new(size_t size) {
+        if (size != sizeof(LatencyHistogram)) {
+            return ::operator new(size);
+        }
+        return blockPool().allocate();
+    }
+
+    static void operator delete(void* block, size_t size) {
+        if (size != sizeof(LatencyHistogram)) {
+            ::operator delete(block);
+            return;
+        }
+        blockPool().deallocate(block);
+    }
+
+    /**
+     * @brief 记录一个值
+     *
+     * @param valueNs 值（纳秒）
+     */
+    void record(uint64_t valueNs) {
+        buckets_[bucketIndex(valueNs)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        total_.fetch_add(valueNs, std::memory_order_relaxed);
+
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (valueNs > max && !max_.compare_exchange_weak(max, valueNs, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief 获取快照
+     */
+    HistogramSnapshot snapshot() const {
+        HistogramSnapshot result;
+        result.count = count_.load(std::memory_order_relaxed);
+        result.totalNs = total_.load(std::memory_order_relaxed);
+        result.maxNs = max_.load(std::memory_order_relaxed);
+        result.buckets.resize(kBucketCount);
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            result.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    uint64_t getCount() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getTotalNs() const {
+        return total_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getMaxNs() const {
+        return max_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 计算值所在的桶
+     */
+    static size_t bucketIndex(uint64_t value) {
+        if (value < kSubBuckets) {
+            return static_cast<size_t>(value);
+        }
+        size_t msb = 63 - static_cast<size_t>(__builtin_clzll(value));
+        size_t shift = msb - kSubBucketBits;
+        size_t sub = static_cast<size_t>(value >> shift) & (kSubBuckets - 1);
+        return (shift + 1) * kSubBuckets + sub;
+    }
+
+    /**
+     * @brief 获取桶内的最大值
+     */
+    static uint64_t bucketUpperBound(size_t index) {
+        if (index < kSubBuckets) {
+            return index;
+        }
+        size_t shift = index / kSubBuckets - 1;
+        uint64_t lower = static_cast<uint64_t>(kSubBuckets + index % kSubBuckets) << shift;
+        return lower + ((uint64_t(1) << shift) - 1);
+    }
+
+    /**
+     * @brief 清零，不能与 record() 并发调用
+     */
+    void reset() {
+        for (auto& bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        count_.store(0, std::memory_order_relaxed);
+        total_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static SlabPool& blockPool() {
+        // 有意不释放，工作者可能在静态对象析构之后才被销毁
+        static SlabPool* pool = new SlabPool(sizeof(LatencyHistogram), 16);
+        return *pool;
+    }
+
+    std::atomic<uint64_t> buckets_[kBucketCount];
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> total_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+inline void HistogramSnapshot::merge(const HistogramSnapshot& other) {
+    count += other.count;
+    totalNs += other.totalNs;
+    if (other.maxNs > maxNs) {
+        maxNs = other.maxNs;
+    }
+    if (other.buckets.empty()) {
+        return;
+    }
+    if (buckets.empty()) {
+        buckets.assign(other.buckets.size(), 0);
+    }
+    for (size_t i = 0; i < buckets.size() && i < other.buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+    }
+}
+
+inline uint64_t HistogramSnapshot::getPercentile(double percentile) const {
+    uint64_t recorded = 0;
+    for (uint64_t bucket : buckets) {
+        recorded += bucket;
+    }
+    if (recorded == 0) {
+        return 0;
+    }
+
+    double target = percentile / 100.0 * static_cast<double>(recorded);
+    uint64_t rank = target <= 1.0 ? 1 : static_cast<uint64_t>(target + 0.5);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            uint64_t value = LatencyHistogram::bucketUpperBound(i);
+            return value < maxNs ? value : maxNs;
+        }
+    }
+    return maxNs;
+}
+
+/**
+ * @brief 工作者指标快照
+ */
+struct WorkerMetricsSnapshot {
+    uint64_t runTimeNs = 0;              ///< 累计运行时间，包含正在进行的运行
+    uint64_t queueWaitNs = 0;            ///< 从登记到开始执行的等待时间
+    uint64_t pauseTimeNs = 0;            ///< 累计暂停时间
+    uint64_t errorCount = 0;             ///< 错误次数
+    uint64_t callbackCount = 0;          ///< 回调次数
+    uint64_t callbackTotalNs = 0;        ///< 回调总耗时
+    uint64_t callbackMaxNs = 0;          ///< 回调最大耗时
+    uint64_t callbackP50Ns = 0;          ///< 回调耗时中位数
+    uint64_t callbackP90Ns = 0;          ///< 回调耗时90百分位
+    uint64_t callbackP99Ns = 0;          ///< 回调耗时99百分位
+
+    /**
+     * @brief 累加另一个快照的计数，百分位不参与累加
+     */
+    void accumulate(const WorkerMetricsSnapshot& other) {
+        runTimeNs += other.runTimeNs;
+        queueWaitNs += other.queueWaitNs;
+        pauseTimeNs += other.pauseTimeNs;
+        errorCount += other.errorCount;
+        callbackCount += other.callbackCount;
+        callbackTotalNs += other.callbackTotalNs;
+        if (other.callbackMaxNs > callbackMaxNs) {
+            callbackMaxNs = other.callbackMaxNs;
+        }
+    }
+};
+
+/**
+ * @brief 工作者运行指标
+ *
+ * 由工作者基类和线程管理器记录。直方图在第一次记录回调延迟时才分配，
+ * 从不执行回调的工作者不占用直方图内存。
+ */
+class WorkerMetrics {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    WorkerMetrics() = default;
+
+    ~WorkerMetrics() {
+        delete histogram_.load(std::memory_order_relaxed);
+    }
+
+    WorkerMetrics(const WorkerMetrics&) = delete;
+    WorkerMetrics& operator=(const WorkerMetrics&) = delete;
+
+    /**
+     * @brief 开始一段运行
+     */
+    void beginRun() {
+        runStartNs_.store(nowNs(), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 结束一段运行并累计运行时间
+     */
+    void endRun() {
+        uint64_t start = runStartNs_.exchange(0, std::memory_order_relaxed);
+        if (start != 0) {
+            runTimeNs_.fetch_add(nowNs() - start, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief 记录从登记到开始执行的等待时间
+     */
+    void recordQueueWait(Clock::duration wait) {
+        queueWaitNs_.fetch_add(toNs(wait), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 记录暂停时间
+     */
+    void recordPause(Clock::duration pause) {
+        pauseTimeNs_.fetch_add(toNs(pause), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 记录一次错误
+     */
+    void recordError() {
+        errorCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 记录一次回调的耗时
+     */
+    void recordCallbackLatency(Clock::duration latency) {
+        LatencyHistogram* histogram = histogram_.load(std::memory_order_acquire);
+        if (!histogram) {
+            LatencyHistogram* created = new LatencyHistogram();
+            if (histogram_.compare_exchange_strong(histogram, created, std::memory_order_acq_rel)) {
+                histogram = created;
+            } else {
+                delete created; // 其它线程已经创建
+            }
+        }
+        histogram->record(toNs(latency));
+    }
+
+    /**
+     * @brief 只读取计数，不计算百分位
+     *
+     * 不分配内存，适合高频采集；百分位字段为0。
+     */
+    WorkerMetricsSnapshot readCounters() const {
+        WorkerMetricsSnapshot result;
+        result.runTimeNs = runTimeNs_.load(std::memory_order_relaxed);
+        uint64_t start = runStartNs_.load(std::memory_order_relaxed);
+        if (start != 0) {
+            uint64_t now = nowNs();
+            result.runTimeNs += now > start ? now - start : 0;
+        }
+        result.queueWaitNs = queueWaitNs_.load(std::memory_order_relaxed);
+        result.pauseTimeNs = pauseTimeNs_.load(std::memory_order_relaxed);
+        result.errorCount = errorCount_.load(std::memory_order_relaxed);
+
+        LatencyHistogram* histogram = histogram_.load(std::memory_order_acquire);
+        if (histogram) {
+            result.callbackCount = histogram->getCount();
+            result.callbackTotalNs = histogram->getTotalNs();
+            result.callbackMaxNs = histogram->getMaxNs();
+        }
+        return result;
+    }
+
+    /**
+     * @brief 获取指标快照
+     *
+     * @param latency 不为空时输出完整的回调延迟直方图
+     */
+    WorkerMetricsSnapshot snapshot(HistogramSnapshot* latency = nullptr) const {
+        WorkerMetricsSnapshot result = readCounters();
+
+        LatencyHistogram* histogram = histogram_.load(std::memory_order_acquire);
+        if (histogram) {
+            HistogramSnapshot callbacks = histogram->snapshot();
+            result.callbackCount = callbacks.count;
+            result.callbackTotalNs = callbacks.totalNs;
+            result.callbackMaxNs = callbacks.maxNs;
+            result.callbackP50Ns = callbacks.getPercentile(50.0);
+            result.callbackP90Ns = callbacks.getPercentile(90.0);
+            result.callbackP99Ns = callbacks.getPercentile(99.0);
+            if (latency) {
+                *latency = std::move(callbacks);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief 清零所有指标，保留已分配的直方图
+     *
+     * 不能与记录并发调用，工作者被回收复用时调用。
+     */
+    void reset() {
+        runTimeNs_.store(0, std::memory_order_relaxed);
+        runStartNs_.store(0, std::memory_order_relaxed);
+        queueWaitNs_.store(0, std::memory_order_relaxed);
+        pauseTimeNs_.store(0, std::memory_order_relaxed);
+        errorCount_.store(0, std::memory_order_relaxed);
+        LatencyHistogram* histogram = histogram_.load(std::memory_order_acquire);
+        if (histogram) {
+            histogram->reset();
+        }
+    }
+
+private:
+    std::atomic<uint64_t> runTimeNs_{0};
+    std::atomic<uint64_t> runStartNs_{0};      ///< 正在运行时为开始时间，否则为0
+    std::atomic<uint64_t> queueWaitNs_{0};
+    std::atomic<uint64_t> pauseTimeNs_{0};
+    std::atomic<uint64_t> errorCount_{0};
+    std::atomic<LatencyHistogram*> histogram_{nullptr};
+
+    static uint64_t toNs(Clock::duration duration) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        return ns > 0 ? static_cast<uint64_t>(ns) : 0;
+    }
+
+    static uint64_t nowNs() {
+        // 加1保证非0，0表示没有正在进行的运行
+        return toNs(Clock::now().time_since_epoch()) + 1;
+    }
+};
+
+} // namespace thread_framework
+
+#endif // WORKER_METRICS_H
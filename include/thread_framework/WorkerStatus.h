@@ -0,0 +1,163 @@
+#ifndef WORKER_STATUS_H
+#define WORKER_STATUS_H
+
+#include "IThreadWorker.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+/**
+ * @file WorkerStatus.h
+ * @brief 固定布局的工作者状态记录
+ *
+ * ThreadStatusRecord 是可以按字节复制的定长结构，ThreadManager::captureStatus() 无锁地把
+ * 所有工作者的状态写入调用方预先分配的数组，不构造字符串；工作者类型以 WorkerTypeTable 中的ID表示。
+ * 记录布局固定，也用于共享内存导出（StatusExporter.h），修改布局时需要增加 STATUS_LAYOUT_VERSION。
+ *
+ * @author Thread Framework Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+namespace thread_framework {
+
+/**
+ * @brief 记录布局的版本号
+ */
+constexpr uint32_t STATUS_LAYOUT_VERSION = 1;
+
+/**
+ * @brief 状态记录中的标志位
+ */
+enum ThreadStatusFlags : uint8_t {
+    STATUS_POOLED = 1 << 0,       ///< 在线程池中执行
+    STATUS_TIMER_DRIVEN = 1 << 1, ///< 由共享定时服务驱动
+    STATUS_ASYNC = 1 << 2,        ///< 在线程池上运行的异步工作者
+    STATUS_ANONYMOUS = 1 << 3,    ///< 没有名称
+    STATUS_STOP_REQUESTED = 1 << 4 ///< 已请求停止
+};
+
+/**
+ * @brief 单个工作者的状态记录
+ *
+ * 计数与 WorkerMetrics 相同，以 relaxed 方式读取，同一记录内的字段也不保证是同一时刻的值。
+ */
+struct ThreadStatusRecord {
+    static constexpr size_t NAME_CAPACITY = 72; ///< 名称缓冲区大小，包括结尾的 '\0'
+
+    uint64_t threadId;           ///< 线程ID
+    uint64_t runTimeNs;          ///< 累计运行时间
+    uint64_t queueWaitNs;        ///< 从登记到开始执行的等待时间
+    uint64_t pauseTimeNs;        ///< 累计暂停时间
+    uint64_t errorCount;         ///< 错误次数
+    uint64_t callbackCount;      ///< 回调次数
+    uint32_t typeId;             ///< 工作者类型，见 WorkerTypeTable::getName()
+    uint8_t state;               ///< ThreadState 的值
+    uint8_t flags;               ///< ThreadStatusFlags 的组合
+    uint16_t nameLength;         ///< 名称的原始长度，不小于 NAME_CAPACITY 时 name 被截断
+    char name[NAME_CAPACITY];    ///< 以 '\0' 结尾的名称（可能被截断）
+
+    ThreadState getState() const {
+        return static_cast<ThreadState>(state);
+    }
+
+    bool hasFlag(ThreadStatusFlags flag) const {
+        return (flags & flag) != 0;
+    }
+};
+
+static_assert(std::is_trivially_copyable<ThreadStatusRecord>::value, "ThreadStatusRecord must be trivially copyable");
+static_assert(sizeof(ThreadStatusRecord) == 128, "ThreadStatusRecord layout changed; bump STATUS_LAYOUT_VERSION");
+
+/**
+ * @brief 获取状态名称
+ *
+ * @return const char* 静态字符串，例如 "RUNNING"
+ */
+inline const char* getStateName(ThreadState state) {
+    switch (state) {
+        case ThreadState::RUNNING: return "RUNNING";
+        case ThreadState::STOPPED: return "STOPPED";
+        case ThreadState::PAUSED: return "PAUSED";
+        case ThreadState::FINISHED: return "FINISHED";
+    }
+    return "UNKNOWN";
+}
+
+/**
+ * @brief 进程级的工作者类型表
+ *
+ * 每种 getType() 字符串分配一个从1开始的ID，ID和名称在进程生命周期内不变。
+ * 登记加锁，按ID读取名称不加锁。类型数量超过 MAX_TYPES 时返回0（未知类型）。
+ */
+class WorkerTypeTable {
+public:
+    static constexpr uint32_t MAX_TYPES = 256; ///< 最多登记的类型数
+
+    /**
+     * @brief 获取类型ID，首次出现时登记
+     *
+     * @param type 类型名称
+     * @return uint32_t 类型ID，表已满时为0
+     */
+    static uint32_t intern(const std::string& type) {
+        Table& table = instance();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        auto it = table.ids.find(type);
+        if (it != table.ids.end()) {
+            return it->second;
+        }
+        uint32_t count = table.count.load(std::memory_order_relaxed);
+        if (count >= MAX_TYPES) {
+            return 0;
+        }
+        table.names[count] = new std::string(type); // 有意不释放，名称在进程生命周期内有效
+        table.ids.emplace(type, count + 1);
+        table.count.store(count + 1, std::memory_order_release);
+        return count + 1;
+    }
+
+    /**
+     * @brief 获取类型名称
+     *
+     * @param id 类型ID
+     * @return const std::string& 类型名称，ID未知时为 "unknown"
+     */
+    static const std::string& getName(uint32_t id) {
+        static const std::string unknown = "unknown";
+        Table& table = instance();
+        if (id == 0 || id > table.count.load(std::memory_order_acquire)) {
+            return unknown;
+        }
+        return *table.names[id - 1];
+    }
+
+    /**
+     * @brief 获取已登记的类型数，ID范围为 [1, getCount()]
+     */
+    static uint32_t getCount() {
+        return instance().count.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Table {
+        std::mutex mutex;
+        std::unordered_map<std::string, uint32_t> ids;
+        const std::string* names[MAX_TYPES] = {};
+        std::atomic<uint32_t> count{0};
+    };
+
+    static Table& instance() {
+        // 有意不释放，避免退出时与仍在读取的线程竞争
+        static Table* table = new Table();
+        return *table;
+    }
+};
+
+} // namespace thread_framework
+
+#endif // WORKER_STATUS_H
@@ -0,0 +1,533 @@
+/**
+ * @file test_stress.cpp
+ * @brief ThreadManager 并发压力测试和扩展性测试
+ *
+ * 压力阶段：多个调用线程同时随机执行创建、批量创建、停止、暂停、恢复、查询和清理，
+ * 结束后检查所有工作者都已运行结束并被释放，登记表为空。独占线程和池化模式各运行一次。
+ * 数据并行：检查 bool 结果的归约（每块结果不按位打包）。
+ * 管道启动：检查源阶段的工作者先后结束时不会提前关闭下游队列。
+ * 定时器停止：检查在注册到共享定时服务之前收到的停止请求不会被推迟一个间隔。
+ * 临时内存阶段：检查池任务的临时内存在嵌套执行时不被覆盖，线程私有缓存每个池线程只创建一次。
+ * 扩展阶段：调用线程数从1增加到 --max-threads，报告每秒完成的创建+查询操作数。
+ *
+ * 用 make test-tsan / make test-asan 在 ThreadSanitizer 和 AddressSanitizer 下运行。
+ *
+ * 用法: test_stress [--quick] [--max-threads N]
+ * 返回值: 0 表示通过，1 表示检查失败
+ */
+
+#include "../include/thread_framework/ThreadManager.h"
+#include "../include/thread_framework/BaseWorkers.h"
+#include "../include/thread_framework/Pipeline.h"
+#include "../include/thread_framework/DataParallel.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace thread_framework;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+std::atomic<long> constructed{0};
+std::atomic<long> destroyed{0};
+std::atomic<long> runsStarted{0};
+std::atomic<long> runsFinished{0};
+std::atomic<int> blockingLive{0};
+int failures = 0;
+
+void check(bool condition, const std::string& message) {
+    if (!condition) {
+        std::cerr << "FAIL: " << message << std::endl;
+        failures++;
+    }
+}
+
+/**
+ * @brief 压力测试使用的工作者，记录构造、析构和运行次数
+ */
+class ProbeWorker : public IThreadWorker {
+public:
+    enum class Kind {
+        SHORT,      ///< 很快结束，可池化
+        BLOCKING    ///< 一直运行到停止请求，独占线程
+    };
+
+    explicit ProbeWorker(Kind kind) : kind_(kind) {
+        constructed.fetch_add(1);
+        if (kind_ == Kind::BLOCKING) {
+            blockingLive.fetch_add(1);
+        }
+    }
+
+    ~ProbeWorker() override {
+        if (kind_ == Kind::BLOCKING) {
+            blockingLive.fetch_sub(1);
+        }
+        destroyed.fetch_add(1);
+    }
+
+    void run() override {
+        runsStarted.fetch_add(1);
+        setState(ThreadState::RUNNING);
+        if (kind_ == Kind::BLOCKING) {
+            while (shouldContinue()) {
+                waitFor(std::chrono::milliseconds(1));
+            }
+        } else {
+            for (int i = 0; i < 8 && shouldContinue(); ++i) {
+                std::this_thread::yield();
+            }
+        }
+        setState(ThreadState::FINISHED);
+        runsFinished.fetch_add(1);
+    }
+
+    bool isPoolable() const override {
+        return kind_ == Kind::SHORT;
+    }
+
+    std::string getType() const override {
+        return "ProbeWorker";
+    }
+
+private:
+    Kind kind_;
+};
+
+/**
+ * @brief 调用线程共享的线程ID集合，随机取出的ID可能已经失效
+ */
+class IdPool {
+public:
+    void add(size_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ids_.push_back(id);
+    }
+
+    bool pick(std::mt19937& rng, size_t& id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ids_.empty()) {
+            return false;
+        }
+        size_t index = rng() % ids_.size();
+        id = ids_[index];
+        if (ids_.size() > 4096) {
+            ids_[index] = ids_.back();
+            ids_.pop_back();
+        }
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<size_t> ids_;
+};
+
+/**
+ * @brief 回收短工作者的工厂，复用与停止、暂停和清理并发进行
+ */
+class ProbeFactory : public IThreadWorkerFactory {
+public:
+    std::unique_ptr<IThreadWorker> createWorker() override {
+        return std::make_unique<ProbeWorker>(ProbeWorker::Kind::SHORT);
+    }
+
+    std::string getFactoryType() const override {
+        return "probe";
+    }
+
+    bool resetWorker(IThreadWorker& worker) override {
+        return worker.getState() == ThreadState::STOPPED; // 框架已清除控制状态
+    }
+};
+
+std::unique_ptr<IThreadWorker> makeWorker(std::mt19937& rng) {
+    if (rng() % 4 == 0 && blockingLive.load() < 32) {
+        return std::make_unique<ProbeWorker>(ProbeWorker::Kind::BLOCKING);
+    }
+    return std::make_unique<ProbeWorker>(ProbeWorker::Kind::SHORT);
+}
+
+/**
+ * @brief 一个调用线程的随机操作循环
+ */
+void hammer(ThreadManager& manager, IdPool& ids, unsigned seed, Clock::time_point until, std::atomic<long>& ops,
+            std::vector<size_t>& groups) {
+    std::mt19937 rng(seed);
+    long count = 0;
+    std::vector<ThreadStatusRecord> records;
+    while (Clock::now() < until) {
+        size_t id = 0;
+        switch (rng() % 12) {
+            case 0:
+            case 1:
+            case 2: {
+                size_t created = rng() % 2 ? manager.createThread("probe")
+                                           : manager.createThreadWithWorker(makeWorker(rng), "probe");
+                if (created != SIZE_MAX) {
+                    ids.add(created);
+                }
+                break;
+            }
+            case 3: {
+                std::vector<std::unique_ptr<IThreadWorker>> group;
+                for (int i = 0; i < 4; ++i) {
+                    group.push_back(std::make_unique<ProbeWorker>(ProbeWorker::Kind::SHORT));
+                }
+                size_t groupId = manager.createThreadsWithWorkers(std::move(group), "group");
+                if (groupId != SIZE_MAX) {
+                    for (size_t member : manager.getGroupThreadIds(groupId)) {
+                        ids.add(member);
+                    }
+                    // 成员可能被其它调用线程暂停，停止全部工作者后再等待线程组
+                    groups.push_back(groupId);
+                }
+                break;
+            }
+            case 4:
+                if (ids.pick(rng, id)) {
+                    manager.stopThread(id);
+                }
+                break;
+            case 5:
+                if (ids.pick(rng, id)) {
+                    manager.pauseThread(id);
+                }
+                break;
+            case 6:
+                if (ids.pick(rng, id)) {
+                    manager.resumeThread(id);
+                }
+                break;
+            case 7:
+                if (ids.pick(rng, id)) {
+                    manager.getThreadStatus(id);
+                }
+                break;
+            case 8:
+                if (ids.pick(rng, id)) {
+                    WorkerMetricsSnapshot metrics;
+                    manager.getThreadMetrics(id, metrics);
+                }
+                break;
+            case 9:
+                manager.getActiveThreadCount();
+                manager.getTotalThreadCount();
+                manager.captureStatus(records);
+                break;
+            case 10:
+                manager.cleanupFinishedThreads();
+                break;
+            case 11:
+                if (rng() % 16 == 0) {
+                    manager.getAllThreadStatus();
+                    manager.getMetricsSnapshot();
+                }
+                break;
+        }
+        count++;
+    }
+    ops.fetch_add(count);
+}
+
+/**
+ * @brief 压力阶段
+ */
+void runStress(ExecutionMode mode, size_t callers, std::chrono::milliseconds duration) {
+    const char* modeName = mode == ExecutionMode::POOLED ? "pooled" : "dedicated";
+    long constructedBefore = constructed.load();
+    long runsBefore = runsStarted.load();
+    std::atomic<long> ops{0};
+
+    {
+        ThreadManager manager(0, mode);
+        manager.startTracing(4096); // 跟踪点与创建、停止和回收并发执行
+        manager.addFactory(std::make_unique<ProbeFactory>(), "probe");
+        IdPool ids;
+        auto until = Clock::now() + duration;
+        std::vector<std::thread> threads;
+        std::vector<std::vector<size_t>> groups(callers);
+        for (size_t i = 0; i < callers; ++i) {
+            threads.emplace_back(hammer, std::ref(manager), std::ref(ids), static_cast<unsigned>(i * 7919 + 1), until,
+                                 std::ref(ops), std::ref(groups[i]));
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        manager.stopAll();
+        for (const auto& callerGroups : groups) {
+            for (size_t groupId : callerGroups) {
+                check(manager.waitForGroup(groupId), std::string(modeName) + ": waitForGroup failed");
+            }
+        }
+        ShutdownReport report = manager.shutdown(ShutdownOptions::drain(std::chrono::seconds(30)));
+        check(report.completed(), std::string(modeName) + ": shutdown missed its deadline");
+        check(manager.getActiveThreadCount() == 0, std::string(modeName) + ": active workers after shutdown");
+        check(manager.getTotalThreadCount() == 0, std::string(modeName) + ": registry not empty after shutdown");
+
+        RecycleStats recycle;
+        // 关闭后每个从工厂取出的工作者都已回收或销毁
+        check(manager.getRecycleStats("probe", recycle) &&
+                  recycle.recycled + recycle.discarded == recycle.hits + recycle.misses && recycle.idle <= 16,
+              std::string(modeName) + ": factory recycling counts do not add up");
+
+        manager.stopTracing();
+        std::ostringstream trace;
+        manager.writeTrace(trace);
+#if THREAD_FRAMEWORK_TRACING
+        check(Tracer::instance().getEventCount() > 0 && trace.str().find("\"ph\":\"B\"") != std::string::npos,
+              std::string(modeName) + ": no trace events recorded");
+#endif
+    }
+
+    long created = constructed.load() - constructedBefore;
+    long ran = runsStarted.load() - runsBefore;
+    check(constructed.load() == destroyed.load(), std::string(modeName) + ": leaked workers");
+    check(runsStarted.load() == runsFinished.load(), std::string(modeName) + ": run() did not return");
+    std::cout << "stress " << modeName << ": " << callers << " callers, " << ops.load() << " ops, " << created
+              << " workers created, " << ran << " ran" << std::endl;
+}
+
+/**
+ * @brief 扩展阶段：每个调用线程创建池化的短工作者并查询，报告总吞吐
+ */
+void runScaling(size_t maxCallers, size_t opsPerCaller) {
+    std::cout << "\nscaling (pooled create + status query per op)" << std::endl;
+    std::cout << std::setw(8) << "callers" << std::setw(14) << "ops/sec" << std::setw(12) << "speedup" << std::endl;
+
+    double baseline = 0;
+    for (size_t callers = 1; callers <= maxCallers; callers *= 2) {
+        ThreadManager manager(0, ExecutionMode::POOLED);
+        auto start = Clock::now();
+        std::vector<std::thread> threads;
+        for (size_t c = 0; c < callers; ++c) {
+            threads.emplace_back([&manager, opsPerCaller]() {
+                for (size_t i = 0; i < opsPerCaller; ++i) {
+                    size_t id = manager.createThreadWithWorker(
+                        std::make_unique<ProbeWorker>(ProbeWorker::Kind::SHORT), "scale");
+                    manager.getThreadStatus(id);
+                    if (i % 256 == 255) {
+                        manager.cleanupFinishedThreads();
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        manager.waitForAll();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        double rate = static_cast<double>(callers * opsPerCaller) / seconds;
+        if (callers == 1) {
+            baseline = rate;
+        }
+        std::cout << std::setw(8) << callers << std::setw(14) << static_cast<long>(rate) << std::setw(11)
+                  << std::fixed << std::setprecision(2) << rate / baseline << "x" << std::endl;
+        check(manager.getTotalThreadCount() == 0, "scaling: registry not empty after waitForAll");
+    }
+}
+
+/**
+ * @brief 数据并行的 bool 结果：“任一块命中”的归约，相邻块由不同池线程同时写入结果
+ */
+void runDataParallelAny(size_t rounds) {
+    size_t wrong = 0;
+    ThreadManager manager(0, ExecutionMode::DEDICATED_THREAD, PoolOptions(4));
+    for (size_t round = 0; round < rounds; ++round) {
+        std::vector<int> values(200000, 0);
+        bool expected = round % 2 == 0;
+        if (expected) {
+            values[(round * 7919) % values.size()] = 1;
+        }
+        auto worker = std::make_unique<DataParallelWorker<int, bool>>(
+            manager, DataView<int>::adopt(std::move(values)), false,
+            [](const DataView<int>& chunk) {
+                for (int value : chunk) {
+                    if (value != 0) {
+                        return true;
+                    }
+                }
+                return false;
+            },
+            [](bool a, bool b) { return a || b; }, 64);
+        Future<bool> any = worker->getFuture();
+        manager.createThreadWithWorker(std::move(worker), "any");
+        if (any.get() != expected) {
+            wrong++;
+        }
+    }
+    check(wrong == 0, "data parallel: " + std::to_string(wrong) + " wrong bool reduction(s)");
+    std::cout << "data parallel: " << rounds << " bool reductions, " << wrong << " wrong" << std::endl;
+}
+
+/**
+ * @brief 管道启动：源阶段的第一个工作者立即返回时，其它工作者发出的元素不能因下游提前关闭而丢失
+ */
+void runPipelineStart(size_t rounds) {
+    size_t shortRuns = 0;
+    for (size_t round = 0; round < rounds; ++round) {
+        ThreadManager manager;
+        std::atomic<size_t> received{0};
+        Pipeline pipeline("start-race");
+        pipeline
+            .source<int>("emit",
+                         [](StageOutput<int>& out) {
+                             if (out.getWorkerIndex() == 0) {
+                                 return;
+                             }
+                             for (int i = 0; i < 100 && out.emit(i); ++i) {
+                             }
+                         },
+                         StageOptions(4))
+            .sink("count", [&received](std::vector<int>& batch) { received.fetch_add(batch.size()); });
+        check(pipeline.start(manager), "pipeline start: start() failed");
+        pipeline.wait();
+        if (received.load() != 300) {
+            shortRuns++;
+        }
+    }
+    check(shortRuns == 0, "pipeline start: " + std::to_string(shortRuns) + " run(s) lost items to an early close");
+    std::cout << "pipeline start: " << rounds << " runs, " << shortRuns << " short" << std::endl;
+}
+
+/**
+ * @brief 共享定时服务的工作者在注册前收到停止：令牌在创建前已取消时，不应等满一个间隔才结束
+ */
+void runTimerStop() {
+    ThreadManager manager;
+    CancellationSource source;
+    source.cancel();
+    ThreadLaunchOptions options;
+    options.cancellation = source.getToken();
+
+    auto start = Clock::now();
+    manager.createThreadWithWorker(
+        std::make_unique<TimerWorker>(std::chrono::seconds(30), []() {}, -1, TimerMode::SHARED_SERVICE), "timer-stop",
+        options);
+    manager.waitForAll();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+    check(elapsed < std::chrono::seconds(5), "timer stop: cancelled shared-service timer waited a full interval");
+    std::cout << "timer stop: cancelled shared-service timer finished in " << elapsed.count() << "ms" << std::endl;
+}
+
+/**
+ * @brief 每个池线程一份的缓存，统计创建和销毁次数
+ */
+struct ScratchCache {
+    static std::atomic<int> built;
+    static std::atomic<int> released;
+    std::vector<int> buffer;
+
+    ScratchCache() {
+        built.fetch_add(1);
+    }
+
+    ~ScratchCache() {
+        released.fetch_add(1);
+    }
+};
+
+std::atomic<int> ScratchCache::built{0};
+std::atomic<int> ScratchCache::released{0};
+
+/**
+ * @brief 临时内存阶段：多个调用线程提交使用 ScratchVector 的任务，部分任务嵌套 parallelFor，
+ * 检查嵌套执行的任务不会覆盖外层任务的临时内存，线程私有缓存每个池线程只创建一次并在线程退出时销毁
+ */
+void runScratch(size_t callers, size_t tasksPerCaller) {
+    const size_t poolThreads = 4;
+    ScratchCache::built.store(0);
+    ScratchCache::released.store(0);
+    std::atomic<size_t> corrupted{0};
+    {
+        ThreadLocalSlot<ScratchCache> cache;
+        ThreadManager manager(0, ExecutionMode::POOLED, PoolOptions(poolThreads));
+        std::vector<std::thread> threads;
+        for (size_t c = 0; c < callers; ++c) {
+            threads.emplace_back([&, c]() {
+                std::vector<Future<void>> results;
+                for (size_t i = 0; i < tasksPerCaller; ++i) {
+                    int seed = static_cast<int>(c * tasksPerCaller + i);
+                    results.push_back(manager.submit([&, seed]() {
+                        ScratchVector<int> values;
+                        for (int k = 0; k < 256; ++k) {
+                            values.push_back(seed + k);
+                        }
+                        cache->buffer.assign(values.begin(), values.end());
+                        if (seed % 16 == 0) {
+                            manager.parallelFor(0, 32, 1, [](size_t j) {
+                                ScratchVector<size_t> inner(1024, j);
+                                (void)inner;
+                            });
+                        }
+                        for (int k = 0; k < 256; ++k) {
+                            if (values[k] != seed + k) {
+                                corrupted.fetch_add(1);
+                                break;
+                            }
+                        }
+                    }));
+                }
+                for (auto& result : results) {
+                    result.get();
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        check(corrupted.load() == 0, "scratch: nested task overwrote an outer task's scratch memory");
+        check(ScratchCache::built.load() <= static_cast<int>(poolThreads),
+              "scratch: thread-local cache built more than once per pool thread");
+    }
+    check(ScratchCache::built.load() == ScratchCache::released.load(),
+          "scratch: thread-local caches not destroyed at thread exit");
+    std::cout << "scratch: " << callers * tasksPerCaller << " tasks, " << ScratchCache::built.load()
+              << " thread-local caches" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool quick = false;
+    size_t maxCallers = 8;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+        } else if (std::strcmp(argv[i], "--max-threads") == 0 && i + 1 < argc) {
+            maxCallers = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--quick] [--max-threads N]" << std::endl;
+            return 2;
+        }
+    }
+
+    // 每个工作者的启动和停止日志会淹没输出
+    Logger::instance().setLevel(LogLevel::WARNING);
+
+    auto duration = std::chrono::milliseconds(quick ? 500 : 2000);
+    runStress(ExecutionMode::DEDICATED_THREAD, maxCallers, duration);
+    runStress(ExecutionMode::POOLED, maxCallers, duration);
+    runDataParallelAny(quick ? 20 : 100);
+    runPipelineStart(quick ? 50 : 200);
+    runTimerStop();
+    runScratch(maxCallers, quick ? 500 : 5000);
+    runScaling(maxCallers, quick ? 500 : 5000);
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "\nall checks passed" << std::endl;
+    return 0;
+}